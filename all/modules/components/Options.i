@@ -54,6 +54,8 @@
 %attribute(carto::Options, int, TileDrawSize, getTileDrawSize, setTileDrawSize)
 %attribute(carto::Options, float, DPI, getDPI, setDPI)
 %attribute(carto::Options, float, DrawDistance, getDrawDistance, setDrawDistance)
+%attribute(carto::Options, float, FrameTimeBudget, getFrameTimeBudget, setFrameTimeBudget)
+%attribute(carto::Options, bool, FrameStatistics, isFrameStatistics, setFrameStatistics)
 %attributestring(carto::Options, std::shared_ptr<carto::Bitmap>, WatermarkBitmap, getWatermarkBitmap, setWatermarkBitmap)
 %attribute(carto::Options, float, WatermarkAlignmentX, getWatermarkAlignmentX, setWatermarkAlignmentX)
 %attribute(carto::Options, float, WatermarkAlignmentY, getWatermarkAlignmentY, setWatermarkAlignmentY)
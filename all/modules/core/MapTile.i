@@ -10,9 +10,11 @@
 %}
 
 %include <std_string.i>
+%include <std_vector.i>
 %include <cartoswig.i>
 
 !value_type(carto::MapTile, core.MapTile)
+!value_type(std::vector<carto::MapTile>, core.MapTileVector)
 
 %attribute(carto::MapTile, int, X, getX)
 %attribute(carto::MapTile, int, Y, getY)
@@ -27,4 +29,6 @@
 
 %include "core/MapTile.h"
 
+!value_template(std::vector<carto::MapTile>, core.MapTileVector)
+
 #endif
@@ -5,7 +5,7 @@
 
 #ifdef _CARTO_OFFLINE_SUPPORT
 
-!proxy_imports(carto::MBTilesTileDataSource, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData)
+!proxy_imports(carto::MBTilesTileDataSource, core.MapTile, core.MapTileVector, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData, datasources.components.TileDataVector)
 
 %{
 #include "datasources/MBTilesTileDataSource.h"
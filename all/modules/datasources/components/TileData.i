@@ -11,11 +11,13 @@
 %}
 
 %include <std_shared_ptr.i>
+%include <std_vector.i>
 %include <cartoswig.i>
 
 %import "core/BinaryData.i"
 
 !shared_ptr(carto::TileData, datasources.components.TileData)
+!value_type(std::vector<std::shared_ptr<carto::TileData> >, datasources.components.TileDataVector)
 
 %attribute(carto::TileData, long long, MaxAge, getMaxAge, setMaxAge)
 %attribute(carto::TileData, bool, ReplaceWithParent, isReplaceWithParent, setReplaceWithParent)
@@ -24,4 +26,6 @@
 
 %include "datasources/components/TileData.h"
 
+!value_template(std::vector<std::shared_ptr<carto::TileData> >, datasources.components.TileDataVector)
+
 #endif
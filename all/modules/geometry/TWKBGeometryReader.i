@@ -0,0 +1,28 @@
+#ifndef _TWKBGEOMETRYREADER_I
+#define _TWKBGEOMETRYREADER_I
+
+%module TWKBGeometryReader
+
+#ifdef _CARTO_WKBT_SUPPORT
+
+!proxy_imports(carto::TWKBGeometryReader, core.BinaryData, geometry.Geometry)
+
+%{
+#include "geometry/TWKBGeometryReader.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "core/BinaryData.i"
+%import "geometry/Geometry.i"
+
+%std_exceptions(carto::TWKBGeometryReader::readGeometry)
+
+%include "geometry/TWKBGeometryReader.h"
+
+#endif
+
+#endif
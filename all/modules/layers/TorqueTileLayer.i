@@ -19,6 +19,8 @@
 
 !polymorphic_shared_ptr(carto::TorqueTileLayer, layers.TorqueTileLayer)
 
+%attribute(carto::TorqueTileLayer, int, FrameWindowSize, getFrameWindowSize, setFrameWindowSize)
+%attribute(carto::TorqueTileLayer, bool, GPUTimeFiltering, isGPUTimeFiltering, setGPUTimeFiltering)
 %std_exceptions(carto::TorqueTileLayer::TorqueTileLayer)
 
 %include "layers/TorqueTileLayer.h"
@@ -33,6 +33,8 @@ using std::uint64_t;
 %attributeval(carto::PackageManager, std::vector<std::shared_ptr<carto::PackageInfo> >, LocalPackages, getLocalPackages)
 %attribute(carto::PackageManager, int, ServerPackageListAge, getServerPackageListAge)
 %attributestring(carto::PackageManager, std::shared_ptr<carto::PackageMetaInfo>, ServerPackageListMetaInfo, getServerPackageListMetaInfo)
+%attribute(carto::PackageManager, int, MaxParallelDownloads, getMaxParallelDownloads, setMaxParallelDownloads)
+%attribute(carto::PackageManager, int, DownloadConnectionCount, getDownloadConnectionCount, setDownloadConnectionCount)
 !attributestring_polymorphic(carto::PackageManager, packagemanager.PackageManagerListener, PackageManagerListener, getPackageManagerListener, setPackageManagerListener)
 %std_io_exceptions(carto::PackageManager::PackageManager)
 %ignore carto::PackageManager::PackageManager(const std::string&, const std::string&, const std::string&, const std::string&, const std::shared_ptr<Logger>&);
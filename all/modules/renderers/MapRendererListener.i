@@ -3,6 +3,8 @@
 
 %module(directors="1") MapRendererListener
 
+!proxy_imports(carto::MapRendererListener, renderers.components.FrameStatistics)
+
 %{
 #include "renderers/MapRendererListener.h"
 #include <memory>
@@ -11,6 +13,8 @@
 %include <std_string.i>
 %include <std_shared_ptr.i>
 
+%import "renderers/components/FrameStatistics.i"
+
 !polymorphic_shared_ptr(carto::MapRendererListener, renderers.MapRendererListener)
 
 %feature("director") carto::MapRendererListener;
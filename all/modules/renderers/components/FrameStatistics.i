@@ -0,0 +1,26 @@
+#ifndef _FRAMESTATISTICS_I
+#define _FRAMESTATISTICS_I
+
+%module FrameStatistics
+
+%{
+#include "renderers/components/FrameStatistics.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+!shared_ptr(carto::FrameStatistics, renderers.components.FrameStatistics)
+
+%attribute(carto::FrameStatistics, float, FrameTime, getFrameTime)
+%attribute(carto::FrameStatistics, float, LayersDrawTime, getLayersDrawTime)
+%attribute(carto::FrameStatistics, float, BillboardsDrawTime, getBillboardsDrawTime)
+%attribute(carto::FrameStatistics, int, LayerCount, getLayerCount)
+%attribute(carto::FrameStatistics, bool, ReducedQuality, isReducedQuality)
+%ignore carto::FrameStatistics::FrameStatistics;
+!standard_equals(carto::FrameStatistics);
+
+%include "renderers/components/FrameStatistics.h"
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef _MEMORYBUDGETMANAGER_I
+#define _MEMORYBUDGETMANAGER_I
+
+%module MemoryBudgetManager
+
+%{
+#include "utils/MemoryBudgetManager.h"
+%}
+
+%include <std_string.i>
+%include <cartoswig.i>
+
+%staticattribute(carto::MemoryBudgetManager, std::size_t, MemoryBudget, GetMemoryBudget, SetMemoryBudget)
+%ignore carto::MemoryBudgetManager::CacheRegistration;
+
+%include "utils/MemoryBudgetManager.h"
+
+#endif
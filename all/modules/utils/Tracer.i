@@ -0,0 +1,18 @@
+#ifndef _TRACER_I
+#define _TRACER_I
+
+%module Tracer
+
+%{
+#include "utils/Tracer.h"
+%}
+
+%include <std_string.i>
+%include <cartoswig.i>
+
+%staticattribute(carto::Tracer, bool, Enabled, IsEnabled, SetEnabled)
+%ignore carto::Tracer::ScopedSpan;
+
+%include "utils/Tracer.h"
+
+#endif
@@ -23,6 +23,8 @@ namespace carto {
         _tileDrawSize(256),
         _dpi(160.0f),
         _drawDistance(16),
+        _frameTimeBudget(0),
+        _frameStatistics(false),
         _fovY(70),
         _panningMode(PanningMode::PANNING_MODE_FREE),
         _pivotMode(PivotMode::PIVOT_MODE_TOUCHPOINT),
@@ -186,6 +188,38 @@ namespace carto {
         notifyOptionChanged("DrawDistance");
     }
     
+    float Options::getFrameTimeBudget() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _frameTimeBudget;
+    }
+    
+    void Options::setFrameTimeBudget(float budget) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_frameTimeBudget == budget) {
+                return;
+            }
+            _frameTimeBudget = budget;
+        }
+        notifyOptionChanged("FrameTimeBudget");
+    }
+    
+    bool Options::isFrameStatistics() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _frameStatistics;
+    }
+    
+    void Options::setFrameStatistics(bool enabled) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_frameStatistics == enabled) {
+                return;
+            }
+            _frameStatistics = enabled;
+        }
+        notifyOptionChanged("FrameStatistics");
+    }
+    
     int Options::getFieldOfViewY() const {
         std::lock_guard<std::mutex> lock(_mutex);
         return _fovY;
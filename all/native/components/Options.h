@@ -211,6 +211,31 @@ namespace carto {
          */
         void setDrawDistance(float drawDistance);
     
+        /**
+         * Returns the frame time budget.
+         * @return The frame time budget in milliseconds. Zero means that the budget is not used.
+         */
+        float getFrameTimeBudget() const;
+        /**
+         * Sets the frame time budget. If the measured frame rendering time exceeds the budget while the map is moving,
+         * expensive rendering passes (labels, 3D geometry and subtile blending of tile layers) are temporarily skipped.
+         * Full quality is restored once the map stops moving. The default is 0, which disables the budget.
+         * @param budget The new frame time budget in milliseconds.
+         */
+        void setFrameTimeBudget(float budget);
+    
+        /**
+         * Returns the state of the frame statistics collection.
+         * @return True if frame statistics are reported to the map renderer listener.
+         */
+        bool isFrameStatistics() const;
+        /**
+         * Sets the state of the frame statistics collection. If enabled, MapRendererListener::onFrameStatistics
+         * is called after each frame. The default is false.
+         * @param enabled True if frame statistics should be reported.
+         */
+        void setFrameStatistics(bool enabled);
+    
         /**
          * Returns the vertial field of view angle.
          * @return The vertical field of view angle in degrees.
@@ -558,6 +583,10 @@ namespace carto {
     
         float _drawDistance;
     
+        float _frameTimeBudget;
+    
+        bool _frameStatistics;
+    
         int _fovY;
     
         PanningMode::PanningMode _panningMode;
@@ -6,7 +6,9 @@
 #include "graphics/utils/BitmapFilterTable.h"
 #include "utils/Log.h"
 
+#include <algorithm>
 #include <array>
+#include <cmath>
 
 #include <cglib/mat.h>
 
@@ -33,8 +35,11 @@ namespace carto {
         _origin(cglib::vec2<double>::zero()),
         _transform(cglib::mat3x3<double>::identity()),
         _invTransform(cglib::mat3x3<double>::identity()),
-        _bitmap(),
-        _projection(std::make_shared<EPSG3857>())
+        _affine(mapPoses.size() < 4),
+        _bitmapPyramid(),
+        _projection(std::make_shared<EPSG3857>()),
+        _filterKernelsCache(),
+        _mutex()
     {
         if (!bitmap) {
             throw NullArgumentException("Null bitmap");
@@ -118,9 +123,15 @@ namespace carto {
         }
         _transform = cglib::inverse(_invTransform);
 
-        _bitmap = bitmap;
+        std::shared_ptr<Bitmap> rgbaBitmap = bitmap;
         if (bitmap->getColorFormat() != ColorFormat::COLOR_FORMAT_RGBA) {
-            _bitmap = bitmap->getRGBABitmap();
+            rgbaBitmap = bitmap->getRGBABitmap();
+        }
+
+        // Build source pyramid, so that tiles can be always sampled from a level close to 1:1 scale
+        _bitmapPyramid.push_back(rgbaBitmap);
+        while (_bitmapPyramid.back()->getWidth() > 1 || _bitmapPyramid.back()->getHeight() > 1) {
+            _bitmapPyramid.push_back(CreateDownsampledBitmap(*_bitmapPyramid.back()));
         }
     }
 
@@ -128,15 +139,16 @@ namespace carto {
     }
 
     MapBounds BitmapOverlayRasterTileDataSource::getDataExtent() const {
-        if (!_bitmap) {
+        if (_bitmapPyramid.empty()) {
             return MapBounds(MapPos(0, 0), MapPos(0, 0));
         }
+        const std::shared_ptr<Bitmap>& bitmap = _bitmapPyramid.front();
 
         // Calculate map positions of 4 bitmap corners
         MapBounds bounds;
         for (int y = 0; y <= 1; y++) {
             for (int x = 0; x <= 1; x++) {
-                cglib::vec2<double> p = _origin + cglib::transform_point_affine(cglib::vec2<double>(x * _bitmap->getWidth(), y * _bitmap->getHeight()), _transform);
+                cglib::vec2<double> p = _origin + cglib::transform_point_affine(cglib::vec2<double>(x * bitmap->getWidth(), y * bitmap->getHeight()), _transform);
                 bounds.expandToContain(MapPos(p(0), p(1)));
             }
         }
@@ -144,7 +156,7 @@ namespace carto {
     }
 
     std::shared_ptr<TileData> BitmapOverlayRasterTileDataSource::loadTile(const MapTile& mapTile) {
-        if (!_bitmap) {
+        if (_bitmapPyramid.empty()) {
             return std::shared_ptr<TileData>();
         }
 
@@ -158,45 +170,134 @@ namespace carto {
         // Calculate transform for tile pixel -> source pixel
         cglib::mat3x3<double> invTransform = _invTransform * cglib::translate3_matrix(cglib::vec3<double>(tileP0(0), tileP0(1), 1)) * cglib::scale3_matrix(cglib::vec3<double>(scaleX / _tileSize, scaleY / _tileSize, 1));
 
+        // Find filter kernels and the pyramid level to sample from, calculate tile pixel -> pyramid level pixel transform
+        std::shared_ptr<const FilterKernels> kernels = getFilterKernels(mapTile, invTransform);
+        const Bitmap& bitmap = *_bitmapPyramid[kernels->level];
+        cglib::mat3x3<double> invTransformLevel = cglib::scale3_matrix(cglib::vec3<double>(1.0 / (1 << kernels->level), 1.0 / (1 << kernels->level), 1)) * invTransform;
+        ProjectiveTransform transform(invTransformLevel);
+
         // Find tile area in raster space
+        int width = static_cast<int>(bitmap.getWidth());
+        int height = static_cast<int>(bitmap.getHeight());
         int minU, minV, maxU, maxV;
-        if (!BitmapFilterTable::calculateFilterBounds(ProjectiveTransform(invTransform), _tileSize, _tileSize, _bitmap->getWidth(), _bitmap->getHeight(), minU, minV, maxU, maxV, MAX_FILTER_WIDTH)) {
+        if (!BitmapFilterTable::calculateFilterBounds(transform, _tileSize, _tileSize, width, height, minU, minV, maxU, maxV, MAX_FILTER_WIDTH)) {
             Log::Infof("BitmapOverlayRasterTileDataSource: Tile %s outside of bitmap", mapTile.toString().c_str());
             return std::shared_ptr<TileData>();
         }
 
-        // Calculate filter table
-        Log::Infof("BitmapOverlayRasterTileDataSource: Tile %s inside the raster dataset", mapTile.toString().c_str());
-        BitmapFilterTable filterTable(0, 0, _bitmap->getWidth(), _bitmap->getHeight());
-        filterTable.calculateFilterTable(ProjectiveTransform(invTransform), _tileSize, _tileSize, FILTER_SCALE, MAX_FILTER_WIDTH);
-        
-        std::size_t sampleIndex = 0;
+        Log::Infof("BitmapOverlayRasterTileDataSource: Tile %s inside the raster dataset, pyramid level %d", mapTile.toString().c_str(), kernels->level);
+
+        // Filter the tile. Kernel rows are contiguous and match source pixel rows, so the inner loop is a plain multiply-add over RGBA pixels.
+        int du = kernels->du;
+        int dv = kernels->dv;
+        int kernelWidth = 2 * du + 1;
+        int kernelSize = kernelWidth * (2 * dv + 1);
+        const unsigned char* pixelData = bitmap.getPixelData().data();
         std::vector<unsigned char> data(_tileSize * _tileSize * 4);
-        const std::vector<BitmapFilterTable::Sample>& samples = filterTable.getSamples();
-        for (int i = 0; i < _tileSize * _tileSize; i++) {
-            int count = filterTable.getSampleCounts()[i];
-            if (count == 0) {
-                continue;
-            }
+        for (int y = 0; y < _tileSize; y++) {
+            for (int x = 0; x < _tileSize; x++) {
+                cglib::vec2<double> uv = transform(x, y);
+                float uf = static_cast<float>(uv(0));
+                float vf = static_cast<float>(uv(1));
+                int ui = static_cast<int>(std::floor(uf));
+                int vi = static_cast<int>(std::floor(vf));
+                int pu = static_cast<int>((uf - ui) * FILTER_PHASES + 0.5f);
+                int pv = static_cast<int>((vf - vi) * FILTER_PHASES + 0.5f);
+                if (pu >= FILTER_PHASES) {
+                    pu = 0;
+                    ui++;
+                }
+                if (pv >= FILTER_PHASES) {
+                    pv = 0;
+                    vi++;
+                }
+
+                int u0 = std::max(ui - du, 0), u1 = std::min(ui + du, width - 1);
+                int v0 = std::max(vi - dv, 0), v1 = std::min(vi + dv, height - 1);
+                if (u0 > u1 || v0 > v1) {
+                    continue;
+                }
 
-            float color[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
-            for (int j = 0; j < count; j++) {
-                const BitmapFilterTable::Sample& sample = samples[sampleIndex++];
-                const unsigned char* sampleData = &_bitmap->getPixelData()[(sample.v * _bitmap->getWidth() + sample.u) * 4];
+                const float* kernel = &kernels->weights[(pv * FILTER_PHASES + pu) * kernelSize];
+                float color[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
+                for (int v = v0; v <= v1; v++) {
+                    const float* weights = kernel + (v - vi + dv) * kernelWidth + (u0 - ui + du);
+                    const unsigned char* sampleData = pixelData + (static_cast<std::size_t>(v) * width + u0) * 4;
+                    for (int u = u0; u <= u1; u++) {
+                        float weight = *weights++;
+                        for (int c = 0; c < 4; c++) {
+                            color[c] += sampleData[c] * weight;
+                        }
+                        sampleData += 4;
+                    }
+                }
                 for (int c = 0; c < 4; c++) {
-                    color[c] += sampleData[c] * sample.weight;
+                    data[(y * _tileSize + x) * 4 + c] = static_cast<unsigned char>(std::min(color[c], 255.0f));
                 }
             }
-            for (int c = 0; c < 4; c++) {
-                data[i * 4 + c] = static_cast<unsigned char>(color[c]);
+        }
+
+        // Build bitmap, pass it to the layer as is (no serialization needed)
+        auto tileBitmap = std::make_shared<Bitmap>(data.data(), _tileSize, _tileSize, ColorFormat::COLOR_FORMAT_RGBA, 4 * _tileSize);
+        return std::make_shared<TileData>(tileBitmap);
+    }
+
+    std::shared_ptr<const BitmapOverlayRasterTileDataSource::FilterKernels> BitmapOverlayRasterTileDataSource::getFilterKernels(const MapTile& mapTile, const cglib::mat3x3<double>& invTransform) const {
+        // With affine transforms the pixel footprint depends only on the zoom level, so kernels can be shared between tiles
+        if (_affine) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _filterKernelsCache.find(mapTile.getZoom());
+            if (it != _filterKernelsCache.end()) {
+                return it->second;
             }
         }
 
-        // Build bitmap, "compress" (serialize) to internal format
-        Bitmap bitmap(data.data(), _tileSize, _tileSize, ColorFormat::COLOR_FORMAT_RGBA, 4 * _tileSize);
-        return std::make_shared<TileData>(bitmap.compressToInternal());
+        // Select pyramid level based on the minor axis of the pixel footprint, EWA filter takes care of the remaining anisotropy
+        ProjectiveTransform transform(invTransform);
+        cglib::vec2<double> uv0 = transform(_tileSize / 2 + 0, _tileSize / 2 + 0);
+        double scale = std::min(cglib::length(transform(_tileSize / 2 + 1, _tileSize / 2 + 0) - uv0), cglib::length(transform(_tileSize / 2 + 0, _tileSize / 2 + 1) - uv0));
+        int level = 0;
+        while (level + 1 < static_cast<int>(_bitmapPyramid.size()) && scale >= 2.0) {
+            scale *= 0.5;
+            level++;
+        }
+
+        auto kernels = std::make_shared<FilterKernels>();
+        kernels->level = level;
+        cglib::mat3x3<double> invTransformLevel = cglib::scale3_matrix(cglib::vec3<double>(1.0 / (1 << level), 1.0 / (1 << level), 1)) * invTransform;
+        BitmapFilterTable::calculateFilterKernels(ProjectiveTransform(invTransformLevel), _tileSize, _tileSize, FILTER_SCALE, MAX_FILTER_WIDTH, FILTER_PHASES, kernels->du, kernels->dv, kernels->weights);
+
+        if (_affine) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _filterKernelsCache[mapTile.getZoom()] = kernels;
+        }
+        return kernels;
+    }
+
+    std::shared_ptr<Bitmap> BitmapOverlayRasterTileDataSource::CreateDownsampledBitmap(const Bitmap& bitmap) {
+        // Use 2x2 box filter. As pixels are premultiplied, colors can be averaged directly
+        int width = static_cast<int>(bitmap.getWidth());
+        int height = static_cast<int>(bitmap.getHeight());
+        int levelWidth = std::max(1, width / 2);
+        int levelHeight = std::max(1, height / 2);
+        const unsigned char* pixelData = bitmap.getPixelData().data();
+        std::vector<unsigned char> levelData(static_cast<std::size_t>(levelWidth) * levelHeight * 4);
+        for (int y = 0; y < levelHeight; y++) {
+            const unsigned char* row0 = pixelData + static_cast<std::size_t>(std::min(y * 2 + 0, height - 1)) * width * 4;
+            const unsigned char* row1 = pixelData + static_cast<std::size_t>(std::min(y * 2 + 1, height - 1)) * width * 4;
+            unsigned char* levelRow = &levelData[static_cast<std::size_t>(y) * levelWidth * 4];
+            for (int x = 0; x < levelWidth; x++) {
+                int x0 = std::min(x * 2 + 0, width - 1) * 4;
+                int x1 = std::min(x * 2 + 1, width - 1) * 4;
+                for (int c = 0; c < 4; c++) {
+                    levelRow[x * 4 + c] = static_cast<unsigned char>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+                }
+            }
+        }
+        return std::make_shared<Bitmap>(levelData.data(), levelWidth, levelHeight, ColorFormat::COLOR_FORMAT_RGBA, 4 * levelWidth);
     }
 
     const float BitmapOverlayRasterTileDataSource::FILTER_SCALE = 1.5f;
     const int BitmapOverlayRasterTileDataSource::MAX_FILTER_WIDTH = 16;
+    const int BitmapOverlayRasterTileDataSource::FILTER_PHASES = 16;
 }
@@ -12,6 +12,10 @@
 #include "core/ScreenPos.h"
 #include "datasources/TileDataSource.h"
 
+#include <map>
+#include <mutex>
+#include <vector>
+
 #include <cglib/mat.h>
 
 namespace carto {
@@ -46,16 +50,32 @@ namespace carto {
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
         
     private:
+        struct FilterKernels {
+            int du;
+            int dv;
+            int level;
+            std::vector<float> weights;
+        };
+
+        std::shared_ptr<const FilterKernels> getFilterKernels(const MapTile& mapTile, const cglib::mat3x3<double>& invTransform) const;
+
+        static std::shared_ptr<Bitmap> CreateDownsampledBitmap(const Bitmap& bitmap);
+
         int _tileSize;
 
         cglib::vec2<double> _origin;
         cglib::mat3x3<double> _transform;
         cglib::mat3x3<double> _invTransform;
-        std::shared_ptr<Bitmap> _bitmap;
+        bool _affine;
+        std::vector<std::shared_ptr<Bitmap> > _bitmapPyramid;
         std::shared_ptr<Projection> _projection;
 
+        mutable std::map<int, std::shared_ptr<const FilterKernels> > _filterKernelsCache;
+        mutable std::mutex _mutex;
+
         static const float FILTER_SCALE;
         static const int MAX_FILTER_WIDTH;
+        static const int FILTER_PHASES;
     };
 }
 
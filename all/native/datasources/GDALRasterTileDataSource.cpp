@@ -297,9 +297,9 @@ namespace carto {
             }
         }
 
-        // Build bitmap, "compress" (serialize) to internal format
-        Bitmap bitmap(data.data(), _tileSize, _tileSize, ColorFormat::COLOR_FORMAT_RGBA, 4 * _tileSize);
-        return std::make_shared<TileData>(bitmap.compressToInternal());
+        // Build bitmap, pass it to the layer as is (no serialization needed)
+        auto bitmap = std::make_shared<Bitmap>(data.data(), _tileSize, _tileSize, ColorFormat::COLOR_FORMAT_RGBA, 4 * _tileSize);
+        return std::make_shared<TileData>(bitmap);
     }
 
     MapBounds GDALRasterTileDataSource::getDataExtent() const {
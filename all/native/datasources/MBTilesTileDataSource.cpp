@@ -10,20 +10,57 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <cctype>
+
 #include <sqlite3pp.h>
 
+namespace {
+
+    std::string CreateFileURI(const std::string& path) {
+        // Characters with special meaning in URIs must be escaped
+        std::string uri = "file:";
+#ifdef _WIN32
+        // Windows paths with drive letters must use an empty authority, SQLite strips the leading slash when opening the file
+        if (path.size() >= 2 && std::isalpha(static_cast<unsigned char>(path[0])) && path[1] == ':') {
+            uri += "///";
+        }
+#endif
+        for (char c : path) {
+            switch (c) {
+#ifdef _WIN32
+            case '\\':
+                uri += '/';
+                break;
+#endif
+            case '%':
+                uri += "%25";
+                break;
+            case '?':
+                uri += "%3f";
+                break;
+            case '#':
+                uri += "%23";
+                break;
+            default:
+                uri += c;
+                break;
+            }
+        }
+        return uri;
+    }
+
+}
+
 namespace carto {
 
     MBTilesTileDataSource::MBTilesTileDataSource(const std::string& path) :
-        TileDataSource(), _scheme(MBTilesScheme::MBTILES_SCHEME_TMS), _db(), _mutex()
+        TileDataSource(), _path(path), _scheme(MBTilesScheme::MBTILES_SCHEME_TMS), _connections(), _connectionCount(0), _connectionReleased(), _mutex()
     {
-        _db.reset(new sqlite3pp::database());
-        if (_db->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
-            throw FileException("Failed to open database file", path);
-        }
+        _connections.push_back(createConnection());
+        _connectionCount = 1;
 
         try {
-            sqlite3pp::query query(*_db, "SELECT MIN(zoom_level), MAX(zoom_level) FROM tiles");
+            sqlite3pp::query query(*_connections.front()->database, "SELECT MIN(zoom_level), MAX(zoom_level) FROM tiles");
             for (auto it = query.begin(); it != query.end(); it++) {
                 _minZoom = it->get<int>(0);
                 _maxZoom = it->get<int>(1);
@@ -35,39 +72,37 @@ namespace carto {
     }
 
     MBTilesTileDataSource::MBTilesTileDataSource(int minZoom, int maxZoom, const std::string& path) :
-        TileDataSource(minZoom, maxZoom), _scheme(MBTilesScheme::MBTILES_SCHEME_TMS), _db(), _mutex()
+        TileDataSource(minZoom, maxZoom), _path(path), _scheme(MBTilesScheme::MBTILES_SCHEME_TMS), _connections(), _connectionCount(0), _connectionReleased(), _mutex()
     {
-        _db.reset(new sqlite3pp::database());
-        if (_db->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
-            throw FileException("Failed to open database file", path);
-        }
+        _connections.push_back(createConnection());
+        _connectionCount = 1;
     }
     
     MBTilesTileDataSource::MBTilesTileDataSource(int minZoom, int maxZoom, const std::string& path, MBTilesScheme::MBTilesScheme scheme) :
-        TileDataSource(minZoom, maxZoom), _scheme(scheme), _db(), _mutex()
+        TileDataSource(minZoom, maxZoom), _path(path), _scheme(scheme), _connections(), _connectionCount(0), _connectionReleased(), _mutex()
     {
-        _db.reset(new sqlite3pp::database());
-        if (_db->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
-            throw FileException("Failed to open database file", path);
-        }
+        _connections.push_back(createConnection());
+        _connectionCount = 1;
     }
         
     MBTilesTileDataSource::~MBTilesTileDataSource() {
-        if (_db) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (std::unique_ptr<Connection>& connection : _connections) {
             try {
-                if (_db->disconnect() != SQLITE_OK) {
+                connection->tileQuery.reset();
+                if (connection->database->disconnect() != SQLITE_OK) {
                     Log::Error("MBTilesTileDataSource: Failed to close database.");
                 }
             } catch (const std::exception& e) {
                 Log::Errorf("MBTilesTileDataSource: Failed to close database: %s.", e.what());
             }
-            _db.reset();
         }
+        _connections.clear();
     }
     
     std::map<std::string, std::string> MBTilesTileDataSource::getMetaData() const {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (!_db) {
+        std::shared_ptr<Connection> connection = acquireConnection();
+        if (!connection) {
             Log::Error("MBTilesTileDataSource::getMetaData: Not connected to the database.");
             return std::map<std::string, std::string>();
         }
@@ -75,7 +110,7 @@ namespace carto {
         try {
             // Make the query and check for database error
             std::map<std::string, std::string> metaData;
-            sqlite3pp::query query(*_db, "SELECT name, value FROM metadata");
+            sqlite3pp::query query(*connection->database, "SELECT name, value FROM metadata");
             for (auto it = query.begin(); it != query.end(); it++) {
                 metaData[it->get<const char*>(0)] = it->get<const char*>(1);
             }
@@ -88,14 +123,14 @@ namespace carto {
     }
     
     MapBounds MBTilesTileDataSource::getDataExtent() const {
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (!_db) {
+        std::shared_ptr<Connection> connection = acquireConnection();
+        if (!connection) {
             Log::Error("MBTilesTileDataSource::getDataExtent: Not connected to the database.");
             return MapBounds();
         }
         
         // As a first step, try to use meta data
-        sqlite3pp::query query(*_db, "SELECT value FROM metadata WHERE name='bounds'");
+        sqlite3pp::query query(*connection->database, "SELECT value FROM metadata WHERE name='bounds'");
         for (auto it = query.begin(); it != query.end(); it++) {
             std::string bounds = (*it).get<const char*>(0);
             std::vector<std::string> coordinates;
@@ -117,7 +152,7 @@ namespace carto {
         // Meta data not available, use tiles at last zoom level
         MapBounds mapBounds;
         try {
-            sqlite3pp::query query(*_db, "SELECT MIN(tile_column), MIN(tile_row), MAX(tile_column), MAX(tile_row) FROM tiles WHERE zoom_level=:zoom");
+            sqlite3pp::query query(*connection->database, "SELECT MIN(tile_column), MIN(tile_row), MAX(tile_column), MAX(tile_row) FROM tiles WHERE zoom_level=:zoom");
             query.bind(":zoom", _maxZoom);
             for (auto it = query.begin(); it != query.end(); it++) {
                 int tileX0 = (*it).get<int>(0);
@@ -148,28 +183,100 @@ namespace carto {
     }
     
     std::shared_ptr<TileData> MBTilesTileDataSource::loadTile(const MapTile& mapTile) {
-        std::lock_guard<std::mutex> lock(_mutex);
-        Log::Infof("MBTilesTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
-        if (!_db) {
+        if (Log::IsShowInfo()) {
+            Log::Infof("MBTilesTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+        }
+        std::shared_ptr<Connection> connection = acquireConnection();
+        if (!connection) {
             Log::Errorf("MBTilesTileDataSource::loadTile: Failed to load %s: Couldn't connect to the database.", mapTile.toString().c_str());
             return std::shared_ptr<TileData>();
         }
-        
+        return loadTileData(*connection, mapTile);
+    }
+
+    std::vector<std::shared_ptr<TileData> > MBTilesTileDataSource::loadTiles(const std::vector<MapTile>& mapTiles) {
+        std::vector<std::shared_ptr<TileData> > tileDatas;
+        tileDatas.reserve(mapTiles.size());
+        std::shared_ptr<Connection> connection = acquireConnection();
+        if (!connection) {
+            Log::Error("MBTilesTileDataSource::loadTiles: Failed to load tiles: Couldn't connect to the database.");
+            tileDatas.resize(mapTiles.size());
+            return tileDatas;
+        }
+        for (const MapTile& mapTile : mapTiles) {
+            tileDatas.push_back(loadTileData(*connection, mapTile));
+        }
+        return tileDatas;
+    }
+
+    std::unique_ptr<MBTilesTileDataSource::Connection> MBTilesTileDataSource::createConnection() const {
+        // The file is opened in immutable mode, which disables file locking and change detection
+        std::unique_ptr<Connection> connection(new Connection());
+        connection->database.reset(new sqlite3pp::database());
+        std::string uri = CreateFileURI(_path) + "?immutable=1";
+        if (connection->database->connect_v2(uri.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_URI | SQLITE_OPEN_NOMUTEX) != SQLITE_OK) {
+            throw FileException("Failed to open database file", _path);
+        }
+        connection->database->execute("PRAGMA mmap_size=268435456"); // use memory mapped I/O for the first 256MB of the file
+        return connection;
+    }
+
+    std::shared_ptr<MBTilesTileDataSource::Connection> MBTilesTileDataSource::acquireConnection() const {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (_connections.empty() && _connectionCount >= MAX_CONNECTIONS) {
+            _connectionReleased.wait(lock);
+        }
+
+        std::unique_ptr<Connection> connection;
+        if (!_connections.empty()) {
+            connection = std::move(_connections.back());
+            _connections.pop_back();
+        } else {
+            // Open a new connection without holding the lock, other threads can use the idle connections meanwhile
+            _connectionCount++;
+            lock.unlock();
+            try {
+                connection = createConnection();
+            } catch (const std::exception& e) {
+                Log::Errorf("MBTilesTileDataSource: Failed to open database connection: %s.", e.what());
+                lock.lock();
+                _connectionCount--;
+                _connectionReleased.notify_one();
+                return std::shared_ptr<Connection>();
+            }
+        }
+
+        // The connection is returned to the pool once the last reference is released
+        return std::shared_ptr<Connection>(connection.release(), [this](Connection* pooledConnection) { releaseConnection(pooledConnection); });
+    }
+
+    void MBTilesTileDataSource::releaseConnection(Connection* connection) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _connections.emplace_back(connection);
+        _connectionReleased.notify_one();
+    }
+
+    std::shared_ptr<TileData> MBTilesTileDataSource::loadTileData(Connection& connection, const MapTile& mapTile) const {
         try {
-            // Make the query and check for database error
-            sqlite3pp::query query(*_db, "SELECT LENGTH(tile_data), tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
+            // Prepare the query once per connection, reset it between the tiles
+            if (!connection.tileQuery) {
+                connection.tileQuery.reset(new sqlite3pp::query(*connection.database, "SELECT LENGTH(tile_data), tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y"));
+            }
+            sqlite3pp::query& query = *connection.tileQuery;
+            query.reset();
             query.bind(":zoom", mapTile.getZoom());
             query.bind(":x", mapTile.getX());
             query.bind(":y", _scheme == MBTilesScheme::MBTILES_SCHEME_XYZ ? mapTile.getY() : (1 << (mapTile.getZoom())) - 1 - mapTile.getY());
             
             auto it = query.begin();
             if (it == query.end()) {
+                query.reset();
                 std::shared_ptr<TileData> tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
                 if (mapTile.getZoom() > getMinZoom()) {
-                    Log::Infof("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent.");
+                    Log::Info("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent.");
                     tileData->setReplaceWithParent(true);
                 } else {
-                    Log::Infof("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database.");
+                    Log::Info("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database.");
                     return std::shared_ptr<TileData>();
                 }
                 return tileData;
@@ -178,11 +285,12 @@ namespace carto {
             std::size_t dataSize = (*it).get<int>(0);
             const unsigned char* dataPtr = static_cast<const unsigned char*>((*it).get<const void*>(1));
             auto data = std::make_shared<BinaryData>(dataPtr, dataSize);
-            query.finish();
+            query.reset();
     
             return std::make_shared<TileData>(data);
         } catch (const std::exception& e) {
             Log::Errorf("MBTilesTileDataSource::loadTile: Failed to query tile data from the database: %s.", e.what());
+            connection.tileQuery.reset();
             return std::shared_ptr<TileData>();
         }
     }
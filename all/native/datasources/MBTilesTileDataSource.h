@@ -12,10 +12,16 @@
 #include "core/MapBounds.h"
 #include "datasources/TileDataSource.h"
 
+#include <condition_variable>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace sqlite3pp {
     class database;
+    class query;
 }
     
 namespace carto {
@@ -42,6 +48,7 @@ namespace carto {
      * The database must contain table "tiles" with the following fields:
      * "zoom_level" (tile zoom level), "tile_column" (tile x coordinate),
      * "tile_row" (tile y coordinate), "tile_data" (compressed tile image).
+     * The database is opened in read-only immutable mode, thus the file must not be modified while the data source is used.
      */
     class MBTilesTileDataSource : public TileDataSource {
     public:
@@ -88,10 +95,32 @@ namespace carto {
         MapBounds getDataExtent() const;
 
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+
+        /**
+         * Loads multiple tiles using a single database connection.
+         * @param mapTiles The tiles to load.
+         * @return The tile data for each tile, in the same order as the tiles were given. Tiles that could not be loaded have null entries.
+         */
+        std::vector<std::shared_ptr<TileData> > loadTiles(const std::vector<MapTile>& mapTiles);
     
     private:
+        struct Connection {
+            std::unique_ptr<sqlite3pp::database> database;
+            std::unique_ptr<sqlite3pp::query> tileQuery;
+        };
+
+        static const int MAX_CONNECTIONS = 8;
+
+        std::unique_ptr<Connection> createConnection() const;
+        std::shared_ptr<Connection> acquireConnection() const;
+        void releaseConnection(Connection* connection) const;
+        std::shared_ptr<TileData> loadTileData(Connection& connection, const MapTile& mapTile) const;
+
+        const std::string _path;
         MBTilesScheme::MBTilesScheme _scheme;
-        std::unique_ptr<sqlite3pp::database> _db;
+        mutable std::vector<std::unique_ptr<Connection> > _connections; // idle connections
+        mutable int _connectionCount;
+        mutable std::condition_variable _connectionReleased;
         mutable std::mutex _mutex;
     };
     
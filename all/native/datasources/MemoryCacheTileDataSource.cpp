@@ -1,6 +1,7 @@
 #include "MemoryCacheTileDataSource.h"
 #include "core/BinaryData.h"
 #include "core/MapTile.h"
+#include "graphics/Bitmap.h"
 #include "utils/Log.h"
 
 #include <memory>
@@ -10,7 +11,10 @@ namespace carto {
     MemoryCacheTileDataSource::MemoryCacheTileDataSource(const std::shared_ptr<TileDataSource>& dataSource) :
         CacheTileDataSource(dataSource),
         _cache(DEFAULT_CAPACITY),
-        _mutex()
+        _mutex(),
+        _cacheRegistration("MemoryCacheTileDataSource::cache", CacheCategory::CACHE_CATEGORY_GENERAL, DEFAULT_CAPACITY,
+            [this]() { std::lock_guard<std::recursive_mutex> lock(_mutex); return _cache.size(); },
+            [this](std::size_t capacity) { std::lock_guard<std::recursive_mutex> lock(_mutex); _cache.resize(capacity); })
     {
     }
     
@@ -25,6 +29,7 @@ namespace carto {
         std::shared_ptr<TileData> tileData;
         if (_cache.read(mapTile.getTileId(), tileData)) {
             if (tileData->getMaxAge() != 0) {
+                _cacheRegistration.recordHit();
                 return tileData;
             }
             _cache.remove(mapTile.getTileId());
@@ -35,8 +40,17 @@ namespace carto {
         lock.lock();
 
         if (tileData) {
-            if (tileData->getMaxAge() != 0 && tileData->getData() && !tileData->isReplaceWithParent()) {
-                _cache.put(mapTile.getTileId(), tileData, tileData->getData()->size() + 16);
+            if (tileData->getMaxAge() != 0 && !tileData->isReplaceWithParent()) {
+                // Use decoded bitmap size for bitmap tiles, this avoids encoding the bitmap just for size estimation
+                std::size_t size = 0;
+                if (const std::shared_ptr<Bitmap>& bitmap = tileData->getBitmap()) {
+                    size = bitmap->getPixelData().size();
+                } else if (std::shared_ptr<BinaryData> data = tileData->getData()) {
+                    size = data->size();
+                }
+                if (size > 0) {
+                    _cache.put(mapTile.getTileId(), tileData, size + 16);
+                }
             }
         } else {
             Log::Infof("MemoryCacheTileDataSource::loadTile: Failed to load %s.", mapTile.toString().c_str());
@@ -51,13 +65,11 @@ namespace carto {
     }
     
     std::size_t MemoryCacheTileDataSource::getCapacity() const {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        return _cache.capacity();
+        return _cacheRegistration.getRequestedCapacity();
     }
     
     void MemoryCacheTileDataSource::setCapacity(std::size_t capacityInBytes) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        _cache.resize(capacityInBytes);
+        _cacheRegistration.setRequestedCapacity(capacityInBytes);
     }
         
 }
@@ -8,6 +8,7 @@
 #define _CARTO_MEMORYCACHETILEDATASOURCE_H_
 
 #include "datasources/CacheTileDataSource.h"
+#include "utils/MemoryBudgetManager.h"
 
 #include <stdext/timed_lru_cache.h>
 
@@ -17,6 +18,7 @@ namespace carto {
      * A tile data source that loads tiles from another tile data source
      * and caches them in memory. This cache is not persistent, tiles 
      * will be cleared once the application closes. Default cache capacity is 6MB.
+     * The actual capacity may be smaller, as all caches share the global memory budget (see MemoryBudgetManager).
      */
     class MemoryCacheTileDataSource : public CacheTileDataSource {
     public:
@@ -40,6 +42,9 @@ namespace carto {
 
         cache::timed_lru_cache<long long, std::shared_ptr<TileData> > _cache;
         mutable std::recursive_mutex _mutex;
+
+    private:
+        MemoryBudgetManager::CacheRegistration _cacheRegistration;
     };
     
 }
@@ -89,6 +89,42 @@ namespace carto {
             return inverseTransform(mapPos.getX(), mapPos.getY(), mapPos.getZ());
         }
 
+        std::vector<MapPos> transformLineString(const OGRLineString* poLineString) const {
+            int count = poLineString->getNumPoints();
+            std::vector<double> xs(count), ys(count), zs(count);
+            for (int i = 0; i < count; i++) {
+                xs[i] = poLineString->getX(i);
+                ys[i] = poLineString->getY(i);
+                zs[i] = poLineString->getZ(i);
+            }
+            if (_poCoordinateTransform && count > 0) {
+                _poCoordinateTransform->Transform(count, xs.data(), ys.data(), zs.data());
+            }
+            std::vector<MapPos> mapPoses;
+            mapPoses.reserve(count);
+            for (int i = 0; i < count; i++) {
+                mapPoses.emplace_back(xs[i], ys[i], zs[i]);
+            }
+            return mapPoses;
+        }
+
+        void inverseTransformLineString(const std::vector<MapPos>& mapPoses, OGRLineString* poLineString) const {
+            int count = static_cast<int>(mapPoses.size());
+            std::vector<double> xs(count), ys(count), zs(count);
+            for (int i = 0; i < count; i++) {
+                xs[i] = mapPoses[i].getX();
+                ys[i] = mapPoses[i].getY();
+                zs[i] = mapPoses[i].getZ();
+            }
+            if (_poInverseCoordinateTransform && count > 0) {
+                _poInverseCoordinateTransform->Transform(count, xs.data(), ys.data(), zs.data());
+            }
+            poLineString->setNumPoints(count);
+            for (int i = 0; i < count; i++) {
+                poLineString->setPoint(i, xs[i], ys[i], zs[i]);
+            }
+        }
+
     private:
         OGRSpatialReference* _poSpatialRef;
         OGRCoordinateTransformation* _poCoordinateTransform;
@@ -588,27 +624,15 @@ namespace carto {
                 break;
             case wkbLineString: {
                     OGRLineString* poLineString = (OGRLineString*) poGeometry;
-                    std::vector<MapPos> mapPoses(poLineString->getNumPoints());
-                    for (int i = 0; i < poLineString->getNumPoints(); i++) {
-                        mapPoses[i] = _poLayerSpatialRef->transform(poLineString->getX(i), poLineString->getY(i), poLineString->getZ(i));
-                    }
-                    geometry = std::make_shared<LineGeometry>(mapPoses);
+                    geometry = std::make_shared<LineGeometry>(_poLayerSpatialRef->transformLineString(poLineString));
                 }
                 break;
             case wkbPolygon: {
                     OGRPolygon* poPolygon = (OGRPolygon*) poGeometry;
-                    OGRLineString* poLineString = poPolygon->getExteriorRing();
-                    std::vector<MapPos> mapPoses(poLineString->getNumPoints());
-                    for (int i = 0; i < poLineString->getNumPoints(); i++) {
-                        mapPoses[i] = _poLayerSpatialRef->transform(poLineString->getX(i), poLineString->getY(i), poLineString->getZ(i));
-                    }
+                    std::vector<MapPos> mapPoses = _poLayerSpatialRef->transformLineString(poPolygon->getExteriorRing());
                     std::vector<std::vector<MapPos>> interiorMapPoses(poPolygon->getNumInteriorRings());
                     for (int n = 0; n < poPolygon->getNumInteriorRings(); n++) {
-                        poLineString = poPolygon->getInteriorRing(n);
-                        interiorMapPoses[n].resize(poLineString->getNumPoints());
-                        for (int i = 0; i < poLineString->getNumPoints(); i++) {
-                            interiorMapPoses[n][i] = _poLayerSpatialRef->transform(poLineString->getX(i), poLineString->getY(i),   poLineString->getZ(i));
-                        }
+                        interiorMapPoses[n] = _poLayerSpatialRef->transformLineString(poPolygon->getInteriorRing(n));
                     }
                     geometry = std::make_shared<PolygonGeometry>(mapPoses, interiorMapPoses);
                 }
@@ -719,22 +743,14 @@ namespace carto {
         } else if (auto lineGeometry = std::dynamic_pointer_cast<LineGeometry>(geometry)) {
             const std::vector<MapPos>& mapPoses = lineGeometry->getPoses();
             auto poLineString = std::make_shared<OGRLineString>();
-            poLineString->setNumPoints(mapPoses.size());
-            for (std::size_t i = 0; i < mapPoses.size(); i++) {
-                MapPos mapPos = _poLayerSpatialRef->inverseTransform(mapPoses[i]);
-                poLineString->setPoint(i, mapPos.getX(), mapPos.getY(), mapPos.getZ());
-            }
+            _poLayerSpatialRef->inverseTransformLineString(mapPoses, poLineString.get());
             poGeometry = poLineString;
         } else if (auto polygonGeometry = std::dynamic_pointer_cast<PolygonGeometry>(geometry)) {
             const std::vector<std::vector<MapPos> >& rings = polygonGeometry->getRings();
             auto poPolygon = std::make_shared<OGRPolygon>();
             for (const std::vector<MapPos>& mapPoses : rings) {
                 auto poLineString = std::make_shared<OGRLinearRing>();
-                poLineString->setNumPoints(mapPoses.size());
-                for (std::size_t i = 0; i < mapPoses.size(); i++) {
-                    MapPos mapPos = _poLayerSpatialRef->inverseTransform(mapPoses[i]);
-                    poLineString->setPoint(i, mapPos.getX(), mapPos.getY(), mapPos.getZ());
-                }
+                _poLayerSpatialRef->inverseTransformLineString(mapPoses, poLineString.get());
                 poPolygon->addRing(poLineString.get());
             }
             poPolygon->closeRings();
@@ -1,10 +1,16 @@
 #include "TileData.h"
 #include "core/BinaryData.h"
+#include "graphics/Bitmap.h"
 
 namespace carto {
     
     TileData::TileData(const std::shared_ptr<BinaryData>& data) :
-        _data(data), _expirationTime(), _replaceWithParent(false), _mutex()
+        _data(data), _bitmap(), _expirationTime(), _replaceWithParent(false), _mutex()
+    {
+    }
+
+    TileData::TileData(const std::shared_ptr<Bitmap>& bitmap) :
+        _data(), _bitmap(bitmap), _expirationTime(), _replaceWithParent(false), _mutex()
     {
     }
 
@@ -43,7 +49,24 @@ namespace carto {
     }
     
     const std::shared_ptr<BinaryData>& TileData::getData() const {
+        // NOTE: the data is assigned only once, so the returned reference stays valid after the lock is released
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_data && _bitmap) {
+            _data = EncodeBitmap(*_bitmap);
+        }
         return _data;
     }
 
+    const std::shared_ptr<Bitmap>& TileData::getBitmap() const {
+        return _bitmap;
+    }
+
+    std::shared_ptr<BinaryData> TileData::EncodeBitmap(const Bitmap& bitmap) {
+        // PNG would store unpremultiplied colors and lose precision for translucent pixels, so deflate the pixel data as is
+        if (std::shared_ptr<BinaryData> data = bitmap.compressToDeflatedInternal()) {
+            return data;
+        }
+        return bitmap.compressToInternal();
+    }
+
 }
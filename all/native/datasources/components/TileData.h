@@ -14,6 +14,7 @@
 
 namespace carto {
     class BinaryData;
+    class Bitmap;
     
     /**
      * A wrapper class for tile data.
@@ -25,6 +26,14 @@ namespace carto {
          * @param data The source tile data.
          */
         TileData(const std::shared_ptr<BinaryData>& data);
+#ifndef SWIG
+        /**
+         * Constructs a TileData object from an already decoded bitmap.
+         * The bitmap is passed to raster layers as is, binary data is created lazily when requested (for example by caches).
+         * @param bitmap The decoded tile bitmap.
+         */
+        explicit TileData(const std::shared_ptr<Bitmap>& bitmap);
+#endif
         virtual ~TileData();
         
         /**
@@ -51,12 +60,24 @@ namespace carto {
         
         /**
          * Returns tile data as binary data.
+         * If the tile data was constructed from a bitmap, the bitmap is encoded losslessly on first call.
          * @return Tile data as binary data.
          */
         const std::shared_ptr<BinaryData>& getData() const;
         
+#ifndef SWIG
+        /**
+         * Returns the decoded bitmap of the tile data, if the tile data was constructed from a bitmap.
+         * @return The decoded tile bitmap or null.
+         */
+        const std::shared_ptr<Bitmap>& getBitmap() const;
+#endif
+
     private:
-        const std::shared_ptr<BinaryData> _data;
+        static std::shared_ptr<BinaryData> EncodeBitmap(const Bitmap& bitmap);
+
+        mutable std::shared_ptr<BinaryData> _data;
+        const std::shared_ptr<Bitmap> _bitmap;
         std::shared_ptr<std::chrono::steady_clock::time_point> _expirationTime;
         bool _replaceWithParent;
         mutable std::mutex _mutex;
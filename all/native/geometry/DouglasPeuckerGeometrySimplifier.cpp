@@ -8,37 +8,43 @@
 #include "geometry/MultiLineGeometry.h"
 #include "geometry/MultiPolygonGeometry.h"
 
+#include <cmath>
 #include <stack>
+#include <limits>
 #include <utility>
+#include <iterator>
 #include <algorithm>
 
 namespace {
 
-    // This is taken from http://psimpl.sourceforge.net/douglas-peucker.html
+    // Based on http://psimpl.sourceforge.net/douglas-peucker.html
+    // Instead of approximating with a fixed tolerance, the helper records the squared tolerance at which each vertex gets dropped.
+    // As the key selection does not depend on the tolerance, simplifying with tolerance T is equivalent to keeping the vertices with significance > T^2.
     class DPHelper {
     public:
-        static void Approximate(const carto::MapPos* points, std::size_t pointCount, double minDist, unsigned char* keys) {
-            double minDist2 = minDist * minDist;
+        static void CalculateSignificances(const carto::MapPos* points, std::size_t pointCount, double* significances) {
             std::stack<SubPoly> stack;
-            stack.push(SubPoly(0, pointCount - 1));
+            stack.push(SubPoly(0, pointCount - 1, std::numeric_limits<double>::infinity()));
             while (!stack.empty()) {
                 SubPoly subPoly = stack.top();
                 stack.pop();
                 KeyInfo keyInfo = FindKey(points, subPoly.first, subPoly.last);
-                if (keyInfo.index && minDist2 < keyInfo.dist2) {
-                    keys[keyInfo.index] = 1;
-                    stack.push(SubPoly(keyInfo.index, subPoly.last));
-                    stack.push(SubPoly(subPoly.first, keyInfo.index));
+                if (keyInfo.index && 0 < keyInfo.dist2) {
+                    double significance = std::min(keyInfo.dist2, subPoly.significance);
+                    significances[keyInfo.index] = significance;
+                    stack.push(SubPoly(keyInfo.index, subPoly.last, significance));
+                    stack.push(SubPoly(subPoly.first, keyInfo.index, significance));
                 }
             }
         }
 
     private:
         struct SubPoly {
-            SubPoly(std::size_t first = 0, std::size_t last = 0) : first(first), last(last) { }
+            SubPoly(std::size_t first = 0, std::size_t last = 0, double significance = 0) : first(first), last(last), significance(significance) { }
 
             std::size_t first;
             std::size_t last;
+            double significance;
         };
 
         struct KeyInfo {
@@ -86,39 +92,23 @@ namespace carto {
 
     DouglasPeuckerGeometrySimplifier::DouglasPeuckerGeometrySimplifier(float tolerance) :
         GeometrySimplifier(),
-        _tolerance(tolerance)
+        _tolerance(tolerance),
+        _geometryInfoMap(),
+        _cachePurgeSize(MIN_CACHE_PURGE_SIZE),
+        _mutex()
     {
     }
 
     std::shared_ptr<Geometry> DouglasPeuckerGeometrySimplifier::simplify(const std::shared_ptr<Geometry>& geometry, float scale) const {
         if (auto lineGeometry = std::dynamic_pointer_cast<LineGeometry>(geometry)) {
-            std::vector<MapPos> mapPoses = simplifyRing(lineGeometry->getPoses(), scale);
-            if (mapPoses.size() < 2) {
-                return std::shared_ptr<Geometry>();
-            }
-            bool simplified = mapPoses.size() < lineGeometry->getPoses().size();
-            if (simplified) {
-                return std::make_shared<LineGeometry>(mapPoses);
-            }
+            std::vector<const std::vector<MapPos>*> rings { &lineGeometry->getPoses() };
+            return simplifyCached(geometry, rings, scale);
         } else if (auto polygonGeometry = std::dynamic_pointer_cast<PolygonGeometry>(geometry)) {
-            std::vector<MapPos> mapPoses = simplifyRing(polygonGeometry->getPoses(), scale);
-            if (mapPoses.size() < 3) {
-                return std::shared_ptr<Geometry>();
-            }
-            bool simplified = mapPoses.size() < polygonGeometry->getPoses().size();
-            std::vector<std::vector<MapPos> > holes;
+            std::vector<const std::vector<MapPos>*> rings { &polygonGeometry->getPoses() };
             for (const std::vector<MapPos>& holeRing : polygonGeometry->getHoles()) {
-                std::vector<MapPos> holeMapPoses = simplifyRing(holeRing, scale);
-                if (holeMapPoses.size() < holeRing.size()) {
-                    simplified = true;
-                }
-                if (holes.size() >= 3) {
-                    holes.push_back(std::move(holeMapPoses));
-                }
-            }
-            if (simplified) {
-                return std::make_shared<PolygonGeometry>(mapPoses, holes);
+                rings.push_back(&holeRing);
             }
+            return simplifyCached(geometry, rings, scale);
         } else if (auto multiLineGeometry = std::dynamic_pointer_cast<MultiLineGeometry>(geometry)) {
             std::vector<std::shared_ptr<LineGeometry> > lines;
             bool simplified = false;
@@ -168,42 +158,142 @@ namespace carto {
         return geometry;
     }
 
-    std::vector<MapPos> DouglasPeuckerGeometrySimplifier::simplifyRing(const std::vector<MapPos>& ring, float scale) const {
-        return simplifyRingDP(simplifyRingRD(ring, scale), scale);
-    }
+    std::shared_ptr<Geometry> DouglasPeuckerGeometrySimplifier::simplifyCached(const std::shared_ptr<Geometry>& geometry, const std::vector<const std::vector<MapPos>*>& rings, float scale) const {
+        double tolerance = static_cast<double>(scale) * _tolerance;
+        std::size_t vertexCount = 0;
+        for (const std::vector<MapPos>* ring : rings) {
+            vertexCount += ring->size();
+        }
 
-    std::vector<MapPos> DouglasPeuckerGeometrySimplifier::simplifyRingRD(const std::vector<MapPos>& ring, float scale) const {
-        if (ring.size() <= 2) {
-            return ring;
+        if (vertexCount < static_cast<std::size_t>(MIN_CACHED_VERTEX_COUNT) || !(tolerance > 0)) {
+            std::vector<std::vector<double> > ringSignificances;
+            ringSignificances.reserve(rings.size());
+            for (const std::vector<MapPos>* ring : rings) {
+                ringSignificances.push_back(CalculateRingSignificances(*ring));
+            }
+            return simplifyRings(geometry, rings, ringSignificances, tolerance);
         }
 
-        double minDist2 = scale * _tolerance * scale * _tolerance;
-        std::vector<MapPos> simplifiedRing;
-        simplifiedRing.reserve(ring.size());
-        simplifiedRing.push_back(ring.front());
-        for (std::size_t i = 1; i + 1 < ring.size(); i++) {
-            double dist2 = (ring[i] - simplifiedRing.back()).lengthSqr();
-            if (dist2 > minDist2) {
-                simplifiedRing.push_back(ring[i]);
+        // Round the tolerance down to a bucket, so that the simplified geometry can be reused for nearby scales
+        int bucket = static_cast<int>(std::floor(std::log2(tolerance) * TOLERANCE_BUCKETS_PER_OCTAVE));
+        double bucketTolerance = std::pow(2.0, static_cast<double>(bucket) / TOLERANCE_BUCKETS_PER_OCTAVE);
+
+        std::shared_ptr<const std::vector<std::vector<double> > > ringSignificances;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto it = _geometryInfoMap.find(geometry.get());
+            if (it != _geometryInfoMap.end()) {
+                if (it->second.geometry.lock() == geometry) {
+                    auto it2 = it->second.simplifiedGeometries.find(bucket);
+                    if (it2 != it->second.simplifiedGeometries.end()) {
+                        return it2->second.original ? geometry : it2->second.geometry;
+                    }
+                    ringSignificances = it->second.ringSignificances;
+                } else {
+                    _geometryInfoMap.erase(it);
+                }
             }
         }
-        simplifiedRing.push_back(ring.back());
-        return simplifiedRing;
+
+        if (!ringSignificances) {
+            auto significances = std::make_shared<std::vector<std::vector<double> > >();
+            significances->reserve(rings.size());
+            for (const std::vector<MapPos>* ring : rings) {
+                significances->push_back(CalculateRingSignificances(*ring));
+            }
+            ringSignificances = significances;
+        }
+
+        std::shared_ptr<Geometry> simplifiedGeometry = simplifyRings(geometry, rings, *ringSignificances, bucketTolerance);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_geometryInfoMap.size() >= _cachePurgeSize) {
+                for (auto it = _geometryInfoMap.begin(); it != _geometryInfoMap.end(); ) {
+                    if (it->second.geometry.expired()) {
+                        it = _geometryInfoMap.erase(it);
+                    } else {
+                        it++;
+                    }
+                }
+                _cachePurgeSize = std::max(static_cast<std::size_t>(MIN_CACHE_PURGE_SIZE), _geometryInfoMap.size() * 2);
+            }
+
+            GeometryInfo& geometryInfo = _geometryInfoMap[geometry.get()];
+            if (geometryInfo.geometry.lock() != geometry) {
+                geometryInfo.geometry = geometry;
+                geometryInfo.ringSignificances = ringSignificances;
+                geometryInfo.simplifiedGeometries.clear();
+            }
+            std::map<int, SimplifiedGeometry>& simplifiedGeometries = geometryInfo.simplifiedGeometries;
+            if (simplifiedGeometries.size() >= static_cast<std::size_t>(MAX_CACHED_TOLERANCE_BUCKETS) && simplifiedGeometries.find(bucket) == simplifiedGeometries.end()) {
+                // Drop the bucket furthest from the current one
+                if (bucket - simplifiedGeometries.begin()->first > simplifiedGeometries.rbegin()->first - bucket) {
+                    simplifiedGeometries.erase(simplifiedGeometries.begin());
+                } else {
+                    simplifiedGeometries.erase(std::prev(simplifiedGeometries.end()));
+                }
+            }
+            // Do not store the original geometry, otherwise the entry would keep it alive
+            bool original = simplifiedGeometry == geometry;
+            simplifiedGeometries[bucket] = SimplifiedGeometry { original, original ? std::shared_ptr<Geometry>() : simplifiedGeometry };
+        }
+        return simplifiedGeometry;
+    }
+
+    std::shared_ptr<Geometry> DouglasPeuckerGeometrySimplifier::simplifyRings(const std::shared_ptr<Geometry>& geometry, const std::vector<const std::vector<MapPos>*>& rings, const std::vector<std::vector<double> >& ringSignificances, double tolerance) const {
+        if (std::dynamic_pointer_cast<LineGeometry>(geometry)) {
+            std::vector<MapPos> mapPoses = FilterRing(*rings[0], ringSignificances[0], tolerance);
+            if (mapPoses.size() < 2) {
+                return std::shared_ptr<Geometry>();
+            }
+            bool simplified = mapPoses.size() < rings[0]->size();
+            if (simplified) {
+                return std::make_shared<LineGeometry>(std::move(mapPoses));
+            }
+        } else if (std::dynamic_pointer_cast<PolygonGeometry>(geometry)) {
+            std::vector<std::vector<MapPos> > simplifiedRings;
+            simplifiedRings.reserve(rings.size());
+            simplifiedRings.push_back(FilterRing(*rings[0], ringSignificances[0], tolerance));
+            if (simplifiedRings.front().size() < 3) {
+                return std::shared_ptr<Geometry>();
+            }
+            bool simplified = simplifiedRings.front().size() < rings[0]->size();
+            for (std::size_t i = 1; i < rings.size(); i++) {
+                std::vector<MapPos> holeMapPoses = FilterRing(*rings[i], ringSignificances[i], tolerance);
+                if (holeMapPoses.size() < rings[i]->size()) {
+                    simplified = true;
+                }
+                if (holeMapPoses.size() >= 3) {
+                    simplifiedRings.push_back(std::move(holeMapPoses));
+                }
+            }
+            if (simplified) {
+                return std::make_shared<PolygonGeometry>(std::move(simplifiedRings));
+            }
+        }
+        return geometry;
     }
 
-    std::vector<MapPos> DouglasPeuckerGeometrySimplifier::simplifyRingDP(const std::vector<MapPos>& ring, float scale) const {
+    std::vector<double> DouglasPeuckerGeometrySimplifier::CalculateRingSignificances(const std::vector<MapPos>& ring) {
+        std::vector<double> significances(ring.size(), 0);
         if (ring.size() <= 2) {
-            return ring;
+            std::fill(significances.begin(), significances.end(), std::numeric_limits<double>::infinity());
+            return significances;
         }
 
-        std::vector<unsigned char> keys(ring.size(), 0);
-        keys.front() = 1;
-        keys.back() = 1;
-        DPHelper::Approximate(&ring[0], ring.size(), scale * _tolerance, &keys[0]);
+        significances.front() = std::numeric_limits<double>::infinity();
+        significances.back() = std::numeric_limits<double>::infinity();
+        DPHelper::CalculateSignificances(&ring[0], ring.size(), &significances[0]);
+        return significances;
+    }
+
+    std::vector<MapPos> DouglasPeuckerGeometrySimplifier::FilterRing(const std::vector<MapPos>& ring, const std::vector<double>& significances, double tolerance) {
+        double minDist2 = tolerance * tolerance;
         std::vector<MapPos> simplifiedRing;
-        simplifiedRing.reserve(std::count(keys.begin(), keys.end(), 1));
+        simplifiedRing.reserve(std::count_if(significances.begin(), significances.end(), [minDist2](double significance) { return significance > minDist2; }));
         for (std::size_t i = 0; i < ring.size(); i++) {
-            if (keys[i] == 1) {
+            if (significances[i] > minDist2) {
                 simplifiedRing.push_back(ring[i]);
             }
         }
@@ -9,6 +9,10 @@
 
 #include "geometry/GeometrySimplifier.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 namespace carto {
@@ -17,8 +21,8 @@ namespace carto {
     /**
      * An implementation of Ramer-Douglas-Peucker algorithm for geometry simplification.
      * Simplifier works on lines and polygons.
-     * Simplification is done in two passes - first pass uses fast Radial Distance vertex rejection,
-     * second pass uses Ramer-Douglas-Peuckerworst algorithm (with worst case quadratic complexity).
+     * The significance of each vertex (the tolerance at which the vertex is dropped) is calculated once per geometry
+     * and cached, thus simplifying the same geometry at different scales is a linear operation.
      */
     class DouglasPeuckerGeometrySimplifier : public GeometrySimplifier {
     public:
@@ -31,11 +35,33 @@ namespace carto {
         virtual std::shared_ptr<Geometry> simplify(const std::shared_ptr<Geometry>& geometry, float scale) const;
 
     private:
-        std::vector<MapPos> simplifyRing(const std::vector<MapPos>& ring, float scale) const;
-        std::vector<MapPos> simplifyRingRD(const std::vector<MapPos>& ring, float scale) const;
-        std::vector<MapPos> simplifyRingDP(const std::vector<MapPos>& ring, float scale) const;
+        static const int MIN_CACHED_VERTEX_COUNT = 16;
+        static const int MIN_CACHE_PURGE_SIZE = 64;
+        static const int MAX_CACHED_TOLERANCE_BUCKETS = 4;
+        static const int TOLERANCE_BUCKETS_PER_OCTAVE = 4;
+
+        struct SimplifiedGeometry {
+            bool original;
+            std::shared_ptr<Geometry> geometry;
+        };
+
+        struct GeometryInfo {
+            std::weak_ptr<Geometry> geometry;
+            std::shared_ptr<const std::vector<std::vector<double> > > ringSignificances;
+            std::map<int, SimplifiedGeometry> simplifiedGeometries;
+        };
+
+        std::shared_ptr<Geometry> simplifyCached(const std::shared_ptr<Geometry>& geometry, const std::vector<const std::vector<MapPos>*>& rings, float scale) const;
+        std::shared_ptr<Geometry> simplifyRings(const std::shared_ptr<Geometry>& geometry, const std::vector<const std::vector<MapPos>*>& rings, const std::vector<std::vector<double> >& ringSignificances, double tolerance) const;
+
+        static std::vector<double> CalculateRingSignificances(const std::vector<MapPos>& ring);
+        static std::vector<MapPos> FilterRing(const std::vector<MapPos>& ring, const std::vector<double>& significances, double tolerance);
 
         const float _tolerance;
+
+        mutable std::unordered_map<const Geometry*, GeometryInfo> _geometryInfoMap;
+        mutable std::size_t _cachePurgeSize;
+        mutable std::mutex _mutex;
     };
 }
 
@@ -189,14 +189,18 @@ namespace carto {
         return Variant::FromString(buffer.GetString());
     }
 
-    MapPos GeoJSONGeometryReader::readPoint(const rapidjson::Value& value) const {
+    MapPos GeoJSONGeometryReader::readPos(const rapidjson::Value& value) const {
         if (!value.IsArray()) {
             throw ParseException("Wrong JSON type for coordinates");
         }
         if (value.Size() < 2) {
             throw ParseException("Too few components in coordinates");
         }
-        MapPos mapPos(value[0].GetDouble(), value[1].GetDouble(), value.Size() > 2 ? value[2].GetDouble() : 0);
+        return MapPos(value[0].GetDouble(), value[1].GetDouble(), value.Size() > 2 ? value[2].GetDouble() : 0);
+    }
+
+    MapPos GeoJSONGeometryReader::readPoint(const rapidjson::Value& value) const {
+        MapPos mapPos = readPos(value);
         if (_targetProjection) {
             mapPos = _targetProjection->fromWgs84(mapPos);
         }
@@ -210,7 +214,10 @@ namespace carto {
         std::vector<MapPos> ring;
         ring.reserve(value.Size());
         for (rapidjson::SizeType i = 0; i < value.Size(); i++) {
-            ring.push_back(readPoint(value[i]));
+            ring.push_back(readPos(value[i]));
+        }
+        if (_targetProjection) {
+            ring = _targetProjection->fromWgs84Poses(ring);
         }
         return ring;
     }
@@ -83,6 +83,7 @@ namespace carto {
         std::shared_ptr<Feature> readFeature(const rapidjson::Value& value) const;
         std::shared_ptr<Geometry> readGeometry(const rapidjson::Value& value) const;
         Variant readProperties(const rapidjson::Value& value) const;
+        MapPos readPos(const rapidjson::Value& value) const;
         MapPos readPoint(const rapidjson::Value& value) const;
         std::vector<MapPos> readRing(const rapidjson::Value& value) const;
         std::vector<std::vector<MapPos> > readRings(const rapidjson::Value& value) const;
@@ -179,24 +179,33 @@ namespace carto {
         value.CopyFrom(propertiesDoc, allocator);
     }
 
+    void GeoJSONGeometryWriter::writePos(const MapPos& pos, rapidjson::Value& value, rapidjson::MemoryPoolAllocator<rapidjson::CrtAllocator>& allocator) const {
+        value.SetArray();
+        value.PushBack(rapidjson::Value(pos.getX()), allocator);
+        value.PushBack(rapidjson::Value(pos.getY()), allocator);
+        if (_z) {
+            value.PushBack(rapidjson::Value(pos.getZ()), allocator);
+        }
+    }
+
     void GeoJSONGeometryWriter::writePoint(const MapPos& pos, rapidjson::Value& value, rapidjson::MemoryPoolAllocator<rapidjson::CrtAllocator>& allocator) const {
         MapPos mapPos(pos);
         if (_sourceProjection) {
             mapPos = _sourceProjection->toWgs84(mapPos);
         }
-        value.SetArray();
-        value.PushBack(rapidjson::Value(mapPos.getX()), allocator);
-        value.PushBack(rapidjson::Value(mapPos.getY()), allocator);
-        if (_z) {
-            value.PushBack(rapidjson::Value(mapPos.getZ()), allocator);
-        }
+        writePos(mapPos, value, allocator);
     }
 
     void GeoJSONGeometryWriter::writeRing(const std::vector<MapPos>& ring, rapidjson::Value& value, rapidjson::MemoryPoolAllocator<rapidjson::CrtAllocator>& allocator) const {
+        std::vector<MapPos> mapPoses;
+        if (_sourceProjection) {
+            mapPoses = _sourceProjection->toWgs84Poses(ring);
+        }
+        const std::vector<MapPos>& poses = (_sourceProjection ? mapPoses : ring);
         value.SetArray();
-        for (rapidjson::SizeType i = 0; i < ring.size(); i++) {
+        for (rapidjson::SizeType i = 0; i < poses.size(); i++) {
             value.PushBack(rapidjson::Value(), allocator);
-            writePoint(ring[i], value[i], allocator);
+            writePos(poses[i], value[i], allocator);
         }
     }
 
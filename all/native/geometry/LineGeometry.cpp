@@ -9,13 +9,14 @@ namespace carto {
         Geometry(),
         _poses(poses)
     {
-        if (_poses.size() < 2) {
-            Log::Error("LineGeometry::LineGeometry: Line requires at least 2 vertices");
-        }
+        initialize();
+    }
     
-        for (const MapPos& pos : _poses) {
-            _bounds.expandToContain(pos);
-        }
+    LineGeometry::LineGeometry(std::vector<MapPos>&& poses) :
+        Geometry(),
+        _poses(std::move(poses))
+    {
+        initialize();
     }
     
     LineGeometry::~LineGeometry() {
@@ -28,5 +29,15 @@ namespace carto {
     const std::vector<MapPos>& LineGeometry::getPoses() const {
         return _poses;
     }
+
+    void LineGeometry::initialize() {
+        if (_poses.size() < 2) {
+            Log::Error("LineGeometry::LineGeometry: Line requires at least 2 vertices");
+        }
+    
+        for (const MapPos& pos : _poses) {
+            _bounds.expandToContain(pos);
+        }
+    }
     
 }
@@ -23,6 +23,13 @@ namespace carto {
          * @param poses The map position list.
          */
         explicit LineGeometry(const std::vector<MapPos>& poses);
+#ifndef SWIG
+        /**
+         * Constructs a new LineGeometry object by taking ownership of a map position list.
+         * @param poses The map position list.
+         */
+        explicit LineGeometry(std::vector<MapPos>&& poses);
+#endif
         virtual ~LineGeometry();
         
         virtual MapPos getCenterPos() const;
@@ -34,6 +41,8 @@ namespace carto {
         const std::vector<MapPos>& getPoses() const;
     
     private:
+        void initialize();
+
         std::vector<MapPos> _poses;
     };
     
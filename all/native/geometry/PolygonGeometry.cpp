@@ -48,18 +48,14 @@ namespace carto {
         Geometry(),
         _rings(rings)
     {
-        for (const std::vector<MapPos>& ring : rings) {
-            if (ring.size() < 3) {
-                Log::Error("PolygonGeometry::PolygonGeometry: All polygon rings require at least 3 vertices");
-            }
-        }
+        initialize();
+    }
 
-        // Calculate bounding box
-        for (const std::vector<MapPos>& ring : _rings) {
-            for (const MapPos& pos : ring) {
-                _bounds.expandToContain(pos);
-            }
-        }
+    PolygonGeometry::PolygonGeometry(std::vector<std::vector<MapPos> >&& rings) :
+        Geometry(),
+        _rings(std::move(rings))
+    {
+        initialize();
     }
 
     PolygonGeometry::~PolygonGeometry() {
@@ -88,4 +84,19 @@ namespace carto {
         return _rings;
     }
 
+    void PolygonGeometry::initialize() {
+        for (const std::vector<MapPos>& ring : _rings) {
+            if (ring.size() < 3) {
+                Log::Error("PolygonGeometry::PolygonGeometry: All polygon rings require at least 3 vertices");
+            }
+        }
+
+        // Calculate bounding box
+        for (const std::vector<MapPos>& ring : _rings) {
+            for (const MapPos& pos : ring) {
+                _bounds.expandToContain(pos);
+            }
+        }
+    }
+
 }
@@ -35,6 +35,14 @@ namespace carto {
          * @param rings The list of map position lists defining the rings
          */
         explicit PolygonGeometry(const std::vector<std::vector<MapPos> >& rings);
+#ifndef SWIG
+        /**
+         * Constructs a PolygonGeometry objects by taking ownership of a list of rings.
+         * It is assumed the the first ring is outer ring and all other rings are inner rings.
+         * @param rings The list of map position lists defining the rings
+         */
+        explicit PolygonGeometry(std::vector<std::vector<MapPos> >&& rings);
+#endif
         virtual ~PolygonGeometry();
         
         virtual MapPos getCenterPos() const;
@@ -58,6 +66,8 @@ namespace carto {
         const std::vector<std::vector<MapPos> >& getRings() const;
 
     private:
+        void initialize();
+
         std::vector<std::vector<MapPos> > _rings;
     };
     
@@ -0,0 +1,207 @@
+#ifdef _CARTO_WKBT_SUPPORT
+
+#include "TWKBGeometryReader.h"
+#include "core/BinaryData.h"
+#include "components/Exceptions.h"
+#include "geometry/Geometry.h"
+#include "geometry/PointGeometry.h"
+#include "geometry/LineGeometry.h"
+#include "geometry/PolygonGeometry.h"
+#include "geometry/MultiGeometry.h"
+#include "geometry/MultiPointGeometry.h"
+#include "geometry/MultiLineGeometry.h"
+#include "geometry/MultiPolygonGeometry.h"
+#include "geometry/WKBGeometryEnums.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace carto {
+
+    TWKBGeometryReader::Stream::Stream(const unsigned char* data, std::size_t size) :
+        _data(data),
+        _size(size),
+        _offset(0)
+    {
+    }
+
+    unsigned char TWKBGeometryReader::Stream::readByte() {
+        if (_offset + 1 > _size) {
+            throw ParseException("Stream array too short, can not read byte");
+        }
+        return _data[_offset++];
+    }
+
+    std::uint64_t TWKBGeometryReader::Stream::readVarUInt() {
+        std::uint64_t val = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (_offset + 1 > _size) {
+                throw ParseException("Stream array too short, can not read varint");
+            }
+            unsigned char byte = _data[_offset++];
+            val |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return val;
+            }
+        }
+        throw ParseException("Malformed varint");
+    }
+
+    std::int64_t TWKBGeometryReader::Stream::readVarInt() {
+        std::uint64_t val = readVarUInt();
+        return static_cast<std::int64_t>(val >> 1) ^ -static_cast<std::int64_t>(val & 1);
+    }
+
+    std::size_t TWKBGeometryReader::Stream::getRemainingSize() const {
+        return _size - _offset;
+    }
+
+    TWKBGeometryReader::TWKBGeometryReader() {
+    }
+
+    std::shared_ptr<Geometry> TWKBGeometryReader::readGeometry(const std::shared_ptr<BinaryData>& twkbData) const {
+        if (!twkbData) {
+            throw NullArgumentException("Null twkbData");
+        }
+
+        Stream stream(twkbData->data(), twkbData->size());
+        return readGeometry(stream);
+    }
+
+    std::shared_ptr<Geometry> TWKBGeometryReader::readGeometry(Stream& stream) const {
+        unsigned char typePrecision = stream.readByte();
+        unsigned char metadata = stream.readByte();
+
+        Header header;
+        header.type = typePrecision & 0x0f;
+        header.dims = 2;
+        header.hasZ = false;
+        int precisionXY = (typePrecision >> 5) ^ -static_cast<int>((typePrecision >> 4) & 1);
+        int precisionZ = 0;
+        int precisionM = 0;
+        if (metadata & 0x08) {
+            unsigned char extDims = stream.readByte();
+            header.hasZ = (extDims & 0x01) != 0;
+            header.dims += (extDims & 0x01 ? 1 : 0) + (extDims & 0x02 ? 1 : 0);
+            precisionZ = (extDims >> 2) & 0x07;
+            precisionM = (extDims >> 5) & 0x07;
+        }
+        header.scales[0] = header.scales[1] = std::pow(10.0, -precisionXY);
+        header.scales[2] = std::pow(10.0, header.hasZ ? -precisionZ : -precisionM);
+        header.scales[3] = std::pow(10.0, -precisionM);
+        for (int i = 0; i < 4; i++) {
+            header.coords[i] = 0;
+        }
+
+        if (metadata & 0x02) {
+            stream.readVarUInt(); // size, not needed as the stream is parsed sequentially
+        }
+        if (metadata & 0x10) {
+            return std::shared_ptr<Geometry>();
+        }
+        if (metadata & 0x01) {
+            for (int i = 0; i < header.dims * 2; i++) {
+                stream.readVarInt(); // bounding box, calculated by geometry classes
+            }
+        }
+        bool hasIdList = (metadata & 0x04) != 0;
+
+        switch (header.type) {
+            case WKB_POINT: {
+                return std::make_shared<PointGeometry>(readPoint(stream, header));
+            }
+            case WKB_LINESTRING: {
+                return std::make_shared<LineGeometry>(readRing(stream, header));
+            }
+            case WKB_POLYGON: {
+                return std::make_shared<PolygonGeometry>(readRings(stream, header));
+            }
+            case WKB_MULTIPOINT: {
+                std::uint64_t pointCount = stream.readVarUInt();
+                for (std::uint64_t i = 0; hasIdList && i < pointCount; i++) {
+                    stream.readVarInt();
+                }
+                std::vector<std::shared_ptr<PointGeometry> > points;
+                points.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(pointCount, stream.getRemainingSize())));
+                while (pointCount-- > 0) {
+                    points.push_back(std::make_shared<PointGeometry>(readPoint(stream, header)));
+                }
+                return std::make_shared<MultiPointGeometry>(points);
+            }
+            case WKB_MULTILINESTRING: {
+                std::uint64_t lineCount = stream.readVarUInt();
+                for (std::uint64_t i = 0; hasIdList && i < lineCount; i++) {
+                    stream.readVarInt();
+                }
+                std::vector<std::shared_ptr<LineGeometry> > lines;
+                lines.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(lineCount, stream.getRemainingSize())));
+                while (lineCount-- > 0) {
+                    lines.push_back(std::make_shared<LineGeometry>(readRing(stream, header)));
+                }
+                return std::make_shared<MultiLineGeometry>(lines);
+            }
+            case WKB_MULTIPOLYGON: {
+                std::uint64_t polygonCount = stream.readVarUInt();
+                for (std::uint64_t i = 0; hasIdList && i < polygonCount; i++) {
+                    stream.readVarInt();
+                }
+                std::vector<std::shared_ptr<PolygonGeometry> > polygons;
+                polygons.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(polygonCount, stream.getRemainingSize())));
+                while (polygonCount-- > 0) {
+                    polygons.push_back(std::make_shared<PolygonGeometry>(readRings(stream, header)));
+                }
+                return std::make_shared<MultiPolygonGeometry>(polygons);
+            }
+            case WKB_GEOMETRYCOLLECTION: {
+                std::uint64_t geometryCount = stream.readVarUInt();
+                for (std::uint64_t i = 0; hasIdList && i < geometryCount; i++) {
+                    stream.readVarInt();
+                }
+                std::vector<std::shared_ptr<Geometry> > geometries;
+                while (geometryCount-- > 0) {
+                    if (auto geometry = readGeometry(stream)) {
+                        geometries.push_back(geometry);
+                    }
+                }
+                return std::make_shared<MultiGeometry>(geometries);
+            }
+            default: {
+                throw ParseException("Unknown geometry type"); // NOTE: not possible to continue after this
+            }
+        }
+    }
+
+    MapPos TWKBGeometryReader::readPoint(Stream& stream, Header& header) const {
+        double coords[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < header.dims; i++) {
+            header.coords[i] += stream.readVarInt();
+            coords[i] = header.coords[i] * header.scales[i];
+        }
+        return MapPos(coords[0], coords[1], header.hasZ ? coords[2] : 0);
+    }
+
+    std::vector<MapPos> TWKBGeometryReader::readRing(Stream& stream, Header& header) const {
+        std::uint64_t pointCount = stream.readVarUInt();
+        std::vector<MapPos> ring;
+        ring.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(pointCount, stream.getRemainingSize() / header.dims)));
+        while (pointCount-- > 0) {
+            ring.push_back(readPoint(stream, header));
+        }
+        return ring;
+    }
+
+    std::vector<std::vector<MapPos> > TWKBGeometryReader::readRings(Stream& stream, Header& header) const {
+        std::uint64_t ringCount = stream.readVarUInt();
+        std::vector<std::vector<MapPos> > rings;
+        rings.reserve(static_cast<std::size_t>(std::min<std::uint64_t>(ringCount, stream.getRemainingSize())));
+        while (ringCount-- > 0) {
+            rings.push_back(readRing(stream, header));
+        }
+        return rings;
+    }
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_TWKBGEOMETRYREADER_H_
+#define _CARTO_TWKBGEOMETRYREADER_H_
+
+#ifdef _CARTO_WKBT_SUPPORT
+
+#include "core/MapPos.h"
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace carto {
+    class BinaryData;
+    class Geometry;
+
+    /**
+     * A TWKB reader. Reads Tiny Well Known Binary representation of the geometry.
+     * TWKB is a compact, delta- and varint-encoded variant of WKB.
+     */
+    class TWKBGeometryReader {
+    public:
+        /**
+         * Constructs a new TWKBGeometryReader object.
+         */
+        TWKBGeometryReader();
+
+        /**
+         * Reads geometry from the specified TWKB data.
+         * @param twkbData The TWKB data to read.
+         * @return The geometry read from the data vector. Null if the geometry is empty.
+         * @throws std::runtime_error If reading fails.
+         */
+        std::shared_ptr<Geometry> readGeometry(const std::shared_ptr<BinaryData>& twkbData) const;
+
+    private:
+        struct Stream {
+            Stream(const unsigned char* data, std::size_t size);
+
+            unsigned char readByte();
+            std::uint64_t readVarUInt();
+            std::int64_t readVarInt();
+
+            std::size_t getRemainingSize() const;
+        
+        private:
+            const unsigned char* _data;
+            std::size_t _size;
+            std::size_t _offset;
+        };
+
+        struct Header {
+            int type;
+            int dims;
+            bool hasZ;
+            double scales[4];
+            std::int64_t coords[4];
+        };
+
+        std::shared_ptr<Geometry> readGeometry(Stream& stream) const;
+        MapPos readPoint(Stream& stream, Header& header) const;
+        std::vector<MapPos> readRing(Stream& stream, Header& header) const;
+        std::vector<std::vector<MapPos> > readRings(Stream& stream, Header& header) const;
+    };
+
+}
+
+#endif
+
+#endif
@@ -14,38 +14,43 @@
 #include "geometry/WKBGeometryEnums.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
 #include <stdexcept>
 
 namespace carto {
 
-    WKBGeometryReader::Stream::Stream(const std::vector<unsigned char>& data) :
+    WKBGeometryReader::Stream::Stream(const unsigned char* data, std::size_t size) :
         _data(data),
+        _size(size),
         _offset(0),
-        _bigEndian()
+        _bigEndian(false),
+        _coordBuffer()
     {
     }
 
-    void WKBGeometryReader::Stream::pushBigEndian(bool little) {
-        _bigEndian.push(little);
+    bool WKBGeometryReader::Stream::isBigEndian() const {
+        return _bigEndian;
     }
 
-    void WKBGeometryReader::Stream::popBigEndian() {
-        _bigEndian.pop();
+    void WKBGeometryReader::Stream::setBigEndian(bool bigEndian) {
+        _bigEndian = bigEndian;
     }
 
     unsigned char WKBGeometryReader::Stream::readByte() {
-        if (_offset + 1 > _data.size()) {
+        if (_offset + 1 > _size) {
             throw ParseException("Stream array too short, can not read byte");
         }
         return _data[_offset++];
     }
 
     std::uint32_t WKBGeometryReader::Stream::readUInt32() {
-        if (_offset + 4 > _data.size()) {
+        if (_offset + 4 > _size) {
             throw ParseException("Stream array too short, can not read 32-bit word");
         }
         std::uint32_t val = 0;
-        if (_bigEndian.top()) {
+        if (_bigEndian) {
             val = _data[_offset + 0];
             val = (val << 8) | _data[_offset + 1];
             val = (val << 8) | _data[_offset + 2];
@@ -60,22 +65,31 @@ namespace carto {
         return val;
     }
 
-    double WKBGeometryReader::Stream::readDouble() {
-        if (_offset + 8 > _data.size()) {
-            throw ParseException("Stream array too short, can not read double float");
+    void WKBGeometryReader::Stream::readDoubles(double* values, std::size_t count) {
+        if (count > (_size - _offset) / 8) {
+            throw ParseException("Stream array too short, can not read double floats");
         }
-        std::uint64_t val = 0;
-        if (_bigEndian.top()) {
-            for (int i = 0; i < 8; i++) {
-                val = (val << 8) | _data[_offset + i];
-            }
-        } else {
-            for (int i = 7; i >= 0; i--) {
-                val = (val << 8) | _data[_offset + i];
+
+        // Copy the whole block at once, then fix byte order in place if the data does not match host order
+        std::memcpy(values, _data + _offset, count * 8);
+        if (_bigEndian != IsHostBigEndian()) {
+            unsigned char* bytes = reinterpret_cast<unsigned char*>(values);
+            for (std::size_t i = 0; i < count; i++, bytes += 8) {
+                std::swap(bytes[0], bytes[7]);
+                std::swap(bytes[1], bytes[6]);
+                std::swap(bytes[2], bytes[5]);
+                std::swap(bytes[3], bytes[4]);
             }
         }
-        _offset += 8;
-        return *reinterpret_cast<double*>(&val);
+        _offset += count * 8;
+    }
+
+    std::size_t WKBGeometryReader::Stream::getRemainingSize() const {
+        return _size - _offset;
+    }
+
+    std::vector<double>& WKBGeometryReader::Stream::getCoordBuffer() {
+        return _coordBuffer;
     }
 
     WKBGeometryReader::WKBGeometryReader() {
@@ -86,13 +100,14 @@ namespace carto {
             throw NullArgumentException("Null wkbData");
         }
 
-        Stream stream(*wkbData->getDataPtr());
+        Stream stream(wkbData->data(), wkbData->size());
         return readGeometry(stream);
     }
 
     std::shared_ptr<Geometry> WKBGeometryReader::readGeometry(Stream& stream) const {
+        bool parentBigEndian = stream.isBigEndian();
         unsigned char bigEndian = stream.readByte();
-        stream.pushBigEndian(bigEndian == WKB_XDR);
+        stream.setBigEndian(bigEndian == WKB_XDR);
 
         std::uint32_t type = stream.readUInt32();
         std::shared_ptr<Geometry> geometry;
@@ -112,7 +127,7 @@ namespace carto {
             case WKB_MULTIPOINT: {
                 std::vector<std::shared_ptr<PointGeometry> > points;
                 std::uint32_t pointCount = stream.readUInt32();
-                points.reserve(pointCount);
+                points.reserve(std::min(static_cast<std::size_t>(pointCount), stream.getRemainingSize() / MIN_GEOMETRY_SIZE));
                 while (pointCount-- > 0) {
                     if (auto point = std::dynamic_pointer_cast<PointGeometry>(readGeometry(stream))) {
                         points.push_back(point);
@@ -126,7 +141,7 @@ namespace carto {
             case WKB_MULTILINESTRING: {
                 std::vector<std::shared_ptr<LineGeometry> > lines;
                 std::uint32_t lineCount = stream.readUInt32();
-                lines.reserve(lineCount);
+                lines.reserve(std::min(static_cast<std::size_t>(lineCount), stream.getRemainingSize() / MIN_GEOMETRY_SIZE));
                 while (lineCount-- > 0) {
                     if (auto line = std::dynamic_pointer_cast<LineGeometry>(readGeometry(stream))) {
                         lines.push_back(line);
@@ -140,7 +155,7 @@ namespace carto {
             case WKB_MULTIPOLYGON: {
                 std::vector<std::shared_ptr<PolygonGeometry> > polygons;
                 std::uint32_t polygonCount = stream.readUInt32();
-                polygons.reserve(polygonCount);
+                polygons.reserve(std::min(static_cast<std::size_t>(polygonCount), stream.getRemainingSize() / MIN_GEOMETRY_SIZE));
                 while (polygonCount-- > 0) {
                     if (auto polygon = std::dynamic_pointer_cast<PolygonGeometry>(readGeometry(stream))) {
                         polygons.push_back(polygon);
@@ -154,7 +169,7 @@ namespace carto {
             case WKB_GEOMETRYCOLLECTION: {
                 std::vector<std::shared_ptr<Geometry> > geometries;
                 std::uint32_t geometryCount = stream.readUInt32();
-                geometries.reserve(geometryCount);
+                geometries.reserve(std::min(static_cast<std::size_t>(geometryCount), stream.getRemainingSize() / MIN_GEOMETRY_SIZE));
                 while (geometryCount-- > 0) {
                     if (auto geometry = readGeometry(stream)) {
                         geometries.push_back(geometry);
@@ -168,29 +183,40 @@ namespace carto {
             }
         }
 
-        stream.popBigEndian();
+        stream.setBigEndian(parentBigEndian);
         return geometry;
     }
 
     MapPos WKBGeometryReader::readPoint(Stream& stream, std::uint32_t type) const {
-        double x = stream.readDouble();
-        double y = stream.readDouble();
-        double z = 0;
-        if (type & WKB_ZMASK) {
-            z = stream.readDouble();
-        }
-        if (type & WKB_MMASK) {
-            stream.readDouble();
-        }
-        return MapPos(x, y, z);
+        double coords[4] = { 0, 0, 0, 0 };
+        stream.readDoubles(coords, 2 + (type & WKB_ZMASK ? 1 : 0) + (type & WKB_MMASK ? 1 : 0));
+        return MapPos(coords[0], coords[1], type & WKB_ZMASK ? coords[2] : 0);
     }
 
     std::vector<MapPos> WKBGeometryReader::readRing(Stream& stream, std::uint32_t type) const {
         std::uint32_t pointCount = stream.readUInt32();
+        std::size_t dims = 2 + (type & WKB_ZMASK ? 1 : 0) + (type & WKB_MMASK ? 1 : 0);
+
+        // Check the count before allocating, malformed data could otherwise request huge buffers
+        if (pointCount > stream.getRemainingSize() / (dims * 8)) {
+            throw ParseException("Stream array too short, can not read ring");
+        }
+
+        // Decode all coordinates of the ring in a single bulk read
+        std::vector<double>& coords = stream.getCoordBuffer();
+        coords.resize(static_cast<std::size_t>(pointCount) * dims);
+        stream.readDoubles(coords.data(), coords.size());
+
         std::vector<MapPos> ring;
         ring.reserve(pointCount);
-        while (pointCount-- > 0) {
-            ring.push_back(readPoint(stream, type));
+        if (type & WKB_ZMASK) {
+            for (std::size_t i = 0; i < coords.size(); i += dims) {
+                ring.emplace_back(coords[i + 0], coords[i + 1], coords[i + 2]);
+            }
+        } else {
+            for (std::size_t i = 0; i < coords.size(); i += dims) {
+                ring.emplace_back(coords[i + 0], coords[i + 1]);
+            }
         }
         return ring;
     }
@@ -198,13 +224,18 @@ namespace carto {
     std::vector<std::vector<MapPos> > WKBGeometryReader::readRings(Stream& stream, std::uint32_t type) const {
         std::uint32_t ringCount = stream.readUInt32();
         std::vector<std::vector<MapPos> > rings;
-        rings.reserve(ringCount);
+        rings.reserve(std::min(static_cast<std::size_t>(ringCount), stream.getRemainingSize() / 4));
         while (ringCount-- > 0) {
             rings.push_back(readRing(stream, type));
         }
         return rings;
     }
 
+    bool WKBGeometryReader::IsHostBigEndian() {
+        const std::uint32_t val = 1;
+        return *reinterpret_cast<const unsigned char*>(&val) == 0;
+    }
+
 }
 
 #endif
@@ -13,8 +13,8 @@
 
 #include <memory>
 #include <vector>
-#include <stack>
 #include <cstddef>
+#include <cstdint>
 
 namespace carto {
     class BinaryData;
@@ -39,26 +39,35 @@ namespace carto {
         std::shared_ptr<Geometry> readGeometry(const std::shared_ptr<BinaryData>& wkbData) const;
 
     private:
+        static const std::size_t MIN_GEOMETRY_SIZE = 5; // byte order and geometry type
+
         struct Stream {
-            Stream(const std::vector<unsigned char>& data);
+            Stream(const unsigned char* data, std::size_t size);
 
-            void pushBigEndian(bool little);
-            void popBigEndian();
+            bool isBigEndian() const;
+            void setBigEndian(bool bigEndian);
 
             unsigned char readByte();
             std::uint32_t readUInt32();
-            double readDouble();
+            void readDoubles(double* values, std::size_t count);
+
+            std::size_t getRemainingSize() const;
+            std::vector<double>& getCoordBuffer();
         
         private:
-            const std::vector<unsigned char>& _data;
+            const unsigned char* _data;
+            std::size_t _size;
             std::size_t _offset;
-            std::stack<bool> _bigEndian;
+            bool _bigEndian;
+            std::vector<double> _coordBuffer;
         };
 
         std::shared_ptr<Geometry> readGeometry(Stream& stream) const;
         MapPos readPoint(Stream& stream, std::uint32_t type) const;
         std::vector<MapPos> readRing(Stream& stream, std::uint32_t type) const;
         std::vector<std::vector<MapPos> > readRings(Stream& stream, std::uint32_t type) const;
+
+        static bool IsHostBigEndian();
     };
 
 }
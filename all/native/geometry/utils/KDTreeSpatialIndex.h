@@ -213,11 +213,12 @@ namespace carto {
         }
         
         // Remove object from current node
-        for (auto it = node->records.begin(); it != node->records.end(); ++it) {
-            const Record& record = *it;
-            if (record.object == object) {
+        for (auto it = node->records.begin(); it != node->records.end(); ) {
+            if (it->object == object) {
                 it = node->records.erase(it);
                 _count--;
+            } else {
+                ++it;
             }
         }
         
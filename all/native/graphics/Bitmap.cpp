@@ -9,6 +9,7 @@
 #include <jpeglib.h>
 #include <png.h>
 #include <webp/decode.h>
+#include <zlib.h>
 
 namespace {
 
@@ -233,6 +234,30 @@ namespace carto {
         std::copy(pixelData.begin(), pixelData.end(), compressedData.begin() + offset);
         return std::make_shared<BinaryData>(std::move(compressedData));
     }
+
+    std::shared_ptr<BinaryData> Bitmap::compressToDeflatedInternal() const {
+        // Same header as the uncompressed internal format, followed by zlib stream of the pixel data
+        uLong pixelDataSize = static_cast<uLong>(_width * _height * _bytesPerPixel);
+        uLongf deflatedSize = compressBound(pixelDataSize);
+        std::vector<unsigned char> compressedData(INTERNAL_HEADER_SIZE + deflatedSize);
+        memcpy(&compressedData.at(0), "NUTz", 4);
+        std::size_t offset = 4;
+        encodeInt(_width, &compressedData.at(offset), sizeof(_width));
+        offset += sizeof(_width);
+        encodeInt(_height, &compressedData.at(offset), sizeof(_height));
+        offset += sizeof(_height);
+        encodeInt(_bytesPerPixel, &compressedData.at(offset), sizeof(_bytesPerPixel));
+        offset += sizeof(_bytesPerPixel);
+        encodeInt(static_cast<unsigned int>(_colorFormat), &compressedData.at(offset), sizeof(unsigned int));
+        offset += sizeof(unsigned int);
+
+        if (compress2(&compressedData.at(offset), &deflatedSize, _pixelData.data(), pixelDataSize, Z_BEST_SPEED) != Z_OK) {
+            Log::Error("Bitmap::compressToDeflatedInternal: Failed to deflate pixel data");
+            return std::shared_ptr<BinaryData>();
+        }
+        compressedData.resize(offset + deflatedSize);
+        return std::make_shared<BinaryData>(std::move(compressedData));
+    }
         
     std::shared_ptr<Bitmap> Bitmap::getResizedBitmap(unsigned int width, unsigned int height) const {
         if (width <= 0 || height <= 0) {
@@ -503,6 +528,8 @@ namespace carto {
             return loadWEBP(compressedData, dataSize);
         } else if (IsNUTI(compressedData, dataSize)) {
             return loadNUTI(compressedData, dataSize);
+        } else if (IsNUTZ(compressedData, dataSize)) {
+            return loadNUTZ(compressedData, dataSize);
         } else {
             Log::Error("Bitmap::loadFromCompressedBytes: Unsupported image format");
             return false;
@@ -650,6 +677,13 @@ namespace carto {
         }
         return memcmp(compressedData, "NUTi", 4) == 0;
     }
+    
+    bool Bitmap::IsNUTZ(const unsigned char* compressedData, std::size_t dataSize) {
+        if (dataSize < INTERNAL_HEADER_SIZE) {
+            return false;
+        }
+        return memcmp(compressedData, "NUTz", 4) == 0;
+    }
         
     bool Bitmap::loadJPEG(const unsigned char* compressedData, std::size_t dataSize) {
         jpeg_decompress_struct cinfo;
@@ -892,5 +926,26 @@ namespace carto {
     
         return true;
     }
+    
+    bool Bitmap::loadNUTZ(const unsigned char* compressedData, std::size_t dataSize) {
+        std::size_t offset = 4;
+        _width = decodeInt<unsigned int>(&compressedData[offset], sizeof(_width));
+        offset += sizeof(_width);
+        _height = decodeInt<unsigned int>(&compressedData[offset], sizeof(_height));
+        offset += sizeof(_height);
+        _bytesPerPixel = decodeInt<unsigned int>(&compressedData[offset], sizeof(_bytesPerPixel));
+        offset += sizeof(_bytesPerPixel);
+        _colorFormat = static_cast<ColorFormat::ColorFormat>(decodeInt<unsigned int>(&compressedData[offset], sizeof(unsigned int)));
+        offset += sizeof(unsigned int);
+    
+        uLongf pixelDataSize = static_cast<uLongf>(_width * _height * _bytesPerPixel);
+        _pixelData.resize(pixelDataSize);
+        if (uncompress(_pixelData.data(), &pixelDataSize, &compressedData[offset], static_cast<uLong>(dataSize - offset)) != Z_OK || pixelDataSize != _pixelData.size()) {
+            Log::Error("Bitmap::loadNUTZ: Failed to inflate pixel data");
+            return false;
+        }
+    
+        return true;
+    }
         
 }
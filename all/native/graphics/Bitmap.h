@@ -138,6 +138,14 @@ namespace carto {
          * @return A byte vector of the serialized data.
          */
         std::shared_ptr<BinaryData> compressToInternal() const;
+#ifndef SWIG
+        /**
+         * Compresses this bitmap to a deflated internal format.
+         * Unlike png, the pixel data is stored exactly as is, including premultiplied alpha values.
+         * @return A byte vector of the compressed data or null in case of error.
+         */
+        std::shared_ptr<BinaryData> compressToDeflatedInternal() const;
+#endif
         
         /**
          * Returns resized version of the bitmap. The power of two padding added during the construction of this bitmap
@@ -200,13 +208,16 @@ namespace carto {
         static bool IsPNG(const unsigned char* compressedData, std::size_t dataSize);
         static bool IsWEBP(const unsigned char* compressedData, std::size_t dataSize);
         static bool IsNUTI(const unsigned char* compressedData, std::size_t dataSize);
+        static bool IsNUTZ(const unsigned char* compressedData, std::size_t dataSize);
     
         bool loadJPEG(const unsigned char* compressedData, std::size_t dataSize);
         bool loadPNG(const unsigned char* compressedData, std::size_t dataSize);
         bool loadWEBP(const unsigned char* compressedData, std::size_t dataSize);
         bool loadNUTI(const unsigned char* compressedData, std::size_t dataSize);
+        bool loadNUTZ(const unsigned char* compressedData, std::size_t dataSize);
         
         static const unsigned int PNG_SIGNATURE_LENGTH = 8;
+        static const unsigned int INTERNAL_HEADER_SIZE = 4 + 4 * sizeof(unsigned int);
     
         unsigned int _width;
         unsigned int _height;
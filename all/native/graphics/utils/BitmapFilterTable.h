@@ -35,10 +35,28 @@ namespace carto {
         template <typename Transform>
         void calculateFilterTable(const Transform& transform, int sizeX, int sizeY, float filterScale, int maxFilterWidth);
 
+        template <typename Transform>
+        static void calculateFilterKernels(const Transform& transform, int sizeX, int sizeY, float filterScale, int maxFilterWidth, int phases, int& du, int& dv, std::vector<float>& weights);
+
         template <typename Transform>
         static bool calculateFilterBounds(const Transform& transform, int sizeX, int sizeY, int sizeU, int sizeV, int& minU, int& minV, int& maxU, int& maxV, int maxFilterWidth);
 
     private:
+        template <typename Transform>
+        static void calculateFilterParameters(const Transform& transform, int sizeX, int sizeY, float filterScale, int maxFilterWidth, float& a, float& b, float& c, int& du, int& dv);
+
+        static float calculateWeight(float uu, float vv, float a, float b, float c) {
+            float q = c*vv*vv + b*uu*vv + a*uu*uu;
+            if (q >= _GaussTableSize) {
+                return 0;
+            }
+            float qf = std::max(q, 0.0f);
+            int qi = static_cast<int>(qf);
+            float f0 = _GaussTable[qi + 0];
+            float f1 = _GaussTable[qi + 1];
+            return f0 + (f1 - f0) * (qf - qi);
+        }
+
         void calculatePixelSamples(int ui, int vi, float uf, float vf, int du, int dv, float a, float b, float c) {
             std::size_t sampleIndex = _samples.size();
             float samplesWeight = 0;
@@ -100,31 +118,9 @@ namespace carto {
 
     template <typename Transform>
     void BitmapFilterTable::calculateFilterTable(const Transform& transform, int sizeX, int sizeY, float filterScale, int maxFilterWidth) {
-        static const float epsilon = 1.0e-6f;
-
-        // Calculate "local affine approximation" gradients at the center of destination
-        // This is a good fit is the transform is affine (or close to affine), otherwise such calculations need to be performed for each pixel
-        cglib::vec2<double> uv0 = transform(sizeX / 2 + 0, sizeY / 2 + 0);
-        cglib::vec2<double> uvx = transform(sizeX / 2 + 1, sizeY / 2 + 0) - uv0;
-        cglib::vec2<double> uvy = transform(sizeX / 2 + 0, sizeY / 2 + 1) - uv0;
-        float ux = static_cast<float>(uvx(0));
-        float vx = static_cast<float>(uvx(1));
-        float uy = static_cast<float>(uvy(0));
-        float vy = static_cast<float>(uvy(1));
-
-        // Calculate bounding ellipse implicit form parameters
-        float a = vx*vx + vy*vy + 1;
-        float b = -2 * (ux*vx + uy*vy);
-        float c = ux*ux + uy*uy + 1;
-        float f = a*c - b*b*0.25f + epsilon;
-
-        // Prescale so that f = _filter_table_size
-        float s = _GaussTableSize * filterScale / f;
-        a *= s; b *= s; c *= s; f *= s;
-
-        // Find bounding box dimensions
-        int du = std::min(maxFilterWidth, static_cast<int>(std::abs(ux) + std::abs(uy) + 1));
-        int dv = std::min(maxFilterWidth, static_cast<int>(std::abs(vx) + std::abs(vy) + 1));
+        float a, b, c;
+        int du, dv;
+        calculateFilterParameters(transform, sizeX, sizeY, filterScale, maxFilterWidth, a, b, c, du, dv);
 
         // Reserve memory for samples
         _sampleCounts.reserve(sizeX * sizeY);
@@ -151,6 +147,77 @@ namespace carto {
         }
     }
 
+    template <typename Transform>
+    void BitmapFilterTable::calculateFilterKernels(const Transform& transform, int sizeX, int sizeY, float filterScale, int maxFilterWidth, int phases, int& du, int& dv, std::vector<float>& weights) {
+        float a, b, c;
+        calculateFilterParameters(transform, sizeX, sizeY, filterScale, maxFilterWidth, a, b, c, du, dv);
+
+        // The weights depend only on the fractional part of the source coordinates, so a kernel for each quantized subpixel phase is sufficient.
+        // Kernels are stored as consecutive (2*dv+1)x(2*du+1) weight matrices, ordered by V phase first and U phase second.
+        int kernelWidth = 2 * du + 1;
+        int kernelHeight = 2 * dv + 1;
+        weights.assign(static_cast<std::size_t>(phases) * phases * kernelWidth * kernelHeight, 0.0f);
+        for (int pv = 0; pv < phases; pv++) {
+            for (int pu = 0; pu < phases; pu++) {
+                float uf = static_cast<float>(pu) / phases;
+                float vf = static_cast<float>(pv) / phases;
+                float* kernel = &weights[(static_cast<std::size_t>(pv) * phases + pu) * kernelWidth * kernelHeight];
+
+                // Filter using EWA
+                float kernelWeight = 0;
+                for (int v0 = -dv; v0 <= dv; v0++) {
+                    for (int u0 = -du; u0 <= du; u0++) {
+                        float weight = calculateWeight(u0 - uf, v0 - vf, a, b, c);
+                        kernel[(v0 + dv) * kernelWidth + u0 + du] = weight;
+                        kernelWeight += weight;
+                    }
+                }
+
+                // Fallback to bilinear sampling, if needed
+                if (kernelWeight == 0) {
+                    kernel[(dv + 0) * kernelWidth + du + 0] = (1 - uf) * (1 - vf);
+                    kernel[(dv + 0) * kernelWidth + du + 1] = uf * (1 - vf);
+                    kernel[(dv + 1) * kernelWidth + du + 0] = (1 - uf) * vf;
+                    kernel[(dv + 1) * kernelWidth + du + 1] = uf * vf;
+                } else {
+                    float invKernelWeight = 1.0f / kernelWeight;
+                    for (int i = 0; i < kernelWidth * kernelHeight; i++) {
+                        kernel[i] *= invKernelWeight;
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename Transform>
+    void BitmapFilterTable::calculateFilterParameters(const Transform& transform, int sizeX, int sizeY, float filterScale, int maxFilterWidth, float& a, float& b, float& c, int& du, int& dv) {
+        static const float epsilon = 1.0e-6f;
+
+        // Calculate "local affine approximation" gradients at the center of destination
+        // This is a good fit is the transform is affine (or close to affine), otherwise such calculations need to be performed for each pixel
+        cglib::vec2<double> uv0 = transform(sizeX / 2 + 0, sizeY / 2 + 0);
+        cglib::vec2<double> uvx = transform(sizeX / 2 + 1, sizeY / 2 + 0) - uv0;
+        cglib::vec2<double> uvy = transform(sizeX / 2 + 0, sizeY / 2 + 1) - uv0;
+        float ux = static_cast<float>(uvx(0));
+        float vx = static_cast<float>(uvx(1));
+        float uy = static_cast<float>(uvy(0));
+        float vy = static_cast<float>(uvy(1));
+
+        // Calculate bounding ellipse implicit form parameters
+        a = vx*vx + vy*vy + 1;
+        b = -2 * (ux*vx + uy*vy);
+        c = ux*ux + uy*uy + 1;
+        float f = a*c - b*b*0.25f + epsilon;
+
+        // Prescale so that f = _filter_table_size
+        float s = _GaussTableSize * filterScale / f;
+        a *= s; b *= s; c *= s; f *= s;
+
+        // Find bounding box dimensions
+        du = std::min(maxFilterWidth, static_cast<int>(std::abs(ux) + std::abs(uy) + 1));
+        dv = std::min(maxFilterWidth, static_cast<int>(std::abs(vx) + std::abs(vy) + 1));
+    }
+
     template <typename Transform>
     bool BitmapFilterTable::calculateFilterBounds(const Transform& transform, int sizeX, int sizeY, int sizeU, int sizeV, int& minU, int& minV, int& maxU, int& maxV, int maxFilterWidth) {
         // Calculate "local affine approximation" gradients at the center of destination
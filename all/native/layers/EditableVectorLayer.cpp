@@ -2,6 +2,7 @@
 
 #include "EditableVectorLayer.h"
 #include "components/CancelableThreadPool.h"
+#include "core/MapBounds.h"
 #include "datasources/VectorDataSource.h"
 #include "geometry/PointGeometry.h"
 #include "geometry/LineGeometry.h"
@@ -35,6 +36,7 @@
 #include "vectorelements/Popup.h"
 #include "utils/Log.h"
 
+#include <limits>
 #include <vector>
 
 namespace carto {
@@ -43,11 +45,16 @@ namespace carto {
         VectorLayer(dataSource),
         _dataSourceListener(),
         _selectedVectorElement(),
+        _selectedPolygonGeometry(),
+        _selectedPolygonDrawData(),
+        _selectedPolygonDrawDataPatched(false),
         _overlayRenderer(std::make_shared<PointRenderer>()),
         _overlayStyleNormal(),
         _overlayStyleVirtual(),
         _overlayStyleSelected(),
         _overlayPoints(),
+        _overlayPointIndex(),
+        _overlayPointClickRadius(0),
         _overlayDragPoint(),
         _overlayDragGeometry(),
         _overlayDragGeometryPos(),
@@ -74,9 +81,14 @@ namespace carto {
                 return;
             }
 
+            restorePatchedDrawData(oldSelectedVectorElement);
             _selectedVectorElement = std::shared_ptr<VectorElement>();
+            _selectedPolygonGeometry.reset();
+            _selectedPolygonDrawData.reset();
 
             _overlayPoints.clear(); // do not cache overlay points
+            _overlayPointIndex.clear();
+            _overlayPointClickRadius = 0;
             _overlayDragPoint.reset();
             _overlayDragGeometry.reset();
             _overlayDragStarted = false;
@@ -136,6 +148,10 @@ namespace carto {
     void EditableVectorLayer::offsetLayerHorizontally(double offset) {
         VectorLayer::offsetLayerHorizontally(offset);
         _overlayRenderer->offsetLayerHorizontally(offset);
+
+        // Overlay points are indexed by their draw positions, which were just offset
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        rebuildOverlayPointIndex();
     }
 
     void EditableVectorLayer::onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager) {
@@ -163,6 +179,9 @@ namespace carto {
     
     bool EditableVectorLayer::refreshRendererElements() {
         if (_selectedVectorElement) { // NOTE: locked already
+            if (!_overlayDragStarted) {
+                restorePatchedDrawData(_selectedVectorElement);
+            }
             VectorLayer::addRendererElement(_selectedVectorElement);
         }
         bool billboardChanged = VectorLayer::refreshRendererElements();
@@ -173,6 +192,17 @@ namespace carto {
     bool EditableVectorLayer::syncRendererElement(const std::shared_ptr<VectorElement>& element, const ViewState& viewState, bool remove) {
         if (IsSameElement(element, _selectedVectorElement)) { // NOTE: locked already
             syncElementOverlayPoints(_selectedVectorElement);
+            if (!remove && patchSelectedElementDrawData(element, viewState)) {
+                return false;
+            }
+
+            bool billboardChanged = VectorLayer::syncRendererElement(element, viewState, remove);
+            if (auto polygon = std::dynamic_pointer_cast<Polygon>(element)) {
+                _selectedPolygonGeometry = polygon->getGeometry();
+                _selectedPolygonDrawData = polygon->getDrawData();
+                _selectedPolygonDrawDataPatched = false;
+            }
+            return billboardChanged;
         }
         return VectorLayer::syncRendererElement(element, viewState, remove);
     }
@@ -300,16 +330,15 @@ namespace carto {
                 MapVec rayDir = touchPos - mapRenderer->getCameraPos();
                 cglib::ray3<double> ray(cglib::vec3<double>(rayOrigin.getX(), rayOrigin.getY(), rayOrigin.getZ()), cglib::vec3<double>(rayDir.getX(), rayDir.getY(), rayDir.getZ()));
 
-                std::vector<RayIntersectedElement> results;
-                layer->_overlayRenderer->calculateRayIntersectedElements(layer, ray, mapRenderer->getViewState(), results);
-                if (!results.empty()) {
+                std::shared_ptr<Point> dragPoint = layer->findOverlayPoint(touchPos, ray, mapRenderer->getViewState());
+                if (dragPoint) {
                     VectorElementDragResult::VectorElementDragResult dragResult = VectorElementDragResult::VECTOR_ELEMENT_DRAG_RESULT_IGNORE;
                     if (vectorEditEventListener) {
                         auto dragInfo = std::make_shared<VectorElementDragInfo>(selectedElement, VectorElementDragMode::VECTOR_ELEMENT_DRAG_MODE_VERTEX, screenPos1, mapPos1);
                         dragResult = vectorEditEventListener->onDragStart(dragInfo);
                     }
                     layer->_overlayDragMode = VectorElementDragMode::VECTOR_ELEMENT_DRAG_MODE_VERTEX;
-                    layer->_overlayDragPoint = std::static_pointer_cast<Point>(results.front().getElement<VectorElement>());
+                    layer->_overlayDragPoint = dragPoint;
                     switch (dragResult) {
                         case VectorElementDragResult::VECTOR_ELEMENT_DRAG_RESULT_IGNORE:
                             layer->_overlayDragPoint.reset();
@@ -327,7 +356,7 @@ namespace carto {
                     }
                 }
                 
-                results.clear();
+                std::vector<RayIntersectedElement> results;
                 layer->calculateRayIntersectedElements(*layer->_dataSource->getProjection(), ray, mapRenderer->getViewState(), results);
                 for (const RayIntersectedElement& result : results) {
                     if (result.getElement<VectorElement>() != selectedElement) {
@@ -565,8 +594,8 @@ namespace carto {
                     mapPoses[localIndex / 2] = mapPos;
                 } else {
                     mapPoses.insert(mapPoses.begin() + localIndex / 2 + 1, mapPos);
-                    _overlayPoints.insert(_overlayPoints.begin() + index + 1, createOverlayPoint(mapPos, true, std::numeric_limits<int>::max()));
-                    _overlayPoints.insert(_overlayPoints.begin() + index - 0, createOverlayPoint(mapPos, false, std::numeric_limits<int>::max()));
+                    _overlayPoints.insert(_overlayPoints.begin() + index + 1, createOverlayPoint(mapPos, true));
+                    _overlayPoints.insert(_overlayPoints.begin() + index - 0, createOverlayPoint(mapPos, false));
                 }
                 geometry = std::make_shared<LineGeometry>(mapPoses);
             }
@@ -585,8 +614,8 @@ namespace carto {
                         }
                     } else {
                         ring.insert(ring.begin() + localIndex / 2 + 1, mapPos);
-                        _overlayPoints.insert(_overlayPoints.begin() + index + 1, createOverlayPoint(mapPos, true, std::numeric_limits<int>::max()));
-                        _overlayPoints.insert(_overlayPoints.begin() + index - 0, createOverlayPoint(mapPos, false, std::numeric_limits<int>::max()));
+                        _overlayPoints.insert(_overlayPoints.begin() + index + 1, createOverlayPoint(mapPos, true));
+                        _overlayPoints.insert(_overlayPoints.begin() + index - 0, createOverlayPoint(mapPos, false));
                     }
                     geometry = std::make_shared<PolygonGeometry>(rings);
                     break;
@@ -661,8 +690,8 @@ namespace carto {
                 if (localIndex % 2 == 0) {
                     if (mapPoses.size() > 2) {
                         mapPoses.erase(mapPoses.begin() + localIndex / 2);
-                        _overlayPoints.erase(_overlayPoints.begin() + index);
-                        _overlayPoints.erase(_overlayPoints.begin() + (localIndex > 0 ? index - 1 : index));
+                        removeOverlayPoint(index);
+                        removeOverlayPoint(localIndex > 0 ? index - 1 : index);
                         geometry = std::make_shared<LineGeometry>(mapPoses);
                     } else {
                         geometry = std::shared_ptr<Geometry>();
@@ -683,8 +712,8 @@ namespace carto {
                             if (closedRing && localIndex == 0) {
                                 ring.back() = ring.front();
                             }
-                            _overlayPoints.erase(_overlayPoints.begin() + index + 1);
-                            _overlayPoints.erase(_overlayPoints.begin() + index);
+                            removeOverlayPoint(index + 1);
+                            removeOverlayPoint(index);
                             geometry = std::make_shared<PolygonGeometry>(rings);
                         } else {
                             std::size_t n = std::find(rings.begin(), rings.end(), ring) - rings.begin();
@@ -718,17 +747,85 @@ namespace carto {
         return geometry;
     }
     
+    bool EditableVectorLayer::patchSelectedElementDrawData(const std::shared_ptr<VectorElement>& element, const ViewState& viewState) {
+        // Only vertex drags of polygons are patched, the tesselation is the expensive part of the update
+        if (!_overlayDragStarted || _overlayDragMode != VectorElementDragMode::VECTOR_ELEMENT_DRAG_MODE_VERTEX) {
+            return false;
+        }
+        if (!element->isVisible() || !isVisible() || !getVisibleZoomRange().inRange(viewState.getZoom())) {
+            return false;
+        }
+        std::shared_ptr<Polygon> polygon = std::dynamic_pointer_cast<Polygon>(element);
+        if (!polygon) {
+            return false;
+        }
+        std::shared_ptr<PolygonDrawData> drawData = polygon->getDrawData();
+        if (!drawData || drawData != _selectedPolygonDrawData || drawData->isOffset() || !_selectedPolygonGeometry) {
+            return false;
+        }
+
+        // The rings must have the same vertex counts and only a few vertices may move
+        std::shared_ptr<PolygonGeometry> geometry = polygon->getGeometry();
+        const std::vector<std::vector<MapPos> >& oldRings = _selectedPolygonGeometry->getRings();
+        const std::vector<std::vector<MapPos> >& rings = geometry->getRings();
+        if (rings.size() != oldRings.size()) {
+            return false;
+        }
+        int movedCount = 0;
+        for (std::size_t n = 0; n < rings.size(); n++) {
+            if (rings[n].size() != oldRings[n].size()) {
+                return false;
+            }
+            for (std::size_t i = 0; i < rings[n].size(); i++) {
+                if (rings[n][i] != oldRings[n][i]) {
+                    movedCount++;
+                }
+            }
+        }
+        if (movedCount == 0 || movedCount > MAX_PATCHED_VERTICES) {
+            return false;
+        }
+
+        drawData = std::make_shared<PolygonDrawData>(*drawData, *_selectedPolygonGeometry, *geometry, *polygon->getStyle(), *_dataSource->getProjection());
+        polygon->setDrawData(drawData);
+        _polygonRenderer->updateElement(polygon);
+
+        _selectedPolygonGeometry = geometry;
+        _selectedPolygonDrawData = drawData;
+        _selectedPolygonDrawDataPatched = true;
+        return true;
+    }
+
+    void EditableVectorLayer::restorePatchedDrawData(const std::shared_ptr<VectorElement>& element) {
+        if (!_selectedPolygonDrawDataPatched) {
+            return;
+        }
+        _selectedPolygonDrawDataPatched = false;
+
+        // Moved vertices may have made the patched triangles overlap, so tesselate the polygon again once the drag has ended
+        if (auto polygon = std::dynamic_pointer_cast<Polygon>(element)) {
+            if (polygon->getDrawData() && polygon->getDrawData() == _selectedPolygonDrawData) {
+                std::shared_ptr<PolygonGeometry> geometry = polygon->getGeometry();
+                _selectedPolygonDrawData = std::make_shared<PolygonDrawData>(*geometry, *polygon->getStyle(), *_dataSource->getProjection());
+                _selectedPolygonGeometry = geometry;
+                polygon->setDrawData(_selectedPolygonDrawData);
+            }
+        }
+    }
+
     void EditableVectorLayer::syncElementOverlayPoints(const std::shared_ptr<VectorElement>& element) {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-        std::vector<std::shared_ptr<Point> > overlayPoints;
+        // Reuse the existing overlay points, only the points that have moved or changed style are updated
+        std::size_t index = 0;
         if (element && element->isVisible()) {
-            int index = 0;
             std::shared_ptr<Geometry> geometry = element->getGeometry();
-            createGeometryOverlayPoints(geometry, index, overlayPoints);
+            syncGeometryOverlayPoints(geometry, index);
+        }
+        while (_overlayPoints.size() > index) {
+            removeOverlayPoint(_overlayPoints.size() - 1);
         }
         
-        std::swap(overlayPoints, _overlayPoints);
         for (const std::shared_ptr<Point>& overlayPoint : _overlayPoints) {
             if (overlayPoint->getDrawData()) {
                 _overlayRenderer->addElement(overlayPoint);
@@ -737,51 +834,123 @@ namespace carto {
         _overlayRenderer->refreshElements();
     }
 
-    void EditableVectorLayer::createGeometryOverlayPoints(const std::shared_ptr<Geometry>& geometry, int& index, std::vector<std::shared_ptr<Point> >& overlayPoints) const {
+    void EditableVectorLayer::syncGeometryOverlayPoints(const std::shared_ptr<Geometry>& geometry, std::size_t& index) {
         if (auto pointGeometry = std::dynamic_pointer_cast<PointGeometry>(geometry)) {
             MapPos mapPos = pointGeometry->getPos();
-            overlayPoints.push_back(createOverlayPoint(mapPos, false, index++));
+            syncOverlayPoint(index++, mapPos, false);
         } else if (auto lineGeometry = std::dynamic_pointer_cast<LineGeometry>(geometry)) {
             const std::vector<MapPos>& mapPoses = lineGeometry->getPoses();
             for (std::size_t i = 0; i < mapPoses.size(); i++) {
                 MapPos mapPos = mapPoses[i];
                 if (i > 0) {
                     MapPos prevMapPos = mapPoses[i - 1];
-                    overlayPoints.push_back(createOverlayPoint(prevMapPos + (mapPos - prevMapPos) * 0.5, true, index++));
+                    syncOverlayPoint(index++, prevMapPos + (mapPos - prevMapPos) * 0.5, true);
                 }
-                overlayPoints.push_back(createOverlayPoint(mapPos, false, index++));
+                syncOverlayPoint(index++, mapPos, false);
             }
         } else if (auto polygonGeometry = std::dynamic_pointer_cast<PolygonGeometry>(geometry)) {
             for (const std::vector<MapPos>& ring : polygonGeometry->getRings()) {
                 bool closedRing = !ring.empty() && ring.front() == ring.back();
                 for (std::size_t i = 0; i < ring.size() - (closedRing ? 1 : 0); i++) {
                     MapPos mapPos = ring[i];
-                    overlayPoints.push_back(createOverlayPoint(mapPos, false, index++));
+                    syncOverlayPoint(index++, mapPos, false);
                     MapPos nextMapPos = ring[i + 1 < ring.size() ? i + 1 : 0];
-                    overlayPoints.push_back(createOverlayPoint(mapPos + (nextMapPos - mapPos) * 0.5, true, index++));
+                    syncOverlayPoint(index++, mapPos + (nextMapPos - mapPos) * 0.5, true);
                 }
             }
         } else if (auto multiGeometry = std::dynamic_pointer_cast<MultiGeometry>(geometry)) {
             for (int i = 0; i < multiGeometry->getGeometryCount(); i++) {
-                createGeometryOverlayPoints(multiGeometry->getGeometry(i), index, overlayPoints);
+                syncGeometryOverlayPoints(multiGeometry->getGeometry(i), index);
             }
         }
     }
 
-    std::shared_ptr<Point> EditableVectorLayer::createOverlayPoint(const MapPos& mapPos, bool virtualPoint, int index) const {
-        std::shared_ptr<Point> overlayPoint;
-        if (index >= 0 && index < static_cast<int>(_overlayPoints.size())) {
-            overlayPoint = _overlayPoints[index];
-            overlayPoint->setPos(mapPos);
-            overlayPoint->setStyle(overlayPoint == _overlayDragPoint ? _overlayStyleSelected : (virtualPoint ? _overlayStyleVirtual : _overlayStyleNormal));
+    void EditableVectorLayer::syncOverlayPoint(std::size_t index, const MapPos& mapPos, bool virtualPoint) {
+        if (index < _overlayPoints.size()) {
+            updateOverlayPoint(_overlayPoints[index], mapPos, virtualPoint);
         } else {
-            overlayPoint = std::make_shared<Point>(mapPos, virtualPoint ? _overlayStyleVirtual : _overlayStyleNormal);
+            _overlayPoints.push_back(createOverlayPoint(mapPos, virtualPoint));
         }
+    }
+
+    std::shared_ptr<Point> EditableVectorLayer::createOverlayPoint(const MapPos& mapPos, bool virtualPoint) {
+        auto overlayPoint = std::make_shared<Point>(mapPos, virtualPoint ? _overlayStyleVirtual : _overlayStyleNormal);
         if (overlayPoint->getStyle()) {
             overlayPoint->setDrawData(std::make_shared<PointDrawData>(*overlayPoint->getGeometry(), *overlayPoint->getStyle(), *_dataSource->getProjection()));
         }
+        updateOverlayPointIndex(overlayPoint, false);
         return overlayPoint;
     }
+
+    void EditableVectorLayer::updateOverlayPoint(const std::shared_ptr<Point>& overlayPoint, const MapPos& mapPos, bool virtualPoint) {
+        std::shared_ptr<PointStyle> style = (overlayPoint == _overlayDragPoint ? _overlayStyleSelected : (virtualPoint ? _overlayStyleVirtual : _overlayStyleNormal));
+        std::shared_ptr<PointDrawData> drawData = overlayPoint->getDrawData();
+        if (drawData && !drawData->isOffset() && overlayPoint->getPos() == mapPos && overlayPoint->getStyle() == style) {
+            return;
+        }
+
+        updateOverlayPointIndex(overlayPoint, true);
+        overlayPoint->setPos(mapPos);
+        overlayPoint->setStyle(style);
+        if (overlayPoint->getStyle()) {
+            overlayPoint->setDrawData(std::make_shared<PointDrawData>(*overlayPoint->getGeometry(), *overlayPoint->getStyle(), *_dataSource->getProjection()));
+        }
+        updateOverlayPointIndex(overlayPoint, false);
+    }
+
+    void EditableVectorLayer::removeOverlayPoint(std::size_t index) {
+        updateOverlayPointIndex(_overlayPoints[index], true);
+        _overlayPoints.erase(_overlayPoints.begin() + index);
+    }
+
+    void EditableVectorLayer::updateOverlayPointIndex(const std::shared_ptr<Point>& overlayPoint, bool remove) {
+        std::shared_ptr<PointDrawData> drawData = overlayPoint->getDrawData();
+        if (!drawData) {
+            return;
+        }
+
+        const cglib::vec3<double>& pos = drawData->getPos();
+        MapPos internalPos(pos(0), pos(1), pos(2));
+        if (remove) {
+            _overlayPointIndex.remove(MapBounds(internalPos, internalPos), overlayPoint);
+        } else {
+            _overlayPointIndex.insert(MapBounds(internalPos, internalPos), overlayPoint);
+            _overlayPointClickRadius = std::max(_overlayPointClickRadius, drawData->getSize() * 0.5f * drawData->getClickScale());
+        }
+    }
+
+    void EditableVectorLayer::rebuildOverlayPointIndex() {
+        _overlayPointIndex.clear();
+        for (const std::shared_ptr<Point>& overlayPoint : _overlayPoints) {
+            updateOverlayPointIndex(overlayPoint, false);
+        }
+    }
+
+    std::shared_ptr<Point> EditableVectorLayer::findOverlayPoint(const MapPos& touchPos, const cglib::ray3<double>& ray, const ViewState& viewState) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        // Query the candidates near the touch position from the index and do exact intersection tests only for these. Pick the closest hit
+        double radius = _overlayPointClickRadius * viewState.getUnitToDPCoef();
+        MapBounds bounds(MapPos(touchPos.getX() - radius, touchPos.getY() - radius, -std::numeric_limits<double>::max()), MapPos(touchPos.getX() + radius, touchPos.getY() + radius, std::numeric_limits<double>::max()));
+
+        std::shared_ptr<VectorLayer> layer = std::static_pointer_cast<VectorLayer>(shared_from_this());
+        std::shared_ptr<Point> closestPoint;
+        double closestDistance = std::numeric_limits<double>::max();
+        std::vector<RayIntersectedElement> results;
+        for (const std::shared_ptr<Point>& overlayPoint : _overlayPointIndex.query(bounds)) {
+            std::shared_ptr<PointDrawData> drawData = overlayPoint->getDrawData();
+            if (!drawData || !PointRenderer::FindElementRayIntersection(overlayPoint, drawData, layer, ray, viewState, results)) {
+                continue;
+            }
+            const cglib::vec3<double>& pos = drawData->getPos();
+            double distance = cglib::norm(cglib::vec2<double>(pos(0) - touchPos.getX(), pos(1) - touchPos.getY()));
+            if (distance < closestDistance) {
+                closestPoint = overlayPoint;
+                closestDistance = distance;
+            }
+        }
+        return closestPoint;
+    }
     
     bool EditableVectorLayer::IsSameElement(const std::shared_ptr<VectorElement>& element1, const std::shared_ptr<VectorElement>& element2) {
         if (!element1 || !element2) {
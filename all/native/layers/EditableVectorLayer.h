@@ -12,6 +12,7 @@
 #include "core/MapPos.h"
 #include "core/MapVec.h"
 #include "components/DirectorPtr.h"
+#include "geometry/utils/KDTreeSpatialIndex.h"
 #include "layers/VectorLayer.h"
 #include "ui/TouchHandler.h"
 #include "ui/VectorElementDragInfo.h"
@@ -20,8 +21,10 @@
 
 namespace carto {
     class Geometry;
+    class PolygonGeometry;
     class VectorElement;
     class PointStyle;
+    class PolygonDrawData;
     class VectorEditEventListener;
 
     /**
@@ -119,23 +122,40 @@ namespace carto {
         void removeElementPoint(std::shared_ptr<VectorElement> element, const std::shared_ptr<Point>& dragPoint);
         std::shared_ptr<Geometry> removeGeometryPoint(std::shared_ptr<Geometry> geometry, int& offset, int index);
 
+        bool patchSelectedElementDrawData(const std::shared_ptr<VectorElement>& element, const ViewState& viewState);
+        void restorePatchedDrawData(const std::shared_ptr<VectorElement>& element);
+
         void syncElementOverlayPoints(const std::shared_ptr<VectorElement>& element);
-        void createGeometryOverlayPoints(const std::shared_ptr<Geometry>& geometry, int& index, std::vector<std::shared_ptr<Point> >& overlayPoints) const;
-        std::shared_ptr<Point> createOverlayPoint(const MapPos& mapPos, bool virtualPoint, int index) const;
+        void syncGeometryOverlayPoints(const std::shared_ptr<Geometry>& geometry, std::size_t& index);
+        void syncOverlayPoint(std::size_t index, const MapPos& mapPos, bool virtualPoint);
+        std::shared_ptr<Point> createOverlayPoint(const MapPos& mapPos, bool virtualPoint);
+        void updateOverlayPoint(const std::shared_ptr<Point>& overlayPoint, const MapPos& mapPos, bool virtualPoint);
+        void removeOverlayPoint(std::size_t index);
+
+        void updateOverlayPointIndex(const std::shared_ptr<Point>& overlayPoint, bool remove);
+        void rebuildOverlayPointIndex();
+        std::shared_ptr<Point> findOverlayPoint(const MapPos& touchPos, const cglib::ray3<double>& ray, const ViewState& viewState);
 
         static bool IsSameElement(const std::shared_ptr<VectorElement>& element1, const std::shared_ptr<VectorElement>& element2);
+
+        static const int MAX_PATCHED_VERTICES = 4;
         
         std::shared_ptr<DataSourceListener> _dataSourceListener;
 
         std::shared_ptr<TouchHandlerListener> _touchHandlerListener;
 
         std::shared_ptr<VectorElement> _selectedVectorElement;
+        std::shared_ptr<PolygonGeometry> _selectedPolygonGeometry; // the geometry the current draw data of the selected polygon was built from
+        std::shared_ptr<PolygonDrawData> _selectedPolygonDrawData;
+        bool _selectedPolygonDrawDataPatched;
 
         std::shared_ptr<PointRenderer> _overlayRenderer;
         std::shared_ptr<PointStyle> _overlayStyleNormal;
         std::shared_ptr<PointStyle> _overlayStyleVirtual;
         std::shared_ptr<PointStyle> _overlayStyleSelected;
         std::vector<std::shared_ptr<Point> > _overlayPoints;
+        KDTreeSpatialIndex<std::shared_ptr<Point> > _overlayPointIndex; // overlay points by their internal draw positions
+        float _overlayPointClickRadius; // the largest click radius of the overlay points in DP units
         std::shared_ptr<Point> _overlayDragPoint;
         std::shared_ptr<Geometry> _overlayDragGeometry;
         MapPos _overlayDragGeometryPos;
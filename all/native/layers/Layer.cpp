@@ -120,6 +120,9 @@ namespace carto {
         _surfaceCreated = true;
     }
     
+    void Layer::setReducedRenderQuality(bool reduced) {
+    }
+    
     bool Layer::onDrawFrame3D(float deltaSeconds, BillboardSorter& billboardSorter, StyleTextureCache& styleCache, const ViewState& viewState) {
         return false;
     }
@@ -125,6 +125,8 @@ namespace carto {
         virtual void loadData(const std::shared_ptr<CullState>& cullState) = 0;
         
         virtual void offsetLayerHorizontally(double offset) = 0;
+
+        virtual void setReducedRenderQuality(bool reduced);
         
         bool isSurfaceCreated();
         virtual void onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager);
@@ -68,7 +68,13 @@ namespace carto {
         _fetchThreadPool(std::make_shared<CancelableThreadPool>()),
         _nmlModelLODTreeEventListener(),
         _dataSource(dataSource),
-        _renderer(std::make_shared<NMLModelLODTreeRenderer>())
+        _renderer(std::make_shared<NMLModelLODTreeRenderer>()),
+        _meshCacheRegistration("NMLModelLODTreeLayer::meshCache", CacheCategory::CACHE_CATEGORY_GENERAL, DEFAULT_MESH_CACHE_SIZE,
+            [this]() { std::lock_guard<std::recursive_mutex> lock(_mutex); return _meshCache.size(); },
+            [this](std::size_t capacity) { std::lock_guard<std::recursive_mutex> lock(_mutex); _meshCache.resize(capacity); }),
+        _textureCacheRegistration("NMLModelLODTreeLayer::textureCache", CacheCategory::CACHE_CATEGORY_GENERAL, DEFAULT_TEXTURE_CACHE_SIZE,
+            [this]() { std::lock_guard<std::recursive_mutex> lock(_mutex); return _textureCache.size(); },
+            [this](std::size_t capacity) { std::lock_guard<std::recursive_mutex> lock(_mutex); _textureCache.resize(capacity); })
     {
         if (!dataSource) {
             throw NullArgumentException("Null dataSource");
@@ -230,6 +236,7 @@ namespace carto {
                 std::shared_ptr<nml::GLMesh> glMesh;
                 if (_meshCache.read(binding.meshId, glMesh)) {
                     _meshMap[binding.meshId] = glMesh;
+                    _meshCacheRegistration.recordHit();
                 } else {
                     if (checkOnly) {
                         return false;
@@ -258,6 +265,7 @@ namespace carto {
                 std::shared_ptr<nml::GLTexture> glTexture;
                 if (_textureCache.read(binding.textureId, glTexture)) {
                     _textureMap[binding.textureId] = glTexture;
+                    _textureCacheRegistration.recordHit();
                 } else {
                     if (checkOnly) {
                         return false;
@@ -15,6 +15,7 @@
 #include "datasources/NMLModelLODTreeDataSource.h"
 #include "graphics/ViewState.h"
 #include "layers/Layer.h"
+#include "utils/MemoryBudgetManager.h"
 
 #include <string>
 #include <memory>
@@ -237,6 +238,9 @@ namespace carto {
     
         std::shared_ptr<NMLModelLODTreeDataSource> _dataSource;
         std::shared_ptr<NMLModelLODTreeRenderer> _renderer;
+
+        MemoryBudgetManager::CacheRegistration _meshCacheRegistration;
+        MemoryBudgetManager::CacheRegistration _textureCacheRegistration;
     };
     
 }
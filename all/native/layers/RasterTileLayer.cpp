@@ -5,6 +5,7 @@
 #include "renderers/drawdatas/TileDrawData.h"
 #include "graphics/Bitmap.h"
 #include "utils/Log.h"
+#include "utils/Tracer.h"
 
 #include <vt/TileId.h>
 #include <vt/Tile.h>
@@ -19,7 +20,13 @@ namespace carto {
         _visibleTileIds(),
         _tempDrawDatas(),
         _visibleCache(128 * 1024 * 1024), // limit should be never reached during normal use cases
-        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE)
+        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE),
+        _visibleCacheRegistration("RasterTileLayer::visibleCache", CacheCategory::CACHE_CATEGORY_VISIBLE, _visibleCache.capacity(),
+            [this]() { std::lock_guard<std::recursive_mutex> lock(_mutex); return _visibleCache.size(); },
+            [](std::size_t) { }),
+        _preloadingCacheRegistration("RasterTileLayer::preloadingCache", CacheCategory::CACHE_CATEGORY_PRELOADING, _preloadingCache.capacity(),
+            [this]() { std::lock_guard<std::recursive_mutex> lock(_mutex); return _preloadingCache.size(); },
+            [this](std::size_t capacity) { std::lock_guard<std::recursive_mutex> lock(_mutex); _preloadingCache.resize(capacity); })
     {
         setCullDelay(DEFAULT_CULL_DELAY);
     }
@@ -28,13 +35,11 @@ namespace carto {
     }
     
     std::size_t RasterTileLayer::getTextureCacheCapacity() const {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        return _preloadingCache.capacity();
+        return _preloadingCacheRegistration.getRequestedCapacity();
     }
     
     void RasterTileLayer::setTextureCacheCapacity(std::size_t capacityInBytes) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        _preloadingCache.resize(capacityInBytes);
+        _preloadingCacheRegistration.setRequestedCapacity(capacityInBytes);
     }
     
     bool RasterTileLayer::tileExists(const MapTile& tile, bool preloadingCache) const {
@@ -69,11 +74,13 @@ namespace carto {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             if (preloadingTile && _preloadingCache.exists(tileId) && _preloadingCache.valid(tileId)) {
                 _preloadingCache.get(tileId);
+                _preloadingCacheRegistration.recordHit();
                 return;
             }
     
             if (!preloadingTile && _visibleCache.exists(tileId) && _visibleCache.valid(tileId)) {
                 _visibleCache.get(tileId);
+                _visibleCacheRegistration.recordHit();
                 return;
             }
         }
@@ -285,21 +292,31 @@ namespace carto {
     
         bool refresh = false;
         for (const MapTile& dataSourceTile : _dataSourceTiles) {
-            std::shared_ptr<TileData> tileData = layer->_dataSource->loadTile(dataSourceTile);
+            std::shared_ptr<TileData> tileData;
+            {
+                Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_TILE_DATA_SOURCE_LOAD_TILE);
+                tileData = layer->_dataSource->loadTile(dataSourceTile);
+            }
             if (!tileData) {
                 break;
             }
             if (tileData->isReplaceWithParent()) {
                 continue;
             }
-            if (!tileData->getData()) {
-                break;
+
+            // Use the decoded bitmap directly if the data source provided it, otherwise decode the data
+            std::shared_ptr<Bitmap> bitmap = tileData->getBitmap();
+            if (!bitmap) {
+                std::shared_ptr<BinaryData> data = tileData->getData();
+                if (!data) {
+                    break;
+                }
+                bitmap = Bitmap::CreateFromCompressed(data);
             }
     
             // Save tile to texture cache, unless invalidated
             vt::TileId vtTile(_tile.getZoom(), _tile.getX(), _tile.getY());
             vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
-            std::shared_ptr<Bitmap> bitmap = Bitmap::CreateFromCompressed(tileData->getData());
             if (bitmap) {
                 // Check if we received the requested tile or extract/scale the corresponding part
                 if (dataSourceTile != _tile) {
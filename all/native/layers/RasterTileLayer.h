@@ -12,6 +12,7 @@
 #include "components/DirectorPtr.h"
 #include "components/Task.h"
 #include "layers/TileLayer.h"
+#include "utils/MemoryBudgetManager.h"
 
 #include <atomic>
 #include <memory>
@@ -52,6 +53,7 @@ namespace carto {
          * whether or not preloading is enabled.
          * The default is 10MB, which should be enough for most use cases with preloading enabled. If preloading is
          * disabled, the cache size should be reduced by the user to conserve memory.
+         * The actual capacity may be smaller, as all tile caches share the global memory budget (see MemoryBudgetManager).
          * @param capacityInBytes The new tile bitmap cache capacity in bytes.
          */
         void setTextureCacheCapacity(std::size_t capacityInBytes);
@@ -103,6 +105,9 @@ namespace carto {
         
         cache::timed_lru_cache<long long, std::shared_ptr<const vt::Tile> > _visibleCache;
         cache::timed_lru_cache<long long, std::shared_ptr<const vt::Tile> > _preloadingCache;
+
+        MemoryBudgetManager::CacheRegistration _visibleCacheRegistration;
+        MemoryBudgetManager::CacheRegistration _preloadingCacheRegistration;
     };
     
 }
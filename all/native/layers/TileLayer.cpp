@@ -15,6 +15,7 @@
 #include "utils/Const.h"
 #include "utils/GeomUtils.h"
 #include "utils/Log.h"
+#include "utils/Tracer.h"
 
 namespace carto {
 
@@ -211,6 +212,8 @@ namespace carto {
     }
     
     void TileLayer::loadData(const std::shared_ptr<CullState>& cullState) {
+        Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_TILE_LAYER_LOAD_DATA);
+
         // This method (from update() or refresh()) might be called from multiple threads
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
@@ -566,6 +569,12 @@ namespace carto {
         return MapBounds(MapPos(std::min(tilePos0.getX(), tilePos1.getX()), std::min(-tilePos0.getY(), -tilePos1.getY())), MapPos(std::max(tilePos0.getX(), tilePos1.getX()), std::max(-tilePos0.getY(), -tilePos1.getY())));
     }
 
+    void TileLayer::setReducedRenderQuality(bool reduced) {
+        if (auto renderer = getRenderer()) {
+            renderer->setReducedQuality(reduced);
+        }
+    }
+
     std::shared_ptr<TileRenderer> TileLayer::getRenderer() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         return _renderer;
@@ -680,7 +689,11 @@ namespace carto {
 
         bool refresh = false;
         for (const MapTile& dataSourceTile : dataSourceTiles) {
-            std::shared_ptr<TileData> tileData = dataSource->loadTile(dataSourceTile);
+            std::shared_ptr<TileData> tileData;
+            {
+                Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_TILE_DATA_SOURCE_LOAD_TILE);
+                tileData = dataSource->loadTile(dataSourceTile);
+            }
             if (!tileData) {
                 break;
             }
@@ -688,6 +701,7 @@ namespace carto {
                 continue;
             }
 
+            // The grid is decoded lazily, when the tile is hit-tested for the first time
             std::shared_ptr<UTFGridTile> utfTile = UTFGridTile::DecodeUTFTile(tileData->getData());
             if (utfTile) {
                 std::lock_guard<std::recursive_mutex> lock(tileLayer->_mutex);
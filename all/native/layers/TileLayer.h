@@ -82,7 +82,7 @@ namespace carto {
          * Loading a new frame may take some time, previous frame is shown during loading.
          * @param frameNr The frame number to display.
          */
-        void setFrameNr(int frameNr);
+        virtual void setFrameNr(int frameNr);
     
         /**
          * Returns the state of the preloading flag of this layer.
@@ -255,6 +255,8 @@ namespace carto {
 
         virtual void loadData(const std::shared_ptr<CullState>& cullState);
 
+        virtual void setReducedRenderQuality(bool reduced);
+
         virtual void updateTileLoadListener();
 
         virtual bool tileExists(const MapTile& tile, bool preloadingCache) const = 0;
@@ -1,12 +1,18 @@
 #include "TorqueTileLayer.h"
+#include "renderers/MapRenderer.h"
 #include "vectortiles/TorqueTileDecoder.h"
 
 #include <vt/Tile.h>
 
+#include <algorithm>
+
 namespace carto {
 
     TorqueTileLayer::TorqueTileLayer(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<TorqueTileDecoder>& decoder) :
-        VectorTileLayer(dataSource, decoder)
+        VectorTileLayer(dataSource, decoder),
+        _torqueTileDecoder(decoder),
+        _frameWindowSize(0),
+        _gpuTimeFiltering(false)
     {
         // Configure base class for Torque
         _useFBO = true;
@@ -23,13 +29,90 @@ namespace carto {
         int count = 0;
         for (long long tileId : getVisibleTileIds()) {
             if (std::shared_ptr<VectorTileDecoder::TileMap> tileMap = getTileMap(tileId)) {
-                auto it = tileMap->find(frameNr);
-                if (it != tileMap->end()) {
-                    count += it->second->getFeatureCount();
+                if (_gpuTimeFiltering.load()) {
+                    auto it = tileMap->find(0);
+                    if (it != tileMap->end()) {
+                        count += it->second->getFeatureCount(frameNr);
+                    }
+                } else {
+                    auto it = tileMap->find(frameNr);
+                    if (it != tileMap->end()) {
+                        count += it->second->getFeatureCount();
+                    }
                 }
             }
         }
         return count;
     }
 
+    int TorqueTileLayer::getFrameWindowSize() const {
+        return _frameWindowSize.load();
+    }
+
+    void TorqueTileLayer::setFrameWindowSize(int frameWindowSize) {
+        _frameWindowSize.store(std::max(0, frameWindowSize));
+        tilesChanged(false);
+    }
+
+    bool TorqueTileLayer::isGPUTimeFiltering() const {
+        return _gpuTimeFiltering.load();
+    }
+
+    void TorqueTileLayer::setGPUTimeFiltering(bool enabled) {
+        _gpuTimeFiltering.store(enabled);
+        tilesChanged(false);
+    }
+
+    void TorqueTileLayer::setFrameNr(int frameNr) {
+        if (!_gpuTimeFiltering.load()) {
+            VectorTileLayer::setFrameNr(frameNr);
+            return;
+        }
+
+        // All frames are already on the GPU, so only the renderer needs the new frame number
+        std::shared_ptr<MapRenderer> mapRenderer;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            _lastFrameNr = _frameNr;
+            _frameNr = frameNr;
+            mapRenderer = _mapRenderer.lock();
+        }
+        if (mapRenderer) {
+            mapRenderer->requestRedraw();
+        }
+    }
+
+    bool TorqueTileLayer::isTileDataRequired() const {
+        return (_frameWindowSize.load() > 0 && !_gpuTimeFiltering.load()) || VectorTileLayer::isTileDataRequired();
+    }
+
+    std::shared_ptr<VectorTileDecoder::TileMap> TorqueTileLayer::decodeTileMap(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData, int frameNr) const {
+        if (_gpuTimeFiltering.load()) {
+            return _torqueTileDecoder->decodeFrameFilteredTile(tile, targetTile, tileData);
+        }
+
+        int frameWindowSize = _frameWindowSize.load();
+        if (frameWindowSize <= 0) {
+            return VectorTileLayer::decodeTileMap(tile, targetTile, tileData, frameNr);
+        }
+
+        // Most of the window is ahead of the current frame, as the animation usually runs forward
+        return _torqueTileDecoder->decodeFrames(tile, targetTile, tileData, frameNr - frameWindowSize / 4, frameWindowSize);
+    }
+
+    bool TorqueTileLayer::isTileMapValid(const VectorTileDecoder::TileMap& tileMap, int frameNr) const {
+        int frameWindowSize = _frameWindowSize.load();
+        int frameCount = _torqueTileDecoder->getFrameCount();
+        if (_gpuTimeFiltering.load() || frameWindowSize <= 0 || frameWindowSize >= frameCount) {
+            return true;
+        }
+
+        // Start decoding the next window when the animation has passed the middle of the current one
+        return tileMap.find(frameNr % frameCount) != tileMap.end() && tileMap.find((frameNr + frameWindowSize / 2) % frameCount) != tileMap.end();
+    }
+
+    int TorqueTileLayer::getTileMapFrameNr(const MapTile& mapTile) const {
+        return _gpuTimeFiltering.load() ? 0 : VectorTileLayer::getTileMapFrameNr(mapTile);
+    }
+
 }
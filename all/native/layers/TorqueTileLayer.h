@@ -9,6 +9,7 @@
 
 #include "layers/VectorTileLayer.h"
 
+#include <atomic>
 #include <memory>
 
 namespace carto {
@@ -34,6 +35,47 @@ namespace carto {
          * @return The number of visible feature at the specified frame. If the frame is missing, 0 is returned.
          */
         int countVisibleFeatures(int frameNr) const;
+
+        /**
+         * Returns the number of animation frames decoded at once for each tile.
+         * @return The number of frames decoded at once. 0 means that all frames are decoded.
+         */
+        int getFrameWindowSize() const;
+        /**
+         * Sets the number of animation frames decoded at once for each tile. If set, only a window of frames around the current frame
+         * is kept in memory and the window is moved as the animation advances. This reduces memory usage of long animations, at the cost of
+         * periodically decoding the tiles again. Note that frames outside of the window are not counted by countVisibleFeatures.
+         * The default is 0, meaning that all frames are decoded.
+         * @param frameWindowSize The new number of frames to decode at once.
+         */
+        void setFrameWindowSize(int frameWindowSize);
+
+        /**
+         * Returns the state of GPU-side time filtering.
+         * @return True if GPU-side time filtering is enabled.
+         */
+        bool isGPUTimeFiltering() const;
+        /**
+         * Enables or disables GPU-side time filtering. If enabled, all frames of a tile are uploaded to the GPU at once
+         * and points not belonging to the current frame are discarded when rendering. Changing the frame then requires no tile processing,
+         * at the cost of larger GPU memory usage. When enabled, the frame window size is ignored.
+         * The default is false.
+         * @param enabled True if GPU-side time filtering should be enabled.
+         */
+        void setGPUTimeFiltering(bool enabled);
+
+        virtual void setFrameNr(int frameNr);
+
+    protected:
+        virtual bool isTileDataRequired() const;
+        virtual std::shared_ptr<VectorTileDecoder::TileMap> decodeTileMap(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData, int frameNr) const;
+        virtual bool isTileMapValid(const VectorTileDecoder::TileMap& tileMap, int frameNr) const;
+        virtual int getTileMapFrameNr(const MapTile& mapTile) const;
+
+    private:
+        const std::shared_ptr<TorqueTileDecoder> _torqueTileDecoder;
+        std::atomic<int> _frameWindowSize;
+        std::atomic<bool> _gpuTimeFiltering;
     };
 }
 
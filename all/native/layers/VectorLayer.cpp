@@ -44,7 +44,6 @@ namespace carto {
         Layer(),
         _dataSource(dataSource),
         _dataSourceListener(),
-        _vectorElementEventListener(),
         _billboardRenderer(std::make_shared<BillboardRenderer>()),
         _geometryCollectionRenderer(std::make_shared<GeometryCollectionRenderer>()),
         _lineRenderer(std::make_shared<LineRenderer>()),
@@ -52,6 +51,7 @@ namespace carto {
         _polygonRenderer(std::make_shared<PolygonRenderer>()),
         _polygon3DRenderer(std::make_shared<Polygon3DRenderer>()),
         _nmlModelRenderer(std::make_shared<NMLModelRenderer>()),
+        _vectorElementEventListener(),
         _lastTask()
     {
         if (!dataSource) {
@@ -134,9 +134,6 @@ namespace carto {
     
         const DirectorPtr<VectorDataSource> _dataSource;
         std::shared_ptr<VectorDataSource::OnChangeListener> _dataSourceListener;
-        
-    private:
-        ThreadSafeDirectorPtr<VectorElementEventListener> _vectorElementEventListener;
 
         std::shared_ptr<BillboardRenderer> _billboardRenderer;
         std::shared_ptr<GeometryCollectionRenderer> _geometryCollectionRenderer;
@@ -145,6 +142,9 @@ namespace carto {
         std::shared_ptr<PolygonRenderer> _polygonRenderer;
         std::shared_ptr<Polygon3DRenderer> _polygon3DRenderer;
         std::shared_ptr<NMLModelRenderer> _nmlModelRenderer;
+        
+    private:
+        ThreadSafeDirectorPtr<VectorElementEventListener> _vectorElementEventListener;
     
         std::shared_ptr<CancelableTask> _lastTask;
     };
@@ -11,12 +11,15 @@
 #include "renderers/drawdatas/TileDrawData.h"
 #include "utils/Log.h"
 #include "utils/Const.h"
+#include "utils/Tracer.h"
 #include "ui/VectorTileClickInfo.h"
 #include "vectortiles/VectorTileDecoder.h"
 
 #include <vt/TileId.h>
 #include <vt/Tile.h>
 
+#include <algorithm>
+
 namespace carto {
 
     VectorTileLayer::VectorTileLayer(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<VectorTileDecoder>& decoder) :
@@ -28,13 +31,20 @@ namespace carto {
         _vectorTileEventListener(),
         _labelRenderOrder(VectorTileRenderOrder::VECTOR_TILE_RENDER_ORDER_LAYER),
         _buildingRenderOrder(VectorTileRenderOrder::VECTOR_TILE_RENDER_ORDER_LAST),
+        _compactGeometryMode(false),
         _tileDecoder(decoder),
         _tileDecoderListener(),
         _labelCullThreadPool(std::make_shared<CancelableThreadPool>()),
         _visibleTileIds(),
         _tempDrawDatas(),
         _visibleCache(DEFAULT_VISIBLE_CACHE_SIZE),
-        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE)
+        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE),
+        _visibleCacheRegistration("VectorTileLayer::visibleCache", CacheCategory::CACHE_CATEGORY_VISIBLE, _visibleCache.capacity(),
+            [this]() { std::lock_guard<std::recursive_mutex> lock(_mutex); return _visibleCache.size(); },
+            [](std::size_t) { }),
+        _preloadingCacheRegistration("VectorTileLayer::preloadingCache", CacheCategory::CACHE_CATEGORY_PRELOADING, _preloadingCache.capacity(),
+            [this]() { std::lock_guard<std::recursive_mutex> lock(_mutex); return _preloadingCache.size(); },
+            [this](std::size_t capacity) { std::lock_guard<std::recursive_mutex> lock(_mutex); _preloadingCache.resize(capacity); })
     {
         if (!decoder) {
             throw NullArgumentException("Null decoder");
@@ -55,13 +65,11 @@ namespace carto {
     }
     
     std::size_t VectorTileLayer::getTileCacheCapacity() const {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        return _preloadingCache.capacity();
+        return _preloadingCacheRegistration.getRequestedCapacity();
     }
     
     void VectorTileLayer::setTileCacheCapacity(std::size_t capacityInBytes) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
-        _preloadingCache.resize(capacityInBytes);
+        _preloadingCacheRegistration.setRequestedCapacity(capacityInBytes);
     }
     
     VectorTileRenderOrder::VectorTileRenderOrder VectorTileLayer::getLabelRenderOrder() const {
@@ -99,6 +107,22 @@ namespace carto {
         tilesChanged(false); // we must reload the tiles, we do not keep full element information if this is not required
     }
     
+    bool VectorTileLayer::isCompactGeometryMode() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _compactGeometryMode;
+    }
+    
+    void VectorTileLayer::setCompactGeometryMode(bool enabled) {
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            _compactGeometryMode = enabled;
+        }
+        if (auto renderer = getRenderer()) {
+            updateTileReloader(renderer);
+        }
+        tilesChanged(false); // reload the tiles, as cached tiles are accounted differently in compact mode
+    }
+    
     bool VectorTileLayer::tileExists(const MapTile& tile, bool preloadingCache) const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         long long tileId = getTileId(tile);
@@ -113,12 +137,13 @@ namespace carto {
     bool VectorTileLayer::tileValid(const MapTile& tile, bool preloadingCache) const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         long long tileId = getTileId(tile);
-        if (preloadingCache) {
-            return _preloadingCache.exists(tileId) && _preloadingCache.valid(tileId);
-        }
-        else {
-            return _visibleCache.exists(tileId) && _visibleCache.valid(tileId);
+        const cache::timed_lru_cache<long long, TileInfo>& cache = preloadingCache ? _preloadingCache : _visibleCache;
+        TileInfo tileInfo;
+        if (!(cache.exists(tileId) && cache.valid(tileId) && cache.peek(tileId, tileInfo))) {
+            return false;
         }
+        // The decoded frames may not cover the requested frame
+        return !tileInfo.getTileMap() || isTileMapValid(*tileInfo.getTileMap(), tile.getFrameNr());
     }
     
     void VectorTileLayer::fetchTile(const MapTile& tile, bool preloadingTile, bool invalidated) {
@@ -129,13 +154,15 @@ namespace carto {
 
         if (!invalidated) {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
-            if (preloadingTile && _preloadingCache.exists(tileId) && _preloadingCache.valid(tileId)) {
+            if (preloadingTile && tileValid(tile, true)) {
                 _preloadingCache.get(tileId);
+                _preloadingCacheRegistration.recordHit();
                 return;
             }
     
-            if (!preloadingTile && _visibleCache.exists(tileId) && _visibleCache.valid(tileId)) {
+            if (!preloadingTile && tileValid(tile, false)) {
                 _visibleCache.get(tileId);
+                _visibleCacheRegistration.recordHit();
                 return;
             }
         }
@@ -203,6 +230,22 @@ namespace carto {
         return std::shared_ptr<VectorTileDecoder::TileMap>();
     }
     
+    bool VectorTileLayer::isTileDataRequired() const {
+        return _vectorTileEventListener.get() ? true : false;
+    }
+
+    std::shared_ptr<VectorTileDecoder::TileMap> VectorTileLayer::decodeTileMap(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData, int frameNr) const {
+        return _tileDecoder->decodeTile(tile, targetTile, tileData);
+    }
+
+    bool VectorTileLayer::isTileMapValid(const VectorTileDecoder::TileMap& tileMap, int frameNr) const {
+        return true;
+    }
+
+    int VectorTileLayer::getTileMapFrameNr(const MapTile& mapTile) const {
+        return _useTileMapMode ? mapTile.getFrameNr() : 0;
+    }
+    
     void VectorTileLayer::calculateDrawData(const MapTile& visTile, const MapTile& closestTile, bool preloadingTile) {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
@@ -213,7 +256,7 @@ namespace carto {
             _preloadingCache.read(closestTileId, tileInfo);
         }
         if (std::shared_ptr<VectorTileDecoder::TileMap> tileMap = tileInfo.getTileMap()) {
-            auto it = tileMap->find(_useTileMapMode ? closestTile.getFrameNr() : 0);
+            auto it = tileMap->find(getTileMapFrameNr(closestTile));
             if (it != tileMap->end()) {
                 std::shared_ptr<const vt::Tile> vtTile = it->second;
                 vt::TileId vtTileId(visTile.getZoom(), visTile.getX(), visTile.getY());
@@ -387,6 +430,7 @@ namespace carto {
     
         // Create new rendererer, simply drop old one (if exists)
         auto renderer = std::make_shared<TileRenderer>(_mapRenderer, _useFBO, _useDepth, _useStencil);
+        updateTileReloader(renderer);
         renderer->onSurfaceCreated(shaderManager, textureManager);
         setRenderer(renderer);
     }
@@ -402,6 +446,7 @@ namespace carto {
             renderer->setLabelOrder(static_cast<int>(getLabelRenderOrder()));
             renderer->setBuildingOrder(static_cast<int>(getBuildingRenderOrder()));
             renderer->setInteractionMode(_vectorTileEventListener.get() ? true : false);
+            renderer->setFrameNr(getFrameNr());
             return renderer->onDrawFrame(deltaSeconds, viewState);
         }
         return false;
@@ -447,6 +492,101 @@ namespace carto {
         _tileDecoderListener.reset();
     }
     
+    std::shared_ptr<const vt::Tile> VectorTileLayer::reloadTile(const std::shared_ptr<const vt::Tile>& vtTile) const {
+        TileInfo tileInfo;
+        int tileMapKey = 0;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+            const vt::TileId& vtTileId = vtTile->getTileId();
+            long long tileId = getTileId(MapTile(vtTileId.x, vtTileId.y, vtTileId.zoom, _frameNr));
+            if (!_visibleCache.peek(tileId, tileInfo)) {
+                _preloadingCache.peek(tileId, tileInfo);
+            }
+            if (!tileInfo.getTileMap()) {
+                return std::shared_ptr<const vt::Tile>();
+            }
+
+            auto it = std::find_if(tileInfo.getTileMap()->begin(), tileInfo.getTileMap()->end(), [&vtTile](const std::pair<const int, std::shared_ptr<const vt::Tile> >& entry) { return entry.second == vtTile; });
+            if (it == tileInfo.getTileMap()->end()) {
+                return std::shared_ptr<const vt::Tile>();
+            }
+            tileMapKey = it->first;
+        }
+
+        if (!tileInfo.getTileData()) {
+            Log::Warn("VectorTileLayer::reloadTile: Failed to find tile data");
+            return std::shared_ptr<const vt::Tile>();
+        }
+
+        std::shared_ptr<VectorTileDecoder::TileMap> tileMap;
+        {
+            Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_VECTOR_TILE_DECODE);
+            const MapTile& dataSourceTile = tileInfo.getDataSourceTile();
+            vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
+            tileMap = decodeTileMap(vtDataSourceTile, vtTile->getTileId(), tileInfo.getTileData(), tileMapKey);
+        }
+        if (!tileMap) {
+            Log::Error("VectorTileLayer::reloadTile: Failed to decode tile");
+            return std::shared_ptr<const vt::Tile>();
+        }
+        auto it = tileMap->find(tileMapKey);
+        return it != tileMap->end() ? it->second : std::shared_ptr<const vt::Tile>();
+    }
+
+    bool VectorTileLayer::redecodeCachedTile(long long tileId, const vt::TileId& vtTile, bool preloadingCache, int frameNr) {
+        TileInfo tileInfo;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            cache::timed_lru_cache<long long, TileInfo>& cache = preloadingCache ? _preloadingCache : _visibleCache;
+            if (!(cache.exists(tileId) && cache.valid(tileId) && cache.peek(tileId, tileInfo))) {
+                return false;
+            }
+            if (!tileInfo.getTileData() || !tileInfo.getTileMap() || isTileMapValid(*tileInfo.getTileMap(), frameNr)) {
+                return false;
+            }
+        }
+
+        std::shared_ptr<VectorTileDecoder::TileMap> tileMap;
+        {
+            Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_VECTOR_TILE_DECODE);
+            const MapTile& dataSourceTile = tileInfo.getDataSourceTile();
+            vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
+            tileMap = decodeTileMap(vtDataSourceTile, vtTile, tileInfo.getTileData(), frameNr);
+        }
+        if (!tileMap) {
+            return false;
+        }
+
+        // Replace the frames in place and store the entry again, so that the cache accounts for the size of the new frames.
+        // Storing resets the expiration time of the entry, so restore it afterwards.
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        cache::timed_lru_cache<long long, TileInfo>& cache = preloadingCache ? _preloadingCache : _visibleCache;
+        if (!(cache.exists(tileId) && cache.valid(tileId))) {
+            return false;
+        }
+        tileInfo.getTileMap()->swap(*tileMap);
+        cache.put(tileId, tileInfo, tileInfo.getSize(preloadingCache ? false : _compactGeometryMode));
+        if (tileInfo.getExpirationTime()) {
+            cache.invalidate(tileId, *tileInfo.getExpirationTime());
+        }
+        return true;
+    }
+
+    void VectorTileLayer::updateTileReloader(const std::shared_ptr<TileRenderer>& renderer) {
+        if (isCompactGeometryMode()) {
+            std::weak_ptr<VectorTileLayer> layerWeak(std::static_pointer_cast<VectorTileLayer>(shared_from_this()));
+            renderer->setTileReloader([layerWeak](const std::shared_ptr<const vt::Tile>& vtTile) {
+                if (auto layer = layerWeak.lock()) {
+                    return layer->reloadTile(vtTile);
+                }
+                return std::shared_ptr<const vt::Tile>();
+            });
+        } else {
+            renderer->setTileReloader(std::function<std::shared_ptr<const vt::Tile>(const std::shared_ptr<const vt::Tile>&)>());
+        }
+    }
+    
     VectorTileLayer::TileDecoderListener::TileDecoderListener(const std::shared_ptr<VectorTileLayer>& layer) :
         _layer(layer)
     {
@@ -467,10 +607,21 @@ namespace carto {
     
     bool VectorTileLayer::FetchTask::loadTile(const std::shared_ptr<TileLayer>& tileLayer) {
         auto layer = std::static_pointer_cast<VectorTileLayer>(tileLayer);
+        int frameNr = layer->getFrameNr();
+        vt::TileId vtTile(_tile.getZoom(), _tile.getX(), _tile.getY());
+
+        // If the cached tile is otherwise valid, decode the frames from the retained data instead of reloading the tile
+        if (!isInvalidated() && layer->redecodeCachedTile(layer->getTileId(_tile), vtTile, isPreloading(), frameNr)) {
+            return true;
+        }
         
         bool refresh = false;
         for (const MapTile& dataSourceTile : _dataSourceTiles) {
-            std::shared_ptr<TileData> tileData = layer->_dataSource->loadTile(dataSourceTile);
+            std::shared_ptr<TileData> tileData;
+            {
+                Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_TILE_DATA_SOURCE_LOAD_TILE);
+                tileData = layer->_dataSource->loadTile(dataSourceTile);
+            }
             if (!tileData) {
                 break;
             }
@@ -481,28 +632,35 @@ namespace carto {
                 break;
             }
     
-            vt::TileId vtTile(_tile.getZoom(), _tile.getX(), _tile.getY());
             vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
-            std::shared_ptr<VectorTileDecoder::TileMap> tileMap = layer->_tileDecoder->decodeTile(vtDataSourceTile, vtTile, tileData->getData());
+            std::shared_ptr<VectorTileDecoder::TileMap> tileMap;
+            {
+                Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_VECTOR_TILE_DECODE);
+                tileMap = layer->decodeTileMap(vtDataSourceTile, vtTile, tileData->getData(), frameNr);
+            }
             if (tileMap) {
-                // Construct tile info - keep original data if interactivity is required
-                VectorTileLayer::TileInfo tileInfo(layer->calculateMapTileBounds(dataSourceTile.getFlipped()), layer->_vectorTileEventListener.get() ? tileData->getData() : std::shared_ptr<BinaryData>(), tileMap);
+                // Construct tile info - keep original data if interactivity or frame streaming requires it
+                std::shared_ptr<std::chrono::steady_clock::time_point> expirationTime;
+                if (tileData->getMaxAge() >= 0) {
+                    expirationTime = std::make_shared<std::chrono::steady_clock::time_point>(std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+                }
+                VectorTileLayer::TileInfo tileInfo(dataSourceTile, layer->calculateMapTileBounds(dataSourceTile.getFlipped()), layer->isTileDataRequired() ? tileData->getData() : std::shared_ptr<BinaryData>(), tileMap, expirationTime);
 
                 // Store tile to cache, unless invalidated
                 if (!isInvalidated()) {
                     long long tileId = layer->getTileId(_tile);
                     if (isPreloading()) {
                         std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
-                        layer->_preloadingCache.put(tileId, tileInfo, tileInfo.getSize());
-                        if (tileData->getMaxAge() >= 0) {
-                            layer->_preloadingCache.invalidate(tileId, std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+                        layer->_preloadingCache.put(tileId, tileInfo, tileInfo.getSize(false));
+                        if (expirationTime) {
+                            layer->_preloadingCache.invalidate(tileId, *expirationTime);
                         }
                     }
                     else {
                         std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
-                        layer->_visibleCache.put(tileId, tileInfo, tileInfo.getSize());
-                        if (tileData->getMaxAge() >= 0) {
-                            layer->_visibleCache.invalidate(tileId, std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+                        layer->_visibleCache.put(tileId, tileInfo, tileInfo.getSize(layer->_compactGeometryMode));
+                        if (expirationTime) {
+                            layer->_visibleCache.invalidate(tileId, *expirationTime);
                         }
                     }
                 }
@@ -554,13 +712,21 @@ namespace carto {
         }
     }
 
-    std::size_t VectorTileLayer::TileInfo::getSize() const {
+    std::size_t VectorTileLayer::TileInfo::getSize(bool compactGeometry) const {
         std::size_t size = EXTRA_TILE_FOOTPRINT;
         if (_tileData) {
             size += _tileData->size();
         }
         for (auto it = _tileMap->begin(); it != _tileMap->end(); it++) {
             size += it->second->getResidentSize();
+            if (compactGeometry) {
+                // Vertex arrays are released once the tile is drawn, only GPU copies are kept
+                for (const std::shared_ptr<vt::TileLayer>& vtLayer : it->second->getLayers()) {
+                    for (const std::shared_ptr<vt::TileGeometry>& vtGeometry : vtLayer->getGeometries()) {
+                        size -= vtGeometry->getVertexArraysSize();
+                    }
+                }
+            }
         }
         return size;
     }
@@ -13,8 +13,10 @@
 #include "components/DirectorPtr.h"
 #include "components/Task.h"
 #include "layers/TileLayer.h"
+#include "utils/MemoryBudgetManager.h"
 #include "vectortiles/VectorTileDecoder.h"
 
+#include <chrono>
 #include <memory>
 #include <map>
 
@@ -76,6 +78,7 @@ namespace carto {
          * The more tiles are visible on the screen, the larger this cache should be. 
          * The default is 10MB, which should be enough for most use cases with preloading enabled. If preloading is
          * disabled, the cache size should be reduced by the user to conserve memory.
+         * The actual capacity may be smaller, as all tile caches share the global memory budget (see MemoryBudgetManager).
          * @param capacityInBytes The new tile bitmap cache capacity in bytes.
          */
         void setTileCacheCapacity(std::size_t capacityInBytes);
@@ -112,6 +115,20 @@ namespace carto {
          * @param eventListener The vector tile event listener.
          */
         void setVectorTileEventListener(const std::shared_ptr<VectorTileEventListener>& eventListener);
+
+        /**
+         * Returns the state of the compact geometry mode.
+         * @return True if compact geometry mode is enabled.
+         */
+        bool isCompactGeometryMode() const;
+        /**
+         * Sets the state of the compact geometry mode. In compact mode the CPU-side copies of tile geometry are released
+         * once the geometry is uploaded to the GPU, even if a vector tile event listener is attached. The data needed for picking is
+         * rebuilt from the original tile data when a click needs it. This allows the tile caches to hold several times more tiles,
+         * at the cost of slower click handling. The default is false.
+         * @param enabled True if compact geometry mode should be used.
+         */
+        void setCompactGeometryMode(bool enabled);
     
     protected:
         virtual bool tileExists(const MapTile& mapTile, bool preloadingCache) const;
@@ -123,6 +140,11 @@ namespace carto {
         virtual long long getTileId(const MapTile& mapTile) const;
         virtual std::shared_ptr<VectorTileDecoder::TileMap> getTileMap(long long tileId) const;
 
+        virtual bool isTileDataRequired() const;
+        virtual std::shared_ptr<VectorTileDecoder::TileMap> decodeTileMap(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData, int frameNr) const;
+        virtual bool isTileMapValid(const VectorTileDecoder::TileMap& tileMap, int frameNr) const;
+        virtual int getTileMapFrameNr(const MapTile& mapTile) const;
+
         virtual void calculateDrawData(const MapTile& visTile, const MapTile& closestTile, bool preloadingTile);
         virtual void refreshDrawData(const std::shared_ptr<CullState>& cullState);
     
@@ -184,21 +206,29 @@ namespace carto {
 
         class TileInfo {
         public:
-            TileInfo() : _tileBounds(), _tileData(), _tileMap() { }
-            TileInfo(const MapBounds& tileBounds, const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<VectorTileDecoder::TileMap>& tileMap) : _tileBounds(tileBounds), _tileData(tileData), _tileMap(tileMap) { }
+            TileInfo() : _dataSourceTile(0, 0, 0, 0), _tileBounds(), _tileData(), _tileMap(), _expirationTime() { }
+            TileInfo(const MapTile& dataSourceTile, const MapBounds& tileBounds, const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<VectorTileDecoder::TileMap>& tileMap, const std::shared_ptr<std::chrono::steady_clock::time_point>& expirationTime) : _dataSourceTile(dataSourceTile), _tileBounds(tileBounds), _tileData(tileData), _tileMap(tileMap), _expirationTime(expirationTime) { }
 
+            const MapTile& getDataSourceTile() const { return _dataSourceTile; }
             const MapBounds& getTileBounds() const { return _tileBounds; }
             const std::shared_ptr<BinaryData>& getTileData() const { return _tileData; }
             const std::shared_ptr<VectorTileDecoder::TileMap>& getTileMap() const { return _tileMap; }
+            const std::shared_ptr<std::chrono::steady_clock::time_point>& getExpirationTime() const { return _expirationTime; }
 
-            std::size_t getSize() const;
+            std::size_t getSize(bool compactGeometry) const;
 
         private:
+            MapTile _dataSourceTile;
             MapBounds _tileBounds;
             std::shared_ptr<BinaryData> _tileData;
             std::shared_ptr<VectorTileDecoder::TileMap> _tileMap;
+            std::shared_ptr<std::chrono::steady_clock::time_point> _expirationTime; // the expiration time given to the cache, as the cache resets it when the entry is stored again
         };
 
+        std::shared_ptr<const vt::Tile> reloadTile(const std::shared_ptr<const vt::Tile>& vtTile) const;
+        bool redecodeCachedTile(long long tileId, const vt::TileId& vtTile, bool preloadingCache, int frameNr);
+        void updateTileReloader(const std::shared_ptr<TileRenderer>& renderer);
+
         static const int DEFAULT_CULL_DELAY = 200;
         static const int PRELOADING_PRIORITY_OFFSET = -2;
         static const int EXTRA_TILE_FOOTPRINT = 4096;
@@ -209,6 +239,7 @@ namespace carto {
 
         VectorTileRenderOrder::VectorTileRenderOrder _labelRenderOrder;
         VectorTileRenderOrder::VectorTileRenderOrder _buildingRenderOrder;
+        bool _compactGeometryMode;
     
         const std::shared_ptr<VectorTileDecoder> _tileDecoder;
         std::shared_ptr<TileDecoderListener> _tileDecoderListener;
@@ -220,6 +251,9 @@ namespace carto {
 
         cache::timed_lru_cache<long long, TileInfo> _visibleCache;
         cache::timed_lru_cache<long long, TileInfo> _preloadingCache;
+
+        MemoryBudgetManager::CacheRegistration _visibleCacheRegistration;
+        MemoryBudgetManager::CacheRegistration _preloadingCacheRegistration;
     };
     
 }
@@ -1,6 +1,11 @@
 #include "UTFGridTile.h"
 #include "core/BinaryData.h"
 #include "utils/Log.h"
+#include "utils/Tracer.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #include <boost/lexical_cast.hpp>
 
@@ -55,67 +60,164 @@ namespace {
 
 namespace carto {
 
+    struct UTFGridTile::DecodedGrid {
+        struct KeyRun {
+            int endX; // exclusive
+            int keyId;
+
+            explicit KeyRun(int endX, int keyId) : endX(endX), keyId(keyId) { }
+        };
+
+        int xSize = 0;
+        int ySize = 0;
+        std::vector<std::string> keys;
+        std::vector<KeyRun> keyRuns; // run-length encoded key ids, row by row
+        std::vector<std::size_t> rowOffsets; // offsets of rows in keyRuns, one extra element at the end
+        rapidjson::Document document; // kept for the data objects, which are converted only when requested
+        std::map<std::string, Variant> data; // converted data objects
+    };
+
+    UTFGridTile::UTFGridTile(const std::shared_ptr<BinaryData>& tileData) :
+        _tileData(tileData),
+        _decodedGrid(),
+        _mutex()
+    {
+    }
+
+    UTFGridTile::~UTFGridTile() {
+    }
+
+    std::string UTFGridTile::getKey(int keyId) const {
+        std::shared_ptr<DecodedGrid> decodedGrid = getDecodedGrid();
+        if (!decodedGrid) {
+            return std::string();
+        }
+        return keyId >= 0 && keyId < static_cast<int>(decodedGrid->keys.size()) ? decodedGrid->keys[keyId] : std::string();
+    }
+
+    Variant UTFGridTile::getData(const std::string& key) const {
+        std::shared_ptr<DecodedGrid> decodedGrid = getDecodedGrid();
+        if (!decodedGrid) {
+            return Variant();
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = decodedGrid->data.find(key);
+        if (it == decodedGrid->data.end()) {
+            Variant value;
+            rapidjson::Value::ConstMemberIterator dataIt = decodedGrid->document.FindMember("data");
+            if (dataIt != decodedGrid->document.MemberEnd() && dataIt->value.IsObject()) {
+                rapidjson::Value::ConstMemberIterator valueIt = dataIt->value.FindMember(key.c_str());
+                if (valueIt != dataIt->value.MemberEnd()) {
+                    value = rapidJSONToVariant(valueIt->value);
+                }
+            }
+            it = decodedGrid->data.emplace(key, value).first;
+        }
+        return it->second;
+    }
+
+    int UTFGridTile::getXSize() const {
+        std::shared_ptr<DecodedGrid> decodedGrid = getDecodedGrid();
+        return decodedGrid ? decodedGrid->xSize : 0;
+    }
+    
+    int UTFGridTile::getYSize() const {
+        std::shared_ptr<DecodedGrid> decodedGrid = getDecodedGrid();
+        return decodedGrid ? decodedGrid->ySize : 0;
+    }
+    
+    int UTFGridTile::getKeyId(int x, int y) const {
+        std::shared_ptr<DecodedGrid> decodedGrid = getDecodedGrid();
+        if (!decodedGrid || x < 0 || y < 0 || x >= decodedGrid->xSize || y >= decodedGrid->ySize) {
+            return 0;
+        }
+
+        auto rowBegin = decodedGrid->keyRuns.begin() + decodedGrid->rowOffsets[y];
+        auto rowEnd = decodedGrid->keyRuns.begin() + decodedGrid->rowOffsets[y + 1];
+        auto it = std::upper_bound(rowBegin, rowEnd, x, [](int x, const DecodedGrid::KeyRun& keyRun) { return x < keyRun.endX; });
+        return it != rowEnd ? it->keyId : 0;
+    }
+
     std::shared_ptr<UTFGridTile> UTFGridTile::DecodeUTFTile(const std::shared_ptr<BinaryData>& tileData) {
         if (!tileData) {
             Log::Error("UTFGridTile::DecodeUTFTile: Null tile data");
             return std::shared_ptr<UTFGridTile>();
         }
+        return std::make_shared<UTFGridTile>(tileData);
+    }
 
-        std::string json(reinterpret_cast<const char*>(tileData->data()), tileData->size());
-        rapidjson::Document doc;
-        if (doc.Parse<rapidjson::kParseDefaultFlags>(json.c_str()).HasParseError()) {
-            Log::Error("UTFGridTile::DecodeUTFTile: Failed to parse JSON");
-            return std::shared_ptr<UTFGridTile>();
+    std::shared_ptr<UTFGridTile::DecodedGrid> UTFGridTile::getDecodedGrid() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_decodedGrid || !_tileData) {
+            return _decodedGrid;
         }
 
-        std::vector<std::string> keys;
-        for (unsigned int i = 0; i < doc["keys"].Size(); i++) {
-            keys.push_back(doc["keys"][i].GetString());
-        }
+        Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_UTF_GRID_DECODE);
 
-        std::map<std::string, Variant> data;
-        if (doc.FindMember("data") != doc.MemberEnd()) {
-            for (rapidjson::Value::ConstMemberIterator it = doc["data"].MemberBegin(); it != doc["data"].MemberEnd(); ++it) {
-                if (!it->name.IsString()) {
-                    continue;
-                }
+        // Release the raw data even if decoding fails, so that decoding is not retried
+        std::shared_ptr<BinaryData> tileData;
+        std::swap(tileData, _tileData);
 
-                data[it->name.GetString()] = rapidJSONToVariant(it->value);
-            }
+        auto decodedGrid = std::make_shared<DecodedGrid>();
+        rapidjson::Document& doc = decodedGrid->document;
+        std::string json(reinterpret_cast<const char*>(tileData->data()), tileData->size());
+        if (doc.Parse<rapidjson::kParseDefaultFlags>(json.c_str()).HasParseError() || !doc.IsObject()) {
+            Log::Error("UTFGridTile::getDecodedGrid: Failed to parse JSON");
+            return std::shared_ptr<DecodedGrid>();
         }
 
-        unsigned int rows = doc["grid"].Size();
-        unsigned int cols = 0;
-        for (unsigned int i = 0; i < rows; i++) {
-            std::string columnUTF8 = doc["grid"][i].GetString();
-            std::vector<std::uint32_t> column;
-            column.reserve(columnUTF8.size());
-            utf8::utf8to32(columnUTF8.begin(), columnUTF8.end(), std::back_inserter(column));
+        rapidjson::Value::ConstMemberIterator keysIt = doc.FindMember("keys");
+        rapidjson::Value::ConstMemberIterator gridIt = doc.FindMember("grid");
+        if (keysIt == doc.MemberEnd() || !keysIt->value.IsArray() || gridIt == doc.MemberEnd() || !gridIt->value.IsArray()) {
+            Log::Error("UTFGridTile::getDecodedGrid: Missing keys or grid");
+            return std::shared_ptr<DecodedGrid>();
+        }
 
-            cols = std::max(cols, static_cast<unsigned int>(column.size()));
+        for (rapidjson::Value::ConstValueIterator it = keysIt->value.Begin(); it != keysIt->value.End(); it++) {
+            decodedGrid->keys.push_back(it->IsString() ? it->GetString() : std::string());
         }
-        std::vector<int> keyIds;
-        keyIds.reserve(cols * rows);
-        for (unsigned int i = 0; i < rows; i++) {
-            std::string columnUTF8 = doc["grid"][i].GetString();
-            std::vector<std::uint32_t> column;
-            column.reserve(columnUTF8.size());
-            utf8::utf8to32(columnUTF8.begin(), columnUTF8.end(), std::back_inserter(column));
 
-            if (column.size() != cols) {
-                Log::Warnf("UTFGridTile::DecodeUTFTile: Mismatching rows/columns");
-                column.resize(cols - column.size(), ' ');
+        // Decode rows directly into runs of equal key ids
+        int cols = 0;
+        decodedGrid->rowOffsets.reserve(gridIt->value.Size() + 1);
+        for (rapidjson::Value::ConstValueIterator rowIt = gridIt->value.Begin(); rowIt != gridIt->value.End(); rowIt++) {
+            decodedGrid->rowOffsets.push_back(decodedGrid->keyRuns.size());
+            if (!rowIt->IsString()) {
+                continue;
             }
 
-            for (std::size_t j = 0; j < column.size(); j++) {
-                std::uint32_t code = column[j];
-                if (code >= 93) code--;
-                if (code >= 35) code--;
-                code -= 32;
-                keyIds.push_back(code);
+            const char* rowUTF8 = rowIt->GetString();
+            const char* rowUTF8End = rowUTF8 + rowIt->GetStringLength();
+            int x = 0;
+            try {
+                while (rowUTF8 != rowUTF8End) {
+                    std::uint32_t code = utf8::next(rowUTF8, rowUTF8End);
+                    if (code >= 93) code--;
+                    if (code >= 35) code--;
+                    code -= 32;
+                    int keyId = static_cast<int>(code);
+
+                    if (x > 0 && decodedGrid->keyRuns.back().keyId == keyId) {
+                        decodedGrid->keyRuns.back().endX = x + 1;
+                    } else {
+                        decodedGrid->keyRuns.emplace_back(x + 1, keyId);
+                    }
+                    x++;
+                }
             }
+            catch (const std::exception& ex) {
+                Log::Warnf("UTFGridTile::getDecodedGrid: Invalid UTF8 in grid: %s", ex.what());
+            }
+            cols = std::max(cols, x);
         }
-        return std::make_shared<UTFGridTile>(keys, data, keyIds, cols, rows);
+        decodedGrid->rowOffsets.push_back(decodedGrid->keyRuns.size());
+        decodedGrid->keyRuns.shrink_to_fit();
+
+        decodedGrid->xSize = cols;
+        decodedGrid->ySize = static_cast<int>(gridIt->value.Size());
+        _decodedGrid = decodedGrid;
+        return _decodedGrid;
     }
 
 }
@@ -10,46 +10,38 @@
 #include "core/Variant.h"
 
 #include <memory>
-#include <map>
-#include <vector>
+#include <mutex>
 #include <string>
 
 namespace carto {
     class BinaryData;
-        
+
+    /**
+     * UTF grid tile. The tile keeps the original JSON data and decodes it when first queried,
+     * so that tiles that are never clicked cost only the raw data.
+     */
     class UTFGridTile {
     public:
-        UTFGridTile(const std::vector<std::string>& keys, const std::map<std::string, Variant>& data, const std::vector<int>& keyIds, int xSize, int ySize) : _keys(keys), _data(data), _keyIds(keyIds), _xSize(xSize), _ySize(ySize) { }
-
-        std::string getKey(int keyId) const {
-            return keyId >= 0 && keyId <= static_cast<int>(_keys.size()) ? _keys[keyId] : std::string();
-        }
-        
-        Variant getData(const std::string& key) const {
-            auto it = _data.find(key);
-            return it != _data.end() ? it->second : Variant();
-        }
-
-        int getXSize() const {
-            return _xSize;
-        }
-        
-        int getYSize() const {
-            return _ySize;
-        }
-        
-        int getKeyId(int x, int y) const {
-            return x >= 0 && y >= 0 && x < getXSize() && y < getYSize() ? _keyIds[y * getXSize() + x] : 0;
-        }
+        explicit UTFGridTile(const std::shared_ptr<BinaryData>& tileData);
+        ~UTFGridTile();
+
+        std::string getKey(int keyId) const;
+        Variant getData(const std::string& key) const;
+
+        int getXSize() const;
+        int getYSize() const;
+        int getKeyId(int x, int y) const;
 
         static std::shared_ptr<UTFGridTile> DecodeUTFTile(const std::shared_ptr<BinaryData>& tileData);
 
     private:
-        std::vector<std::string> _keys;
-        std::map<std::string, Variant> _data;
-        std::vector<int> _keyIds;
-        int _xSize;
-        int _ySize;
+        struct DecodedGrid;
+
+        std::shared_ptr<DecodedGrid> getDecodedGrid() const;
+
+        mutable std::shared_ptr<BinaryData> _tileData; // released once decoded
+        mutable std::shared_ptr<DecodedGrid> _decodedGrid;
+        mutable std::mutex _mutex;
     };
     
 }
@@ -27,7 +27,7 @@
 namespace carto {
 
     HTTPClient::HTTPClient(bool log) :
-        _log(log), _impl(new CARTO_HTTP_SOCKET_IMPL(log))
+        _log(log), _ignoredRangeRestart(false), _impl(new CARTO_HTTP_SOCKET_IMPL(log))
     {
     }
 
@@ -35,6 +35,10 @@ namespace carto {
         _impl->setTimeout(milliseconds);
     }
 
+    void HTTPClient::setIgnoredRangeRestart(bool restart) {
+        _ignoredRangeRestart = restart;
+    }
+
     int HTTPClient::get(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData, int* statusCode) const {
         Request request("GET", url);
         request.headers.insert(requestHeaders.begin(), requestHeaders.end());
@@ -68,7 +72,7 @@ namespace carto {
         if (request.headers.count("Accept") == 0) {
             request.headers["Accept"] = "*/*";
         }
-        if (offset > 0) {
+        if (offset > 0 && request.headers.count("Range") == 0) {
             request.headers["Range"] = "bytes=" + boost::lexical_cast<std::string>(offset) + "-";
         }
 
@@ -129,6 +133,9 @@ namespace carto {
                     return false;
                 }
             }
+            else if (_ignoredRangeRestart && statusCode >= 200 && statusCode < 300) {
+                offset = 0; // range request was ignored, content starts from the beginning
+            }
 
             // Read Content-Length
             auto it = response.headers.find("Content-Length");
@@ -25,6 +25,7 @@ namespace carto {
         explicit HTTPClient(bool log);
 
         void setTimeout(int milliseconds);
+        void setIgnoredRangeRestart(bool restart);
 
         int get(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData, int* statusCode = 0) const;
         int get(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, HandlerFn handlerFn, std::uint64_t offset) const;
@@ -82,6 +83,7 @@ namespace carto {
         int makeRequest(Request request, Response& response, HandlerFn handlerFn, std::uint64_t offset) const;
 
         bool _log;
+        bool _ignoredRangeRestart; // if set, a full response to a range request is reported from offset 0
         std::unique_ptr<Impl> _impl;
     };
 
@@ -3,6 +3,7 @@
 #include "PackageManager.h"
 #include "core/BinaryData.h"
 #include "components/Exceptions.h"
+#include "network/HTTPClient.h"
 #include "utils/Log.h"
 
 #include <cstdint>
@@ -10,11 +11,21 @@
 #include <utility>
 #include <algorithm>
 #include <limits>
+#include <chrono>
+#include <atomic>
+#include <regex>
 #include <time.h>
 
+#ifdef __linux__
+#include <sys/types.h>
+#include <sys/sendfile.h>
+#endif
+
 #include <stdext/utf8_filesystem.h>
 #include <stdext/zlib.h>
 
+#include <boost/lexical_cast.hpp>
+
 #include <sqlite3pp.h>
 #include <sqlite3ppext.h>
 
@@ -110,7 +121,7 @@ namespace carto {
 
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
-            if (!_stopped && _packageManagerThread) {
+            if (!_stopped && !_packageManagerThreads.empty()) {
                 return true;
             }
         }
@@ -119,7 +130,9 @@ namespace carto {
 
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         _stopped = false;
-        _packageManagerThread = std::make_shared<std::thread>(std::bind(&PackageManager::run, this));
+        while (static_cast<int>(_packageManagerThreads.size()) < _maxParallelDownloads) {
+            _packageManagerThreads.push_back(std::make_shared<std::thread>(std::bind(&PackageManager::run, this)));
+        }
         Log::Info("PackageManager: Package manager started");
         return true;
     }
@@ -129,7 +142,7 @@ namespace carto {
             return;
         }
 
-        std::shared_ptr<std::thread> packageManagerThread;
+        std::vector<std::shared_ptr<std::thread> > packageManagerThreads;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             if (!_stopped) {
@@ -137,14 +150,16 @@ namespace carto {
                 _taskQueueCondition.notify_all();
                 Log::Info("PackageManager: Stopping package manager");
             }
-            packageManagerThread = _packageManagerThread;
+            packageManagerThreads = _packageManagerThreads;
         }
 
-        if (packageManagerThread && wait) {
-            packageManagerThread->join();
+        if (!packageManagerThreads.empty() && wait) {
+            for (const std::shared_ptr<std::thread>& packageManagerThread : packageManagerThreads) {
+                packageManagerThread->join();
+            }
 
             std::lock_guard<std::recursive_mutex> lock(_mutex);
-            _packageManagerThread.reset();
+            _packageManagerThreads.clear();
             Log::Info("PackageManager: Package manager stopped");
         }
     }
@@ -265,6 +280,19 @@ namespace carto {
                     if (jsonPackageInfo.HasMember("tile_mask")) {
                         tileMask = std::make_shared<PackageTileMask>(jsonPackageInfo["tile_mask"].GetString());
                     }
+                    if (jsonPackageInfo.HasMember("deltas")) {
+                        std::vector<PackageDelta>& deltas = _serverPackageDeltaCache[std::make_pair(packageId, jsonPackageInfo["version"].GetInt())];
+                        for (rapidjson::Value::ValueIterator jit2 = jsonPackageInfo["deltas"].Begin(); jit2 != jsonPackageInfo["deltas"].End(); jit2++) {
+                            rapidjson::Value& jsonPackageDelta = *jit2;
+                            PackageDelta delta;
+                            delta.baseVersion = jsonPackageDelta["base_version"].GetInt();
+                            delta.url = jsonPackageDelta["url"].GetString();
+                            if (jsonPackageDelta.HasMember("size")) {
+                                delta.size = jsonPackageDelta["size"].GetInt64();
+                            }
+                            deltas.push_back(delta);
+                        }
+                    }
                     auto packageInfo = std::make_shared<PackageInfo>(
                         packageId,
                         packageType,
@@ -285,6 +313,21 @@ namespace carto {
         return std::vector<std::shared_ptr<PackageInfo> >();
     }
 
+    std::shared_ptr<PackageManager::PackageDelta> PackageManager::getServerPackageDelta(const std::string& packageId, int version, int baseVersion) const {
+        getServerPackages(); // make sure the package list is parsed
+
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        auto it = _serverPackageDeltaCache.find(std::make_pair(packageId, version));
+        if (it != _serverPackageDeltaCache.end()) {
+            for (const PackageDelta& delta : it->second) {
+                if (delta.baseVersion == baseVersion) {
+                    return std::make_shared<PackageDelta>(delta);
+                }
+            }
+        }
+        return std::shared_ptr<PackageDelta>();
+    }
+
     std::vector<std::shared_ptr<PackageInfo> > PackageManager::getLocalPackages() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         return _localPackages;
@@ -544,6 +587,32 @@ namespace carto {
         }
     }
 
+    int PackageManager::getMaxParallelDownloads() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _maxParallelDownloads;
+    }
+
+    void PackageManager::setMaxParallelDownloads(int count) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _maxParallelDownloads = std::max(1, count);
+        if (!_stopped) {
+            while (static_cast<int>(_packageManagerThreads.size()) < _maxParallelDownloads) {
+                _packageManagerThreads.push_back(std::make_shared<std::thread>(std::bind(&PackageManager::run, this)));
+            }
+        }
+        _taskQueueCondition.notify_all();
+    }
+
+    int PackageManager::getDownloadConnectionCount() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _downloadConnectionCount;
+    }
+
+    void PackageManager::setDownloadConnectionCount(int count) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _downloadConnectionCount = std::max(1, count);
+    }
+
     void PackageManager::run() {
         try {
             while (true) {
@@ -553,11 +622,28 @@ namespace carto {
                     if (_stopped) {
                         break;
                     }
-                    taskId = _taskQueue->getActiveTaskId();
+                    if (static_cast<int>(_packageManagerThreads.size()) > _maxParallelDownloads) {
+                        // The limit was lowered, let this worker exit. No other thread will join it, so detach it
+                        auto it = std::find_if(_packageManagerThreads.begin(), _packageManagerThreads.end(), [](const std::shared_ptr<std::thread>& thread) {
+                            return thread->get_id() == std::this_thread::get_id();
+                        });
+                        if (it != _packageManagerThreads.end()) {
+                            (*it)->detach();
+                            _packageManagerThreads.erase(it);
+                            break;
+                        }
+                    }
+                    for (int activeTaskId : _taskQueue->getActiveTaskIds(_runningTaskIds, _maxParallelDownloads)) {
+                        if (_runningTaskIds.find(activeTaskId) == _runningTaskIds.end()) {
+                            taskId = activeTaskId;
+                            break;
+                        }
+                    }
                     if (taskId == -1) {
                         _taskQueueCondition.wait(lock);
                         continue;
                     }
+                    _runningTaskIds.insert(taskId);
                 }
                 try {
                     Task::Command command = _taskQueue->getTask(taskId).command;
@@ -602,6 +688,12 @@ namespace carto {
                     setTaskFailed(taskId, PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM);
                     Log::Errorf("PackageManager: Exception while executing task: %s", ex.what());
                 }
+                {
+                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    _runningTaskIds.erase(taskId);
+                    _prevTaskStatuses.erase(taskId);
+                }
+                _taskQueueCondition.notify_all(); // other workers may be waiting for this task to finish
             }
         }
         catch (const std::exception& ex) {
@@ -692,52 +784,14 @@ namespace carto {
 
         std::string packageFileName = createLocalFilePath(createPackageFileName(task.packageId, task.packageType, task.packageVersion));
         try {
-            // Determine file size, copy file
-            std::uint64_t fileSize = 0;
-            {
-                FILE* fpSrcRaw = utf8_filesystem::fopen(task.packageLocation.c_str(), "rb");
-                if (!fpSrcRaw) {
-                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not open package file ") + task.packageLocation);
-                }
-                std::shared_ptr<FILE> fpSrc(fpSrcRaw, fclose);
-                utf8_filesystem::fseek64(fpSrc.get(), 0, SEEK_END);
-                fileSize = utf8_filesystem::ftell64(fpSrc.get());
-                utf8_filesystem::fseek64(fpSrc.get(), 0, SEEK_SET);
-                FILE* fpDestRaw = utf8_filesystem::fopen(packageFileName.c_str(), "wb");
-                if (!fpDestRaw) {
-                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not create file ") + packageFileName);
-                }
-                std::shared_ptr<FILE> fpDest(fpDestRaw, fclose);
-                unsigned char buf[4096];
-                std::uint64_t fileOffset = 0;
-                while (!feof(fpSrc.get())) {
-                    if (isTaskCancelled(taskId)) {
-                        throw CancelException();
-                    }
-                    if (isTaskPaused(taskId)) {
-                        throw PauseException();
-                    }
-
-                    std::size_t n = fread(buf, sizeof(unsigned char), sizeof(buf) / sizeof(unsigned char), fpSrc.get());
-                    if (fwrite(buf, sizeof(unsigned char), n, fpDest.get()) != n) {
-                        throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not write to file ") + packageFileName);
-                    }
-                    fileOffset += n;
-                    updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_COPYING, static_cast<float>(fileOffset) / static_cast<float>(fileSize));
-                }
-            }
+            // Copy file
+            std::uint64_t fileSize = copyPackageFile(taskId, task.packageLocation, packageFileName);
 
             // Find package tiles and calculate tile mask
             std::shared_ptr<PackageTileMask> tileMask;
             if (task.packageType == PackageType::PACKAGE_TYPE_MAP) {
                 sqlite3pp::database packageDb(packageFileName.c_str());
-                sqlite3pp::query query(packageDb, "SELECT zoom_level, tile_column, tile_row FROM tiles");
-                std::vector<PackageTileMask::Tile> tiles;
-                for (auto qit = query.begin(); qit != query.end(); qit++) {
-                    PackageTileMask::Tile tile(qit->get<int>(0), qit->get<int>(1), qit->get<int>(2));
-                    tiles.push_back(tile);
-                }
-                tileMask = std::make_shared<PackageTileMask>(tiles);
+                tileMask = CalculateDbTileMask(packageDb);
             }
 
             // Get package id
@@ -774,6 +828,80 @@ namespace carto {
         return true;
     }
 
+    std::uint64_t PackageManager::copyPackageFile(int taskId, const std::string& srcFileName, const std::string& destFileName) {
+        FILE* fpSrcRaw = utf8_filesystem::fopen(srcFileName.c_str(), "rb");
+        if (!fpSrcRaw) {
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not open package file ") + srcFileName);
+        }
+        std::shared_ptr<FILE> fpSrc(fpSrcRaw, fclose);
+        utf8_filesystem::fseek64(fpSrc.get(), 0, SEEK_END);
+        std::uint64_t fileSize = utf8_filesystem::ftell64(fpSrc.get());
+        utf8_filesystem::fseek64(fpSrc.get(), 0, SEEK_SET);
+        FILE* fpDestRaw = utf8_filesystem::fopen(destFileName.c_str(), "wb");
+        if (!fpDestRaw) {
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not create file ") + destFileName);
+        }
+        std::shared_ptr<FILE> fpDest(fpDestRaw, fclose);
+
+        // Task state checks and status updates hit the task database, so do these only periodically
+        std::uint64_t fileOffset = 0;
+        auto lastUpdateTime = std::chrono::steady_clock::now();
+        auto updateStatus = [this, taskId, &fileOffset, fileSize, &lastUpdateTime](bool force) {
+            auto currentTime = std::chrono::steady_clock::now();
+            if (!force && currentTime - lastUpdateTime < STATUS_UPDATE_INTERVAL) {
+                return;
+            }
+            lastUpdateTime = currentTime;
+            if (isTaskCancelled(taskId)) {
+                throw CancelException();
+            }
+            if (isTaskPaused(taskId)) {
+                throw PauseException();
+            }
+            updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_COPYING, fileSize > 0 ? static_cast<float>(fileOffset) / static_cast<float>(fileSize) : 1.0f);
+        };
+        updateStatus(true);
+
+#ifdef __linux__
+        // Try to copy the data inside the kernel first, if this fails fall back to buffered copy from the current offset
+        if (fileSize <= static_cast<std::uint64_t>(std::numeric_limits<off_t>::max())) {
+            while (fileOffset < fileSize) {
+                off_t offset = static_cast<off_t>(fileOffset);
+                std::size_t count = static_cast<std::size_t>(std::min(fileSize - fileOffset, static_cast<std::uint64_t>(COPY_KERNEL_CHUNK_SIZE)));
+                ssize_t n = sendfile(fileno(fpDest.get()), fileno(fpSrc.get()), &offset, count);
+                if (n <= 0) {
+                    break;
+                }
+                fileOffset += static_cast<std::uint64_t>(n);
+                updateStatus(false);
+            }
+            utf8_filesystem::fseek64(fpSrc.get(), fileOffset, SEEK_SET);
+            utf8_filesystem::fseek64(fpDest.get(), fileOffset, SEEK_SET);
+        }
+#endif
+
+        std::vector<unsigned char> buf(COPY_BUFFER_SIZE);
+        while (fileOffset < fileSize) {
+            std::size_t n = fread(buf.data(), sizeof(unsigned char), buf.size(), fpSrc.get());
+            if (n == 0) {
+                break;
+            }
+            if (fwrite(buf.data(), sizeof(unsigned char), n, fpDest.get()) != n) {
+                throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not write to file ") + destFileName);
+            }
+            fileOffset += n;
+            updateStatus(false);
+        }
+        if (fileOffset != fileSize) {
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not read package file ") + srcFileName);
+        }
+        if (fflush(fpDest.get()) != 0) {
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not write to file ") + destFileName);
+        }
+        updateStatus(true);
+        return fileSize;
+    }
+
     bool PackageManager::downloadPackage(int taskId) {
         Task task = _taskQueue->getTask(taskId);
 
@@ -795,6 +923,7 @@ namespace carto {
 
         // Check if the package is already downloaded
         bool downloaded = false;
+        int downloadedVersion = -1;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             sqlite3pp::query query(*_localDb, "SELECT version FROM packages WHERE package_id=:package_id AND valid=1");
@@ -805,6 +934,28 @@ namespace carto {
                     return true;
                 }
                 downloaded = true;
+                downloadedVersion = qit->get<int>(0);
+            }
+        }
+
+        // Try to update the existing package using a delta instead of downloading the full package
+        if (downloaded && package->getPackageType() == PackageType::PACKAGE_TYPE_MAP) {
+            if (std::shared_ptr<PackageDelta> delta = getServerPackageDelta(task.packageId, task.packageVersion, downloadedVersion)) {
+                try {
+                    if (updatePackageFromDelta(taskId, package, downloadedVersion, *delta)) {
+                        Log::Infof("PackageManager: Package %s updated from version %d", task.packageId.c_str(), downloadedVersion);
+                        return true;
+                    }
+                }
+                catch (const PauseException&) {
+                    throw;
+                }
+                catch (const CancelException&) {
+                    throw;
+                }
+                catch (const std::exception& ex) {
+                    Log::Errorf("PackageManager: Failed to apply delta to package %s, downloading full package: %s", task.packageId.c_str(), ex.what());
+                }
             }
         }
 
@@ -812,8 +963,23 @@ namespace carto {
         bool packageSizeIndeterminate = package->getSize() == 0;
         std::string packageFileName = createLocalFilePath(createPackageFileName(task.packageId, task.packageType, task.packageVersion));
         try {
+            // Try to download the package in chunks using parallel connections. If the server does not support this, use a single connection
+            bool chunksDownloaded = false;
+            if (!packageSizeIndeterminate && getDownloadConnectionCount() > 1) {
+                std::string packageURL = createPackageURL(task.packageId, task.packageVersion, task.packageLocation, downloaded);
+                if (packageURL.empty()) {
+                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_NO_OFFLINE_PLAN, "Offline packages not available");
+                }
+                chunksDownloaded = downloadPackageChunks(taskId, task.packageId, packageURL, packageFileName, package->getSize());
+            }
+            if (!chunksDownloaded && !_taskQueue->getTaskChunks(taskId).empty()) {
+                // The file was preallocated for chunked download, it can not be resumed using a single connection
+                utf8_filesystem::unlink(packageFileName.c_str());
+                _taskQueue->deleteTaskChunks(taskId);
+            }
+
             // Try to download the package
-            for (int retry = 0; true; retry++) {
+            for (int retry = 0; !chunksDownloaded; retry++) {
                 if (retry > 0) {
                     utf8_filesystem::unlink(packageFileName.c_str());
                     Log::Infof("PackageManager: Retrying package %s download", task.packageId.c_str());
@@ -879,18 +1045,7 @@ namespace carto {
                     throw PauseException();
                 }
                 if (retry > 0) {
-                    switch (errorCode) {
-                    case 402: // Payment required
-                        throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_DOWNLOAD_LIMIT_EXCEEDED, "Subscription limit exceeded while downloading: " + task.packageId);
-                    case 403: // Forbidden
-                        throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_NO_OFFLINE_PLAN, "Offline packages not available");
-                        break;
-                    case 406: // Not acceptable
-                        throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_PACKAGE_TOO_BIG, "Package contains too many tiles: " + task.packageId);
-                        break;
-                    default:
-                        throw PackageException(errorCode < 0 ? PackageErrorType::PACKAGE_ERROR_TYPE_CONNECTION : PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, "Failed to download package " + task.packageId);
-                    }
+                    ThrowDownloadException(errorCode, task.packageId);
                 }
             }
 
@@ -915,13 +1070,7 @@ namespace carto {
                     }
                     else if (package->getPackageType() == PackageType::PACKAGE_TYPE_MAP) {
                         sqlite3pp::database packageDb(packageFileName.c_str());
-                        sqlite3pp::query query2(packageDb, "SELECT zoom_level, tile_column, tile_row FROM tiles");
-                        std::vector<PackageTileMask::Tile> tiles;
-                        for (auto qit2 = query2.begin(); qit2 != query2.end(); qit2++) {
-                            PackageTileMask::Tile tile(qit2->get<int>(0), qit2->get<int>(1), qit2->get<int>(2));
-                            tiles.push_back(tile);
-                        }
-                        tileMask = PackageTileMask(tiles).getStringValue();
+                        tileMask = CalculateDbTileMask(packageDb)->getStringValue();
                     }
                     std::uint64_t fileSize = package->getSize();
                     if (packageSizeIndeterminate) {
@@ -964,6 +1113,356 @@ namespace carto {
         return true;
     }
 
+    bool PackageManager::downloadPackageChunks(int taskId, const std::string& packageId, const std::string& packageURL, const std::string& packageFileName, std::uint64_t fileSize) {
+        // Check that the server supports range requests and reports matching package size
+        std::map<std::string, std::string> responseHeaders;
+        int errorCode = DownloadFileRange(packageURL, [](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
+            return offset == 0;
+        }, 0, 1, responseHeaders);
+        bool rangeSupported = false;
+        auto it = responseHeaders.find("Content-Range");
+        if (errorCode == 0 && it != responseHeaders.end()) {
+            std::smatch what;
+            if (std::regex_match(it->second, what, std::regex("bytes 0-0/([0-9]+)"))) {
+                rangeSupported = boost::lexical_cast<std::uint64_t>(what[1].str()) == fileSize;
+            }
+        }
+        if (!rangeSupported) {
+            Log::Infof("PackageManager: Range requests not supported for package %s, using single connection", packageId.c_str());
+            return false;
+        }
+
+        std::uint64_t chunkSize = DOWNLOAD_CHUNK_SIZE;
+        int chunkCount = static_cast<int>((fileSize + chunkSize - 1) / chunkSize);
+
+        // Reuse the chunks downloaded earlier if their local contents still match the hashes recorded when they were written, otherwise create a new file of the full package size
+        std::map<int, std::string> chunkHashes = _taskQueue->getTaskChunks(taskId);
+        std::vector<bool> chunksValid(chunkCount, false);
+        std::uint64_t validSize = 0;
+        if (!chunkHashes.empty()) {
+            FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "rb");
+            if (fpRaw) {
+                std::shared_ptr<FILE> fp(fpRaw, fclose);
+                std::vector<unsigned char> chunkData;
+                for (auto chunkIt = chunkHashes.begin(); chunkIt != chunkHashes.end(); chunkIt++) {
+                    if (chunkIt->first < 0 || chunkIt->first >= chunkCount) {
+                        continue;
+                    }
+                    std::uint64_t chunkOffset = chunkIt->first * chunkSize;
+                    chunkData.resize(static_cast<std::size_t>(std::min(chunkSize, fileSize - chunkOffset)));
+                    utf8_filesystem::fseek64(fp.get(), chunkOffset, SEEK_SET);
+                    if (fread(chunkData.data(), sizeof(unsigned char), chunkData.size(), fp.get()) == chunkData.size() && CalculateDataHash(chunkData.data(), chunkData.size()) == chunkIt->second) {
+                        chunksValid[chunkIt->first] = true;
+                        validSize += chunkData.size();
+                    }
+                }
+            }
+        }
+        if (validSize == 0) {
+            _taskQueue->deleteTaskChunks(taskId);
+            FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "wb");
+            if (!fpRaw) {
+                throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not create download package file ") + packageFileName);
+            }
+            std::shared_ptr<FILE> fp(fpRaw, fclose);
+            utf8_filesystem::ftruncate64(fp.get(), fileSize);
+        }
+        std::vector<int> pendingChunks;
+        for (int i = 0; i < chunkCount; i++) {
+            if (!chunksValid[i]) {
+                pendingChunks.push_back(i);
+            }
+        }
+
+        // Download the missing chunks using parallel connections. Each chunk is stored and recorded in the task database once it is complete.
+        std::atomic<std::size_t> nextChunk(0);
+        std::atomic<std::uint64_t> downloadedSize(validSize);
+        std::atomic<bool> stopped(false);
+        std::atomic<bool> writeFailed(false);
+        std::atomic<int> failedErrorCode(0);
+        auto worker = [&, this]() {
+            try {
+                FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "r+b");
+                if (!fpRaw) {
+                    writeFailed = true;
+                    stopped = true;
+                    return;
+                }
+                std::shared_ptr<FILE> fp(fpRaw, fclose);
+                auto lastUpdateTime = std::chrono::steady_clock::now();
+                std::vector<unsigned char> chunkData;
+                while (!stopped) {
+                    std::size_t i = nextChunk++;
+                    if (i >= pendingChunks.size()) {
+                        break;
+                    }
+                    std::uint64_t chunkOffset = pendingChunks[i] * chunkSize;
+                    std::uint64_t chunkLength = std::min(chunkSize, fileSize - chunkOffset);
+
+                    int chunkErrorCode = -1;
+                    for (int retry = 0; retry < 2 && !stopped; retry++) {
+                        chunkData.clear();
+                        std::map<std::string, std::string> chunkResponseHeaders;
+                        chunkErrorCode = DownloadFileRange(packageURL, [&, this](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
+                            if (stopped) {
+                                return false;
+                            }
+                            auto currentTime = std::chrono::steady_clock::now();
+                            if (currentTime - lastUpdateTime >= STATUS_UPDATE_INTERVAL) {
+                                lastUpdateTime = currentTime;
+                                if (isTaskCancelled(taskId) || isTaskPaused(taskId)) {
+                                    stopped = true;
+                                    return false;
+                                }
+                                updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(downloadedSize.load()) / static_cast<float>(fileSize));
+                            }
+                            if (offset != chunkOffset + chunkData.size() || chunkData.size() + size > chunkLength) {
+                                return false; // range was ignored by the server
+                            }
+                            chunkData.insert(chunkData.end(), buf, buf + size);
+                            downloadedSize += size;
+                            return true;
+                        }, chunkOffset, chunkLength, chunkResponseHeaders);
+                        if (chunkErrorCode == 0 && chunkData.size() == chunkLength) {
+                            break;
+                        }
+                        downloadedSize -= chunkData.size();
+                        if (chunkErrorCode == 0) {
+                            Log::Errorf("PackageManager: Chunk size mismatch for package %s (expected %lld, actual %lld)", packageId.c_str(), static_cast<long long>(chunkLength), static_cast<long long>(chunkData.size()));
+                            chunkErrorCode = -1;
+                        }
+                    }
+                    if (chunkErrorCode != 0) {
+                        failedErrorCode = chunkErrorCode;
+                        stopped = true;
+                        break;
+                    }
+
+                    utf8_filesystem::fseek64(fp.get(), chunkOffset, SEEK_SET);
+                    if (fwrite(chunkData.data(), sizeof(unsigned char), chunkData.size(), fp.get()) != chunkData.size() || fflush(fp.get()) != 0) {
+                        Log::Errorf("PackageManager: Storage full? Could not write to package file %s", packageFileName.c_str());
+                        writeFailed = true;
+                        stopped = true;
+                        break;
+                    }
+                    _taskQueue->addTaskChunk(taskId, pendingChunks[i], CalculateDataHash(chunkData.data(), chunkData.size()));
+                }
+            }
+            catch (const std::exception& ex) {
+                Log::Errorf("PackageManager: Exception while downloading package chunk: %s", ex.what());
+                failedErrorCode = -1;
+                stopped = true;
+            }
+        };
+
+        std::vector<std::thread> threads;
+        int connectionCount = static_cast<int>(std::min(static_cast<std::size_t>(getDownloadConnectionCount()), pendingChunks.size()));
+        for (int i = 1; i < connectionCount; i++) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        if (isTaskCancelled(taskId)) {
+            throw CancelException();
+        }
+        if (isTaskPaused(taskId)) {
+            throw PauseException();
+        }
+        if (writeFailed) {
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not write to package file ") + packageFileName);
+        }
+        if (failedErrorCode != 0) {
+            ThrowDownloadException(failedErrorCode, packageId);
+        }
+
+        _taskQueue->deleteTaskChunks(taskId);
+        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, 1.0f);
+        return true;
+    }
+
+    bool PackageManager::updatePackageFromDelta(int taskId, const std::shared_ptr<PackageInfo>& package, int baseVersion, const PackageDelta& delta) {
+        // Find the local package to update
+        int id = -1;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            sqlite3pp::query query(*_localDb, "SELECT id FROM packages WHERE package_id=:package_id AND version=:version AND valid=1");
+            query.bind(":package_id", package->getPackageId().c_str());
+            query.bind(":version", baseVersion);
+            for (auto qit = query.begin(); qit != query.end(); qit++) {
+                id = qit->get<int>(0);
+            }
+        }
+        if (id == -1) {
+            return false;
+        }
+
+        std::string baseFileName = createLocalFilePath(createPackageFileName(package->getPackageId(), package->getPackageType(), baseVersion));
+        std::string packageFileName = createLocalFilePath(createPackageFileName(package->getPackageId(), package->getPackageType(), package->getVersion()));
+        std::string deltaFileName = packageFileName + "_delta";
+        std::string deltaURL = createPackageURL(package->getPackageId(), package->getVersion(), delta.url, true);
+        if (deltaURL.empty()) {
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_NO_OFFLINE_PLAN, "Offline packages not available");
+        }
+        try {
+            // Download the delta
+            {
+                FILE* fpRaw = utf8_filesystem::fopen(deltaFileName.c_str(), "wb");
+                if (!fpRaw) {
+                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not create delta file ") + deltaFileName);
+                }
+                std::shared_ptr<FILE> fp(fpRaw, fclose);
+                std::uint64_t fileSize = delta.size;
+                bool writeFailed = false;
+                int errorCode = DownloadFile(deltaURL, [this, fp, taskId, fileSize, &writeFailed](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
+                    if (isTaskCancelled(taskId)) {
+                        return false;
+                    }
+                    if (isTaskPaused(taskId)) {
+                        return false;
+                    }
+
+                    utf8_filesystem::fseek64(fp.get(), offset, SEEK_SET);
+                    if (fwrite(buf, sizeof(unsigned char), size, fp.get()) != size) {
+                        writeFailed = true;
+                        return false;
+                    }
+                    std::uint64_t realSize = fileSize;
+                    if (fileSize == 0 && length != std::numeric_limits<std::uint64_t>::max()) {
+                        realSize = length;
+                    }
+                    if (realSize > 0) {
+                        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(offset + size) / static_cast<float>(realSize));
+                    }
+                    return true;
+                });
+                if (isTaskCancelled(taskId)) {
+                    throw CancelException();
+                }
+                if (isTaskPaused(taskId)) {
+                    throw PauseException();
+                }
+                if (writeFailed) {
+                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not write to delta file ") + deltaFileName);
+                }
+                if (errorCode != 0) {
+                    ThrowDownloadException(errorCode, package->getPackageId());
+                }
+            }
+
+            // Apply the delta to a copy of the local package, so that the package stays consistent with its record if the update fails.
+            // Tiles with empty data are removed, other tiles are added or replaced.
+            copyPackageFile(taskId, baseFileName, packageFileName);
+            std::shared_ptr<PackageTileMask> tileMask = package->getTileMask();
+            {
+                sqlite3pp::database deltaDb(deltaFileName.c_str());
+                sqlite3pp::query metaQuery(deltaDb, "SELECT name, value FROM metadata WHERE name IN ('base_version', 'version')");
+                int deltaBaseVersion = -1, deltaVersion = -1;
+                for (auto qit = metaQuery.begin(); qit != metaQuery.end(); qit++) {
+                    int value = boost::lexical_cast<int>(qit->get<const char*>(1));
+                    if (std::string(qit->get<const char*>(0)) == "base_version") {
+                        deltaBaseVersion = value;
+                    }
+                    else {
+                        deltaVersion = value;
+                    }
+                }
+                if (deltaBaseVersion != baseVersion || deltaVersion != package->getVersion()) {
+                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, "Delta version mismatch for package " + package->getPackageId());
+                }
+
+                sqlite3pp::database packageDb(packageFileName.c_str());
+                sqlite3pp::transaction xct(packageDb);
+                {
+                    sqlite3pp::command deleteCommand(packageDb, "DELETE FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
+                    sqlite3pp::command insertCommand(packageDb, "INSERT INTO tiles(zoom_level, tile_column, tile_row, tile_data) VALUES(:zoom, :x, :y, :data)");
+                    sqlite3pp::query deltaQuery(deltaDb, "SELECT zoom_level, tile_column, tile_row, tile_data, tile_hash FROM delta_tiles");
+                    auto lastUpdateTime = std::chrono::steady_clock::now();
+                    for (auto qit = deltaQuery.begin(); qit != deltaQuery.end(); qit++) {
+                        auto currentTime = std::chrono::steady_clock::now();
+                        if (currentTime - lastUpdateTime >= STATUS_UPDATE_INTERVAL) {
+                            lastUpdateTime = currentTime;
+                            if (isTaskCancelled(taskId)) {
+                                throw CancelException();
+                            }
+                            if (isTaskPaused(taskId)) {
+                                throw PauseException();
+                            }
+                        }
+
+                        int zoom = qit->get<int>(0), x = qit->get<int>(1), y = qit->get<int>(2);
+                        deleteCommand.reset();
+                        deleteCommand.bind(":zoom", zoom);
+                        deleteCommand.bind(":x", x);
+                        deleteCommand.bind(":y", y);
+                        deleteCommand.execute();
+
+                        const unsigned char* dataPtr = reinterpret_cast<const unsigned char*>(qit->get<const void*>(3));
+                        std::size_t dataSize = qit->column_bytes(3);
+                        if (!dataPtr || dataSize == 0) {
+                            continue;
+                        }
+                        const char* hash = qit->get<const char*>(4);
+                        if (!hash || CalculateDataHash(dataPtr, dataSize) != hash) {
+                            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, "Delta tile hash mismatch for package " + package->getPackageId());
+                        }
+                        insertCommand.reset();
+                        insertCommand.bind(":zoom", zoom);
+                        insertCommand.bind(":x", x);
+                        insertCommand.bind(":y", y);
+                        insertCommand.bind(":data", dataPtr, static_cast<unsigned int>(dataSize));
+                        insertCommand.execute();
+                    }
+                }
+                xct.commit();
+
+                if (!tileMask) {
+                    tileMask = CalculateDbTileMask(packageDb);
+                }
+            }
+
+            // Switch the package record to the patched copy first and remove the original package only after that.
+            // If anything fails before the record is updated, the original package remains valid.
+            std::string metaInfo;
+            if (package->getMetaInfo()) {
+                metaInfo = package->getMetaInfo()->getVariant().toString();
+            }
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                std::uint64_t fileSize = 0;
+                FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "rb");
+                if (fpRaw) {
+                    std::shared_ptr<FILE> fp(fpRaw, fclose);
+                    utf8_filesystem::fseek64(fp.get(), 0, SEEK_END);
+                    fileSize = utf8_filesystem::ftell64(fp.get());
+                }
+                sqlite3pp::command command(*_localDb, "UPDATE packages SET version=:version, size=:size, server_url=:server_url, tile_mask=:tile_mask, metainfo=:metainfo WHERE id=:id");
+                command.bind(":version", package->getVersion());
+                command.bind(":size", fileSize);
+                command.bind(":server_url", package->getServerURL().c_str());
+                command.bind(":tile_mask", tileMask->getStringValue().c_str());
+                command.bind(":metainfo", metaInfo.c_str());
+                command.bind(":id", id);
+                command.execute();
+
+                _localPackageDatabaseCache.clear();
+            }
+        }
+        catch (...) {
+            utf8_filesystem::unlink(packageFileName.c_str());
+            utf8_filesystem::unlink(deltaFileName.c_str());
+            throw;
+        }
+        utf8_filesystem::unlink(deltaFileName.c_str());
+        utf8_filesystem::unlink(baseFileName.c_str());
+        syncLocalPackages();
+
+        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, 1.0f);
+        return true;
+    }
+
     bool PackageManager::removePackage(int taskId) {
         Task task = _taskQueue->getTask(taskId);
 
@@ -1197,21 +1696,21 @@ namespace carto {
         if (_stopped) {
             return true;
         }
-        return _taskQueue->getActiveTaskId(taskId) != taskId;
+        std::vector<int> activeTaskIds = _taskQueue->getActiveTaskIds(_runningTaskIds, _maxParallelDownloads);
+        return std::find(activeTaskIds.begin(), activeTaskIds.end(), taskId) == activeTaskIds.end();
     }
 
     void PackageManager::updateTaskStatus(int taskId, PackageAction::PackageAction action, float progress) {
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             int roundedProgress = std::min(100, std::max(0, static_cast<int>(progress * 100.0f)));
-            if (taskId == _prevTaskId && action == _prevAction && roundedProgress == _prevRoundedProgress) {
+            auto it = _prevTaskStatuses.find(taskId);
+            if (it != _prevTaskStatuses.end() && it->second.first == action && it->second.second == roundedProgress) {
                 return;
             }
 
             _taskQueue->updateTaskStatus(taskId, action, progress);
-            _prevTaskId = taskId;
-            _prevAction = action;
-            _prevRoundedProgress = roundedProgress;
+            _prevTaskStatuses[taskId] = std::make_pair(action, roundedProgress);
         }
 
         DirectorPtr<PackageManagerListener> packageManagerListener = _packageManagerListener;
@@ -1370,6 +1869,7 @@ namespace carto {
             throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not rename package list file ") + tempPackageListFileName);
         }
         _serverPackageCache.clear();
+        _serverPackageDeltaCache.clear();
     }
 
     void PackageManager::InitializeDb(sqlite3pp::database& db, const std::string& encKey) {
@@ -1422,6 +1922,19 @@ namespace carto {
         return true;
     }
 
+    std::shared_ptr<PackageTileMask> PackageManager::CalculateDbTileMask(sqlite3pp::database& db) {
+        sqlite3pp::query query(db, "SELECT zoom_level, tile_column, tile_row FROM tiles");
+        auto qit = query.begin();
+        return std::make_shared<PackageTileMask>([&query, &qit](PackageTileMask::Tile& tile) {
+            if (qit == query.end()) {
+                return false;
+            }
+            tile = PackageTileMask::Tile(qit->get<int>(0), qit->get<int>(1), qit->get<int>(2));
+            qit++;
+            return true;
+        });
+    }
+
     bool PackageManager::CheckDbEncryption(sqlite3pp::database& db, const std::string& encKey) {
         sqlite3pp::query query(db, "SELECT value FROM metadata WHERE name='nutikeysha1'");
         for (auto qit = query.begin(); qit != query.end(); qit++) {
@@ -1453,9 +1966,13 @@ namespace carto {
     }
     
     std::string PackageManager::CalculateKeyHash(const std::string& encKey) {
+        return CalculateDataHash(reinterpret_cast<const unsigned char*>(encKey.c_str()), encKey.size());
+    }
+
+    std::string PackageManager::CalculateDataHash(const unsigned char* data, std::size_t size) {
         CryptoPP::SHA1 hash;
         unsigned char digest[CryptoPP::SHA1::DIGESTSIZE];
-        hash.CalculateDigest(digest, reinterpret_cast<const unsigned char*>(encKey.c_str()), encKey.size());
+        hash.CalculateDigest(digest, data, size);
         std::string sha1;
         CryptoPP::HexEncoder encoder;
         encoder.Attach(new CryptoPP::StringSink(sha1));
@@ -1518,10 +2035,51 @@ namespace carto {
         Log::Debugf("PackageManager::DownloadFile: %s", url.c_str());
         std::map<std::string, std::string> requestHeaders;
         std::map<std::string, std::string> responseHeaders;
-        return NetworkUtils::GetHTTP(url, requestHeaders, responseHeaders, handler, offset, Log::IsShowDebug());
+        return GetHTTP(url, requestHeaders, responseHeaders, handler, offset);
+    }
+
+    int PackageManager::DownloadFileRange(const std::string& url, NetworkUtils::HandlerFn handler, std::uint64_t offset, std::uint64_t length, std::map<std::string, std::string>& responseHeaders) {
+        Log::Debugf("PackageManager::DownloadFileRange: %s (%lld-%lld)", url.c_str(), static_cast<long long>(offset), static_cast<long long>(offset + length - 1));
+        std::map<std::string, std::string> requestHeaders;
+        requestHeaders["Range"] = "bytes=" + boost::lexical_cast<std::string>(offset) + "-" + boost::lexical_cast<std::string>(offset + length - 1);
+        return GetHTTP(url, requestHeaders, responseHeaders, handler, offset);
+    }
+
+    int PackageManager::GetHTTP(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, NetworkUtils::HandlerFn handler, std::uint64_t offset) {
+        // If the server ignores the range, the data must be written from the start of the file, so let the client report the real offsets
+        HTTPClient client(Log::IsShowDebug());
+        client.setIgnoredRangeRestart(true);
+        try {
+            return client.get(url, requestHeaders, responseHeaders, handler, offset);
+        } catch (const std::exception& ex) {
+            Log::Errorf("PackageManager::GetHTTP: Exception: %s", ex.what());
+        }
+        return -1;
+    }
+
+    void PackageManager::ThrowDownloadException(int errorCode, const std::string& packageId) {
+        switch (errorCode) {
+        case 402: // Payment required
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_DOWNLOAD_LIMIT_EXCEEDED, "Subscription limit exceeded while downloading: " + packageId);
+        case 403: // Forbidden
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_NO_OFFLINE_PLAN, "Offline packages not available");
+        case 406: // Not acceptable
+            throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_PACKAGE_TOO_BIG, "Package contains too many tiles: " + packageId);
+        default:
+            throw PackageException(errorCode < 0 ? PackageErrorType::PACKAGE_ERROR_TYPE_CONNECTION : PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, "Failed to download package " + packageId);
+        }
     }
 
-    PackageManager::PersistentTaskQueue::PersistentTaskQueue(const std::string& dbFileName) {
+    const std::chrono::milliseconds PackageManager::STATUS_UPDATE_INTERVAL = std::chrono::milliseconds(100);
+
+    PackageManager::PersistentTaskQueue::PersistentTaskQueue(const std::string& dbFileName) :
+        _localDb(),
+        _activeTaskIdsCache(),
+        _activeTaskIdsCacheRunningTaskIds(),
+        _activeTaskIdsCacheMaxCount(0),
+        _activeTaskIdsCacheValid(false),
+        _mutex()
+    {
         _localDb = std::make_shared<sqlite3pp::database>(dbFileName.c_str());
         _localDb->execute("PRAGMA encoding='UTF-8'");
 
@@ -1539,28 +2097,70 @@ namespace carto {
                 ))SQL");
         AddDbField(*_localDb, "manager_tasks", "package_type", "INTEGER DEFAULT 0");
         _localDb->execute("CREATE INDEX IF NOT EXISTS manager_tasks_package_id ON manager_tasks(package_id)");
+
+        _localDb->execute(R"SQL(
+                CREATE TABLE IF NOT EXISTS manager_task_chunks (
+                    task_id INTEGER NOT NULL,
+                    chunk_index INTEGER NOT NULL,
+                    hash TEXT NOT NULL,
+                    PRIMARY KEY (task_id, chunk_index)
+                ))SQL");
     }
 
-    int PackageManager::PersistentTaskQueue::getActiveTaskId(int currentActiveTaskId) const {
-        // Find task with highest priority. Do not process paused tasks (priority < 0) unless they are cancelled. Cancelled tasks should be always processed.
+    std::vector<int> PackageManager::PersistentTaskQueue::getActiveTaskIds(const std::set<int>& runningTaskIds, int maxCount) const {
+        // Find tasks with highest priority. Do not process paused tasks (priority < 0) unless they are cancelled. Cancelled tasks should be always processed.
+        // Running tasks are preferred to other tasks with the same priority.
+        struct ActiveTask {
+            int taskId;
+            int priority;
+            bool running;
+            std::string packageId;
+            bool packageTask;
+        };
+
         std::lock_guard<std::recursive_mutex> lock(_mutex);
-        sqlite3pp::query query(*_localDb, "SELECT id, package_id, (CASE WHEN id=:active_id THEN -1 ELSE id END) as ordering FROM manager_tasks WHERE priority>=0 OR cancelled=1 ORDER BY priority DESC, ordering ASC LIMIT 1");
-        query.bind(":active_id", currentActiveTaskId);
+        if (_activeTaskIdsCacheValid && _activeTaskIdsCacheMaxCount == maxCount && _activeTaskIdsCacheRunningTaskIds == runningTaskIds) {
+            return _activeTaskIdsCache;
+        }
+
+        std::vector<ActiveTask> activeTasks;
+        sqlite3pp::query query(*_localDb, "SELECT id, package_id, priority FROM manager_tasks WHERE priority>=0 OR cancelled=1 ORDER BY priority DESC, id ASC");
         for (auto qit = query.begin(); qit != query.end(); qit++) {
             int taskId = qit->get<int>(0);
             const char* packageId = qit->get<const char*>(1);
-            if (!packageId) {
-                return taskId;
+            activeTasks.push_back(ActiveTask { taskId, qit->get<int>(2), runningTaskIds.count(taskId) > 0, packageId ? std::string(packageId) : std::string(), packageId != nullptr });
+        }
+        std::stable_sort(activeTasks.begin(), activeTasks.end(), [](const ActiveTask& task1, const ActiveTask& task2) {
+            if (task1.priority != task2.priority) {
+                return task1.priority > task2.priority;
             }
+            return task1.running && !task2.running;
+        });
 
-            // This is a package task - package tasks have to be processed in-order, so take the first task with the same package (even if it is paused).
-            sqlite3pp::query query2(*_localDb, "SELECT id FROM manager_tasks WHERE package_id=:package_id ORDER BY id ASC LIMIT 1");
-            query2.bind(":package_id", packageId);
-            for (auto qit2 = query2.begin(); qit2 != query2.end(); qit2++) {
-                return qit2->get<int>(0);
+        std::vector<int> taskIds;
+        for (const ActiveTask& activeTask : activeTasks) {
+            if (static_cast<int>(taskIds.size()) >= maxCount) {
+                break;
+            }
+            int taskId = activeTask.taskId;
+            if (activeTask.packageTask) {
+                // This is a package task - package tasks have to be processed in-order, so take the first task with the same package (even if it is paused).
+                sqlite3pp::query query2(*_localDb, "SELECT id FROM manager_tasks WHERE package_id=:package_id ORDER BY id ASC LIMIT 1");
+                query2.bind(":package_id", activeTask.packageId.c_str());
+                for (auto qit2 = query2.begin(); qit2 != query2.end(); qit2++) {
+                    taskId = qit2->get<int>(0);
+                }
+            }
+            if (std::find(taskIds.begin(), taskIds.end(), taskId) == taskIds.end()) {
+                taskIds.push_back(taskId);
             }
         }
-        return -1;
+
+        _activeTaskIdsCache = taskIds;
+        _activeTaskIdsCacheRunningTaskIds = runningTaskIds;
+        _activeTaskIdsCacheMaxCount = maxCount;
+        _activeTaskIdsCacheValid = true;
+        return taskIds;
     }
 
     std::vector<int> PackageManager::PersistentTaskQueue::getTaskIds() const {
@@ -1603,6 +2203,7 @@ namespace carto {
         command.bind(":package_location", task.packageLocation.c_str());
         command.execute();
         int taskId = static_cast<int>(_localDb->last_insert_rowid());
+        _activeTaskIdsCacheValid = false;
         return taskId;
     }
 
@@ -1622,6 +2223,7 @@ namespace carto {
         sqlite3pp::command command(*_localDb, "UPDATE manager_tasks SET cancelled=1, priority=1000000 WHERE id=:task_id");
         command.bind(":task_id", taskId);
         command.execute();
+        _activeTaskIdsCacheValid = false;
     }
 
     void PackageManager::PersistentTaskQueue::setTaskPriority(int taskId, int priority) {
@@ -1630,6 +2232,7 @@ namespace carto {
         command.bind(":task_id", taskId);
         command.bind(":priority", priority);
         command.execute();
+        _activeTaskIdsCacheValid = false;
     }
 
     void PackageManager::PersistentTaskQueue::updateTaskStatus(int taskId, PackageAction::PackageAction action, float progress) {
@@ -1646,6 +2249,35 @@ namespace carto {
         sqlite3pp::command command(*_localDb, "DELETE FROM manager_tasks WHERE id=:task_id");
         command.bind(":task_id", taskId);
         command.execute();
+        _activeTaskIdsCacheValid = false;
+        deleteTaskChunks(taskId);
+    }
+
+    std::map<int, std::string> PackageManager::PersistentTaskQueue::getTaskChunks(int taskId) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        sqlite3pp::query query(*_localDb, "SELECT chunk_index, hash FROM manager_task_chunks WHERE task_id=:task_id");
+        query.bind(":task_id", taskId);
+        std::map<int, std::string> chunkHashes;
+        for (auto qit = query.begin(); qit != query.end(); qit++) {
+            chunkHashes[qit->get<int>(0)] = qit->get<const char*>(1);
+        }
+        return chunkHashes;
+    }
+
+    void PackageManager::PersistentTaskQueue::addTaskChunk(int taskId, int chunkIndex, const std::string& hash) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        sqlite3pp::command command(*_localDb, "INSERT OR REPLACE INTO manager_task_chunks(task_id, chunk_index, hash) VALUES(:task_id, :chunk_index, :hash)");
+        command.bind(":task_id", taskId);
+        command.bind(":chunk_index", chunkIndex);
+        command.bind(":hash", hash.c_str());
+        command.execute();
+    }
+
+    void PackageManager::PersistentTaskQueue::deleteTaskChunks(int taskId) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        sqlite3pp::command command(*_localDb, "DELETE FROM manager_task_chunks WHERE task_id=:task_id");
+        command.bind(":task_id", taskId);
+        command.execute();
     }
 
 }
@@ -21,6 +21,9 @@
 #include <string>
 #include <cstdint>
 #include <vector>
+#include <chrono>
+#include <map>
+#include <set>
 #include <memory>
 #include <mutex>
 #include <condition_variable>
@@ -203,6 +206,32 @@ namespace carto {
          * @param priority The priority of the download package. If it is less than zero, package download is paused.
          */
         void setPackagePriority(const std::string& packageId, int priority);
+
+        /**
+         * Returns the maximum number of packages that are processed (downloaded, imported or removed) in parallel.
+         * @return The maximum number of packages processed in parallel. The default is 1.
+         */
+        int getMaxParallelDownloads() const;
+        /**
+         * Sets the maximum number of packages that are processed (downloaded, imported or removed) in parallel.
+         * Tasks of the same package are always processed sequentially.
+         * If the limit is lowered, the surplus tasks are paused and resumed later.
+         * @param count The maximum number of packages processed in parallel. Must be at least 1.
+         */
+        void setMaxParallelDownloads(int count);
+
+        /**
+         * Returns the number of parallel connections used for downloading a single package.
+         * @return The number of parallel connections used for downloading a single package. The default is 1.
+         */
+        int getDownloadConnectionCount() const;
+        /**
+         * Sets the number of parallel connections used for downloading a single package.
+         * If the count is larger than 1 and the server supports range requests, packages are downloaded in chunks
+         * that can be resumed individually. Otherwise packages are downloaded using a single connection.
+         * @param count The number of parallel connections used for downloading a single package. Must be at least 1.
+         */
+        void setDownloadConnectionCount(int count);
         
     protected:
         virtual std::string createLocalFilePath(const std::string& name) const;
@@ -213,6 +242,11 @@ namespace carto {
         virtual std::shared_ptr<PackageInfo> getCustomPackage(const std::string& packageId, int version) const;
         
     private:
+        static const int COPY_BUFFER_SIZE = 1024 * 1024;
+        static const int COPY_KERNEL_CHUNK_SIZE = 16 * 1024 * 1024;
+        static const int DOWNLOAD_CHUNK_SIZE = 4 * 1024 * 1024;
+        static const std::chrono::milliseconds STATUS_UPDATE_INTERVAL;
+
         struct Task {
             enum Command {
                 NOP = 0,
@@ -232,6 +266,15 @@ namespace carto {
             std::string packageLocation;
         };
 
+        // Delta from an older package version, listed in the server package list under package "deltas" (base_version, url, size).
+        // Delta file is an SQLite database with 'base_version' and 'version' metadata entries and delta_tiles(zoom_level, tile_column, tile_row, tile_data, tile_hash) table.
+        // Tiles with empty data are removed, other tiles are added or replaced. Tile hash is SHA1 of the tile data as stored in the package.
+        struct PackageDelta {
+            int baseVersion = -1;
+            std::string url;
+            std::uint64_t size = 0;
+        };
+
         struct PackageDatabase {
             std::string packageId;
             std::shared_ptr<sqlite3pp::database> packageDb;
@@ -243,7 +286,7 @@ namespace carto {
         public:
             PersistentTaskQueue(const std::string& dbFileName);
 
-            int getActiveTaskId(int currentActiveTaskId = -1) const;
+            std::vector<int> getActiveTaskIds(const std::set<int>& runningTaskIds, int maxCount) const;
             std::vector<int> getTaskIds() const;
             Task getTask(int taskId) const;
 
@@ -254,8 +297,16 @@ namespace carto {
             void updateTaskStatus(int taskId, PackageAction::PackageAction action, float progress);
             void deleteTask(int taskId);
 
+            std::map<int, std::string> getTaskChunks(int taskId) const;
+            void addTaskChunk(int taskId, int chunkIndex, const std::string& hash);
+            void deleteTaskChunks(int taskId);
+
         private:
             std::shared_ptr<sqlite3pp::database> _localDb;
+            mutable std::vector<int> _activeTaskIdsCache; // result of the last getActiveTaskIds call, valid until the task table or the arguments change
+            mutable std::set<int> _activeTaskIdsCacheRunningTaskIds;
+            mutable int _activeTaskIdsCacheMaxCount;
+            mutable bool _activeTaskIdsCacheValid;
             mutable std::recursive_mutex _mutex;
         };
 
@@ -281,7 +332,12 @@ namespace carto {
         bool importPackage(int taskId);
         bool downloadPackage(int taskId);
         bool removePackage(int taskId);
+
+        std::uint64_t copyPackageFile(int taskId, const std::string& srcFileName, const std::string& destFileName);
+        bool updatePackageFromDelta(int taskId, const std::shared_ptr<PackageInfo>& package, int baseVersion, const PackageDelta& delta);
+        bool downloadPackageChunks(int taskId, const std::string& packageId, const std::string& packageURL, const std::string& packageFileName, std::uint64_t fileSize);
         
+        std::shared_ptr<PackageDelta> getServerPackageDelta(const std::string& packageId, int version, int baseVersion) const;
         PackageDatabase getLocalPackageDatabase(const std::shared_ptr<PackageInfo>& packageInfo) const;
         void syncLocalPackages();
         void importLocalPackage(int id, int taskId, const std::string& packageId, PackageType::PackageType packageType, const std::string& packageFileName);
@@ -302,14 +358,19 @@ namespace carto {
         static bool AddDbField(sqlite3pp::database& db, const std::string& table, const std::string& field, const std::string& def);
         static bool CheckDbEncryption(sqlite3pp::database& db, const std::string& encKey);
         static void UpdateDbEncryption(sqlite3pp::database& db, const std::string& encKey);
+        static std::shared_ptr<PackageTileMask> CalculateDbTileMask(sqlite3pp::database& db);
         
         static std::string CalculateKeyHash(const std::string& encKey);
+        static std::string CalculateDataHash(const unsigned char* data, std::size_t size);
 
         static void EncryptTile(std::vector<unsigned char>& data, int zoom, int x, int y, const std::string& encKey);
         static void DecryptTile(std::vector<unsigned char>& data, int zoom, int x, int y, const std::string& encKey);
         static void SetCipherKeyIV(unsigned char* k, unsigned char* iv, int zoom, int x, int y, const std::string& encKey);
 
         static int DownloadFile(const std::string& url, NetworkUtils::HandlerFn handler, std::uint64_t offset = 0);
+        static int DownloadFileRange(const std::string& url, NetworkUtils::HandlerFn handler, std::uint64_t offset, std::uint64_t length, std::map<std::string, std::string>& responseHeaders);
+        static int GetHTTP(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, NetworkUtils::HandlerFn handler, std::uint64_t offset);
+        static void ThrowDownloadException(int errorCode, const std::string& packageId);
 
         const std::string _packageListURL;
         const std::string _packageListFileName;
@@ -319,16 +380,18 @@ namespace carto {
         mutable std::vector<PackageDatabase> _localPackageDatabaseCache;
         mutable std::map<std::string, std::shared_ptr<std::ifstream> > _localPackageFileCache;
         mutable std::vector<std::shared_ptr<PackageInfo> > _serverPackageCache;
+        mutable std::map<std::pair<std::string, int>, std::vector<PackageDelta> > _serverPackageDeltaCache; // deltas keyed by package id and target version
         std::vector<std::shared_ptr<PackageInfo> > _localPackages;
         std::shared_ptr<sqlite3pp::database> _localDb;
         std::shared_ptr<PersistentTaskQueue> _taskQueue;
         std::condition_variable_any _taskQueueCondition; // notified when new tasks are available
-        std::shared_ptr<std::thread> _packageManagerThread;
+        std::vector<std::shared_ptr<std::thread> > _packageManagerThreads;
+        std::set<int> _runningTaskIds;
+        int _maxParallelDownloads = 1;
+        int _downloadConnectionCount = 1;
         std::vector<std::shared_ptr<OnChangeListener> > _onChangeListeners;
         bool _stopped = true;
-        int _prevTaskId = -1;
-        PackageAction::PackageAction _prevAction = PackageAction::PACKAGE_ACTION_WAITING;
-        int _prevRoundedProgress = 0;
+        std::map<int, std::pair<PackageAction::PackageAction, int> > _prevTaskStatuses; // last action and rounded progress of running tasks
 
         ThreadSafeDirectorPtr<PackageManagerListener> _packageManagerListener;
 
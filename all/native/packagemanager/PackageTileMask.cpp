@@ -63,20 +63,22 @@ namespace carto {
     }
 
     PackageTileMask::PackageTileMask(const std::vector<Tile>& tiles) {
-        std::unordered_set<Tile, TileHash, TileEq> tileSet(tiles.begin(), tiles.end());
-        _rootNode = buildTileNode(tileSet, Tile(0, 0, 0));
-        std::vector<bool> data = encodeTileNode(_rootNode);
-        while (data.size() % 24 != 0) {
-            data.push_back(false);
+        _rootNode = std::make_shared<TileNode>(Tile(0, 0, 0), false);
+        for (const Tile& tile : tiles) {
+            insertTileNode(_rootNode, tile);
         }
-        unsigned char val = 0;
-        for (std::size_t i = 0; i < data.size(); i++) {
-            val = (val << 1) | (data[i] ? 1 : 0);
-            if ((i + 1) % 6 == 0) {
-                _stringValue.push_back(base64EncodeTable[val]);
-                val = 0;
-            }
+        pruneTileNode(_rootNode);
+        _stringValue = encodeStringValue(_rootNode);
+    }
+
+    PackageTileMask::PackageTileMask(const std::function<bool(Tile&)>& tileReader) {
+        _rootNode = std::make_shared<TileNode>(Tile(0, 0, 0), false);
+        Tile tile(0, 0, 0);
+        while (tileReader(tile)) {
+            insertTileNode(_rootNode, tile);
         }
+        pruneTileNode(_rootNode);
+        _stringValue = encodeStringValue(_rootNode);
     }
 
     const std::string& PackageTileMask::getStringValue() const {
@@ -149,17 +151,39 @@ namespace carto {
         return node;
     }
 
-    std::shared_ptr<PackageTileMask::TileNode> PackageTileMask::buildTileNode(const std::unordered_set<Tile, TileHash, TileEq>& tileSet, const Tile& tile) {
-        auto node = std::make_shared<TileNode>(tile, tileSet.find(tile) != tileSet.end());
+    void PackageTileMask::insertTileNode(const std::shared_ptr<TileNode>& rootNode, const Tile& tile) {
+        if (tile.zoom < 0 || tile.zoom > MAX_ZOOM) {
+            return;
+        }
+
+        std::shared_ptr<TileNode> node = rootNode;
+        for (int zoom = 1; zoom <= tile.zoom; zoom++) {
+            int x = tile.x >> (tile.zoom - zoom);
+            int y = tile.y >> (tile.zoom - zoom);
+            std::shared_ptr<TileNode>& subNode = node->subNodes[(y & 1) * 2 + (x & 1)];
+            if (!subNode) {
+                subNode = std::make_shared<TileNode>(Tile(zoom, x, y), false);
+            }
+            node = subNode;
+        }
+        node->inside = true;
+    }
+
+    void PackageTileMask::pruneTileNode(const std::shared_ptr<TileNode>& node) {
         if (!node->inside) {
-            return node; // Note: we assume here that tile does not exist implies subtiles do not exist
+            // Note: we assume here that tile does not exist implies subtiles do not exist
+            node->subNodes[0] = node->subNodes[1] = node->subNodes[2] = node->subNodes[3] = std::shared_ptr<TileNode>();
+            return;
         }
 
         int idx = 0;
         bool deep = false;
         for (int dy = 0; dy < 2; dy++) {
             for (int dx = 0; dx < 2; dx++) {
-                node->subNodes[idx] = buildTileNode(tileSet, Tile(tile.zoom + 1, tile.x * 2 + dx, tile.y * 2 + dy));
+                if (!node->subNodes[idx]) {
+                    node->subNodes[idx] = std::make_shared<TileNode>(Tile(node->tile.zoom + 1, node->tile.x * 2 + dx, node->tile.y * 2 + dy), false);
+                }
+                pruneTileNode(node->subNodes[idx]);
                 for (int i = 0; i < 4; i++) {
                     deep = deep || node->subNodes[idx]->subNodes[i];
                 }
@@ -178,7 +202,6 @@ namespace carto {
                 node->subNodes[0] = node->subNodes[1] = node->subNodes[2] = node->subNodes[3] = std::shared_ptr<TileNode>();
             }
         }
-        return node;
     }
     
     int PackageTileMask::getMaxTileNodeZoom(const std::shared_ptr<TileNode>& node) {
@@ -213,6 +236,24 @@ namespace carto {
         return data;
     }
 
+    std::string PackageTileMask::encodeStringValue(const std::shared_ptr<TileNode>& rootNode) {
+        std::vector<bool> data = encodeTileNode(rootNode);
+        while (data.size() % 24 != 0) {
+            data.push_back(false);
+        }
+        std::string stringValue;
+        stringValue.reserve(data.size() / 6);
+        unsigned char val = 0;
+        for (std::size_t i = 0; i < data.size(); i++) {
+            val = (val << 1) | (data[i] ? 1 : 0);
+            if ((i + 1) % 6 == 0) {
+                stringValue.push_back(base64EncodeTable[val]);
+                val = 0;
+            }
+        }
+        return stringValue;
+    }
+
 }
 
 #endif
@@ -13,9 +13,9 @@
 
 #include <string>
 #include <memory>
+#include <functional>
 #include <queue>
 #include <vector>
-#include <unordered_set>
 
 namespace carto {
 
@@ -66,6 +66,12 @@ namespace carto {
          * @param tiles The list of tiles
          */
         explicit PackageTileMask(const std::vector<Tile>& tiles);
+        /**
+         * Constructs a new package tile mask instance from a stream of tiles.
+         * Tiles are inserted into the mask as they are read, the full tile list is never stored.
+         * @param tileReader The function that stores the next tile and returns true or returns false when there are no more tiles.
+         */
+        explicit PackageTileMask(const std::function<bool(Tile&)>& tileReader);
 
         /**
          * Returns the encoded tile mask value. This should not be displayed to the user.
@@ -101,24 +107,16 @@ namespace carto {
             TileNode(const Tile& tile, bool inside) : tile(tile), inside(inside) { }
         };
 
-        struct TileHash {
-            std::size_t operator() (const Tile& tile) const {
-                return tile.zoom + 24 * (tile.x ^ (tile.y << 16));
-            }
-        };
-
-        struct TileEq {
-            bool operator() (const Tile& tile1, const Tile& tile2) const {
-                return tile1.x == tile2.x && tile1.y == tile2.y && tile1.zoom == tile2.zoom;
-            }
-        };
+        static const int MAX_ZOOM = 30;
 
         std::shared_ptr<TileNode> findTileNode(const Tile& tile) const;
 
         static std::shared_ptr<TileNode> buildTileNode(std::queue<bool>& data, const Tile& tile);
-        static std::shared_ptr<TileNode> buildTileNode(const std::unordered_set<Tile, TileHash, TileEq>& tileSet, const Tile& tile);
+        static void insertTileNode(const std::shared_ptr<TileNode>& rootNode, const Tile& tile);
+        static void pruneTileNode(const std::shared_ptr<TileNode>& node);
         static int getMaxTileNodeZoom(const std::shared_ptr<TileNode>& node);
         static std::vector<bool> encodeTileNode(const std::shared_ptr<TileNode>& node);
+        static std::string encodeStringValue(const std::shared_ptr<TileNode>& rootNode);
 
         std::string _stringValue;
         std::shared_ptr<TileNode> _rootNode;
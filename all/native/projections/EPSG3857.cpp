@@ -1,8 +1,10 @@
 #include "EPSG3857.h"
+#include "core/MapVec.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
 
 #include <cmath>
+#include <algorithm>
 
 namespace carto {
 
@@ -39,6 +41,68 @@ namespace carto {
         return MapPos(num6, num7 * Const::RAD_TO_DEG, mapPos.getZ());
     }
     
+    void EPSG3857::fromInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        const MapVec& boundsDelta = _bounds.getDelta();
+        double offsetX = -_bounds.getMin().getX() - boundsDelta.getX() / 2;
+        double offsetY = -_bounds.getMin().getY() - boundsDelta.getY() / 2;
+        double scaleX = Const::WORLD_SIZE / boundsDelta.getX();
+        double scaleY = Const::WORLD_SIZE / boundsDelta.getY();
+        // Plain affine loops over separate arrays, suitable for compiler vectorization
+        for (std::size_t i = 0; i < count; i++) {
+            outXs[i] = xs[i] / scaleX - offsetX;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            outYs[i] = ys[i] / scaleY - offsetY;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            outZs[i] = zs[i] / METERS_TO_INTERNAL_EQUATOR;
+        }
+    }
+
+    void EPSG3857::toInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        const MapVec& boundsDelta = _bounds.getDelta();
+        double offsetX = -_bounds.getMin().getX() - boundsDelta.getX() / 2;
+        double offsetY = -_bounds.getMin().getY() - boundsDelta.getY() / 2;
+        double scaleX = Const::WORLD_SIZE / boundsDelta.getX();
+        double scaleY = Const::WORLD_SIZE / boundsDelta.getY();
+        for (std::size_t i = 0; i < count; i++) {
+            outXs[i] = (xs[i] + offsetX) * scaleX;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            outYs[i] = (ys[i] + offsetY) * scaleY;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            outZs[i] = zs[i] * METERS_TO_INTERNAL_EQUATOR;
+        }
+    }
+
+    void EPSG3857::fromWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        for (std::size_t i = 0; i < count; i++) {
+            outXs[i] = EARTH_RADIUS * (xs[i] * Const::DEG_TO_RAD);
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            double sinA = std::sin(ys[i] * Const::DEG_TO_RAD);
+            outYs[i] = HALF_EARTH_RADIUS * std::log((1 + sinA) / (1 - sinA));
+        }
+        if (outZs != zs) {
+            std::copy(zs, zs + count, outZs);
+        }
+    }
+
+    void EPSG3857::toWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        for (std::size_t i = 0; i < count; i++) {
+            double num4 = xs[i] / EARTH_RADIUS * Const::RAD_TO_DEG;
+            outXs[i] = num4 - std::floor((num4 + 180.0) / 360.0) * 360.0;
+        }
+        for (std::size_t i = 0; i < count; i++) {
+            double num7 = 90 * Const::DEG_TO_RAD - (2 * std::atan(std::exp(-ys[i] / EARTH_RADIUS)));
+            outYs[i] = num7 * Const::RAD_TO_DEG;
+        }
+        if (outZs != zs) {
+            std::copy(zs, zs + count, outZs);
+        }
+    }
+
     std::string EPSG3857::getName() const {
         return "EPSG:3857";
     }
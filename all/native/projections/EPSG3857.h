@@ -26,6 +26,13 @@ namespace carto {
         virtual MapPos fromWgs84(const MapPos& wgs84Pos) const;
         virtual MapPos toWgs84(const MapPos& mapPos) const;
         virtual std::string getName() const;
+
+#ifndef SWIG
+        virtual void fromInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+        virtual void toInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+        virtual void fromWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+        virtual void toWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+#endif
         
     private:
         enum { EARTH_RADIUS = 6378137 };
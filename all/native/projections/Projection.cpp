@@ -5,6 +5,7 @@
 #include "utils/Log.h"
 
 #include <cmath>
+#include <algorithm>
 
 namespace carto {
 
@@ -60,10 +61,84 @@ namespace carto {
         MapPos wgs84Pos = toWgs84(MapPos(x, y));
         return MapPos(wgs84Pos.getY(), wgs84Pos.getX());
     }
+
+    std::vector<MapPos> Projection::fromInternalPoses(const std::vector<MapPos>& poses) const {
+        return transformPoses(poses, &Projection::fromInternalBatch);
+    }
+
+    std::vector<MapPos> Projection::toInternalPoses(const std::vector<MapPos>& poses) const {
+        return transformPoses(poses, &Projection::toInternalBatch);
+    }
+
+    std::vector<MapPos> Projection::fromWgs84Poses(const std::vector<MapPos>& poses) const {
+        return transformPoses(poses, &Projection::fromWgs84Batch);
+    }
+
+    std::vector<MapPos> Projection::toWgs84Poses(const std::vector<MapPos>& poses) const {
+        return transformPoses(poses, &Projection::toWgs84Batch);
+    }
+
+    void Projection::fromInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        for (std::size_t i = 0; i < count; i++) {
+            MapPos pos = fromInternal(MapPos(xs[i], ys[i], zs[i]));
+            outXs[i] = pos.getX();
+            outYs[i] = pos.getY();
+            outZs[i] = pos.getZ();
+        }
+    }
+
+    void Projection::toInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        for (std::size_t i = 0; i < count; i++) {
+            MapPos pos = toInternal(MapPos(xs[i], ys[i], zs[i]));
+            outXs[i] = pos.getX();
+            outYs[i] = pos.getY();
+            outZs[i] = pos.getZ();
+        }
+    }
+
+    void Projection::fromWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        for (std::size_t i = 0; i < count; i++) {
+            MapPos pos = fromWgs84(MapPos(xs[i], ys[i], zs[i]));
+            outXs[i] = pos.getX();
+            outYs[i] = pos.getY();
+            outZs[i] = pos.getZ();
+        }
+    }
+
+    void Projection::toWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const {
+        for (std::size_t i = 0; i < count; i++) {
+            MapPos pos = toWgs84(MapPos(xs[i], ys[i], zs[i]));
+            outXs[i] = pos.getX();
+            outYs[i] = pos.getY();
+            outZs[i] = pos.getZ();
+        }
+    }
         
     Projection::Projection(const MapBounds& bounds) :
         _bounds(bounds)
     {
     }
+
+    std::vector<MapPos> Projection::transformPoses(const std::vector<MapPos>& poses, BatchFunc batchFunc) const {
+        std::vector<MapPos> transformedPoses;
+        transformedPoses.reserve(poses.size());
+
+        // Convert to separate coordinate arrays in fixed size chunks to keep the temporary buffers on the stack
+        double xs[BATCH_SIZE], ys[BATCH_SIZE], zs[BATCH_SIZE];
+        for (std::size_t offset = 0; offset < poses.size(); offset += BATCH_SIZE) {
+            std::size_t count = std::min(poses.size() - offset, static_cast<std::size_t>(BATCH_SIZE));
+            for (std::size_t i = 0; i < count; i++) {
+                const MapPos& pos = poses[offset + i];
+                xs[i] = pos.getX();
+                ys[i] = pos.getY();
+                zs[i] = pos.getZ();
+            }
+            (this->*batchFunc)(count, xs, ys, zs, xs, ys, zs);
+            for (std::size_t i = 0; i < count; i++) {
+                transformedPoses.emplace_back(xs[i], ys[i], zs[i]);
+            }
+        }
+        return transformedPoses;
+    }
     
 }
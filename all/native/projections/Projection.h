@@ -10,6 +10,8 @@
 #include "core/MapPos.h"
 #include "core/MapBounds.h"
 
+#include <vector>
+
 namespace carto {
     
     /**
@@ -95,6 +97,86 @@ namespace carto {
          * @return The transformed position in the WGS84 coordinate system given as latitude-longitude.
          */
         MapPos toLatLong(double x, double y) const;
+
+#ifndef SWIG
+        /**
+         * Transforms a list of positions from the internal coordinate system to the coordinate system of this projection.
+         * @param poses The positions in the internal coordinate system.
+         * @return The transformed positions in the coordinate system of this projection.
+         */
+        std::vector<MapPos> fromInternalPoses(const std::vector<MapPos>& poses) const;
+        /**
+         * Transforms a list of positions from the coordinate system of this projection to the internal coordinate system.
+         * @param poses The positions in the coordinate system of this projection.
+         * @return The transformed positions in the internal coordinate system.
+         */
+        std::vector<MapPos> toInternalPoses(const std::vector<MapPos>& poses) const;
+        /**
+         * Transforms a list of positions from the WGS84 coordinate system to the coordinate system of this projection.
+         * @param poses The positions in the WGS84 coordinate system, encoded as longitude-latitude.
+         * @return The transformed positions in the coordinate system of this projection.
+         */
+        std::vector<MapPos> fromWgs84Poses(const std::vector<MapPos>& poses) const;
+        /**
+         * Transforms a list of positions from the coordinate system of this projection to the WGS84 coordinate system.
+         * @param poses The positions in the coordinate system of this projection.
+         * @return The transformed positions in the WGS84 coordinate system, given as longitude-latitude.
+         */
+        std::vector<MapPos> toWgs84Poses(const std::vector<MapPos>& poses) const;
+
+        /**
+         * Transforms a batch of positions from the internal coordinate system to the coordinate system of this projection.
+         * Coordinates are given as separate arrays, output arrays may be the same as input arrays.
+         * The default implementation transforms positions one by one.
+         * @param count The number of positions.
+         * @param xs The x coordinates in the internal coordinate system.
+         * @param ys The y coordinates in the internal coordinate system.
+         * @param zs The z coordinates in the internal coordinate system.
+         * @param outXs The array for transformed x coordinates.
+         * @param outYs The array for transformed y coordinates.
+         * @param outZs The array for transformed z coordinates.
+         */
+        virtual void fromInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+        /**
+         * Transforms a batch of positions from the coordinate system of this projection to the internal coordinate system.
+         * Coordinates are given as separate arrays, output arrays may be the same as input arrays.
+         * The default implementation transforms positions one by one.
+         * @param count The number of positions.
+         * @param xs The x coordinates in the coordinate system of this projection.
+         * @param ys The y coordinates in the coordinate system of this projection.
+         * @param zs The z coordinates in the coordinate system of this projection.
+         * @param outXs The array for transformed x coordinates.
+         * @param outYs The array for transformed y coordinates.
+         * @param outZs The array for transformed z coordinates.
+         */
+        virtual void toInternalBatch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+        /**
+         * Transforms a batch of positions from the WGS84 coordinate system to the coordinate system of this projection.
+         * Coordinates are given as separate arrays, output arrays may be the same as input arrays.
+         * The default implementation transforms positions one by one.
+         * @param count The number of positions.
+         * @param xs The longitudes.
+         * @param ys The latitudes.
+         * @param zs The z coordinates.
+         * @param outXs The array for transformed x coordinates.
+         * @param outYs The array for transformed y coordinates.
+         * @param outZs The array for transformed z coordinates.
+         */
+        virtual void fromWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+        /**
+         * Transforms a batch of positions from the coordinate system of this projection to the WGS84 coordinate system.
+         * Coordinates are given as separate arrays, output arrays may be the same as input arrays.
+         * The default implementation transforms positions one by one.
+         * @param count The number of positions.
+         * @param xs The x coordinates in the coordinate system of this projection.
+         * @param ys The y coordinates in the coordinate system of this projection.
+         * @param zs The z coordinates in the coordinate system of this projection.
+         * @param outXs The array for longitudes.
+         * @param outYs The array for latitudes.
+         * @param outZs The array for transformed z coordinates.
+         */
+        virtual void toWgs84Batch(std::size_t count, const double* xs, const double* ys, const double* zs, double* outXs, double* outYs, double* outZs) const;
+#endif
     
         /**
          * Return name of this projection in Well-Known format. For example, as "EPSG:3857"
@@ -108,7 +190,13 @@ namespace carto {
         MapBounds _bounds;
 
     private:
+        typedef void (Projection::*BatchFunc)(std::size_t, const double*, const double*, const double*, double*, double*, double*) const;
+
+        std::vector<MapPos> transformPoses(const std::vector<MapPos>& poses, BatchFunc batchFunc) const;
+
         static const int EARTH_RADIUS = 6371000;
+
+        static const int BATCH_SIZE = 256;
     };
     
 }
@@ -16,6 +16,7 @@
 #include "renderers/MapRendererListener.h"
 #include "renderers/RendererCaptureListener.h"
 #include "renderers/RedrawRequestListener.h"
+#include "renderers/components/FrameStatistics.h"
 #include "renderers/components/RayIntersectedElement.h"
 #include "renderers/cameraevents/CameraPanEvent.h"
 #include "renderers/cameraevents/CameraRotationEvent.h"
@@ -26,7 +27,9 @@
 #include "renderers/workers/RedrawWorker.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
+#include "utils/MemoryBudgetManager.h"
 #include "utils/ThreadUtils.h"
+#include "utils/Tracer.h"
 
 #include <algorithm>
 
@@ -35,6 +38,11 @@ namespace carto {
     MapRenderer::MapRenderer(const std::shared_ptr<Layers>& layers,
                              const std::shared_ptr<Options>& options) :
         _lastFrameTime(),
+        _averageFrameTime(0),
+        _reducedQuality(false),
+        _lastModelviewProjectionMat(cglib::mat4x4<double>::zero()),
+        _layerDrawTimes(),
+        _billboardsDrawTime(0),
         _viewState(),
         _shaderManager(),
         _textureManager(),
@@ -504,6 +512,10 @@ namespace carto {
     }
     
     void MapRenderer::onDrawFrame() {
+        Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_MAP_RENDERER_DRAW_FRAME);
+
+        std::chrono::steady_clock::time_point frameStartTime = std::chrono::steady_clock::now();
+
         _redrawPending = false;
 
         std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
@@ -567,15 +579,32 @@ namespace carto {
         _animationHandler.calculate(viewState, deltaSeconds);
         _kineticEventHandler.calculate(viewState, deltaSeconds);
 
+        // If the map is moving and rendering exceeds the frame time budget, use reduced quality until the map stops
+        bool moving = viewState.getModelviewProjectionMat() != _lastModelviewProjectionMat;
+        _lastModelviewProjectionMat = viewState.getModelviewProjectionMat();
+        float frameTimeBudget = _options->getFrameTimeBudget();
+        _reducedQuality = frameTimeBudget > 0 && moving && (_reducedQuality || _averageFrameTime > frameTimeBudget);
+
         setUpGLState();
     
         _backgroundRenderer.onDrawFrame(viewState);
         drawLayers(deltaSeconds, viewState);
         _watermarkRenderer.onDrawFrame(viewState);
+
+        float frameTime = std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(std::chrono::steady_clock::now() - frameStartTime).count();
+        if (_reducedQuality) {
+            // Make sure the full quality frame is drawn once the map stops
+            requestRedraw();
+        } else {
+            _averageFrameTime += (frameTime - _averageFrameTime) * FRAME_TIME_SMOOTHING;
+        }
     
         // Callback for synchronized rendering
         if (mapRendererListener) {
             mapRendererListener->onAfterDrawFrame();
+            if (_options->isFrameStatistics()) {
+                mapRendererListener->onFrameStatistics(std::make_shared<FrameStatistics>(frameTime, _billboardsDrawTime, _layerDrawTimes, _reducedQuality));
+            }
         }
 
         // Update billobard placements/visibility
@@ -589,6 +618,9 @@ namespace carto {
         
         handleRenderThreadCallbacks();
         handleRenderCaptureCallbacks();
+
+        // Rebalance cache capacities within the global memory budget, if needed
+        MemoryBudgetManager::Update();
         
         // Call listener to inform we are idle now, if no redraw request is pending
         if (!_redrawPending) {
@@ -748,9 +780,15 @@ namespace carto {
             
             // Clear billboard before sorting
             _billboardSorter.clear();
+
+            // Per-layer drawing times are accumulated over both passes
+            _layerDrawTimes.assign(layers.size(), 0.0f);
             
             // Do base drawing pass
-            for (const std::shared_ptr<Layer>& layer : layers) {
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                const std::shared_ptr<Layer>& layer = layers[i];
+                std::chrono::steady_clock::time_point layerStartTime = std::chrono::steady_clock::now();
+
                 if (viewState.getHorizontalLayerOffsetDir() != 0) {
                     layer->offsetLayerHorizontally(viewState.getHorizontalLayerOffsetDir() * Const::WORLD_SIZE);
                 }
@@ -760,13 +798,21 @@ namespace carto {
                     layer->onSurfaceCreated(_shaderManager, _textureManager);
                     layerChanged(layer, false);
                 }
+
+                layer->setReducedRenderQuality(_reducedQuality);
     
                 needRedraw = layer->onDrawFrame(deltaSeconds, _billboardSorter, *_styleCache, viewState) || needRedraw;
+
+                _layerDrawTimes[i] += std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(std::chrono::steady_clock::now() - layerStartTime).count();
             }
             
             // Do 3D drawing pass
-            for (const std::shared_ptr<Layer>& layer : layers) {
-                needRedraw = layer->onDrawFrame3D(deltaSeconds, _billboardSorter, *_styleCache, viewState) || needRedraw;
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                std::chrono::steady_clock::time_point layerStartTime = std::chrono::steady_clock::now();
+
+                needRedraw = layers[i]->onDrawFrame3D(deltaSeconds, _billboardSorter, *_styleCache, viewState) || needRedraw;
+
+                _layerDrawTimes[i] += std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(std::chrono::steady_clock::now() - layerStartTime).count();
             }
             
             // Sort billboards, calculate rotation state
@@ -774,6 +820,7 @@ namespace carto {
         }
         
         // Draw billboards, grouped by layer renderer
+        std::chrono::steady_clock::time_point billboardsStartTime = std::chrono::steady_clock::now();
         BillboardRenderer* prevRenderer = NULL;
         _billboardDrawDataBuffer.clear();
         const std::vector<std::shared_ptr<BillboardDrawData> >& sortedBillboardDrawDatas = _billboardSorter.getSortedBillboardDrawDatas();
@@ -792,6 +839,8 @@ namespace carto {
         if (prevRenderer) {
             prevRenderer->onDrawFrameSorted(deltaSeconds, _billboardDrawDataBuffer, *_styleCache, viewState);
         }
+
+        _billboardsDrawTime = std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(std::chrono::steady_clock::now() - billboardsStartTime).count();
     
         if (needRedraw) {
             requestRedraw();
@@ -868,4 +917,6 @@ namespace carto {
 
     const int MapRenderer::STYLE_TEXTURE_CACHE_SIZE = 8 * 1024 * 1024;
 
+    const float MapRenderer::FRAME_TIME_SMOOTHING = 0.2f;
+
 }
@@ -159,8 +159,16 @@ namespace carto {
         static const int BILLBOARD_PLACEMENT_TASK_DELAY;
 
         static const int STYLE_TEXTURE_CACHE_SIZE; // Size limit (in bytes) for style texture cache
+
+        static const float FRAME_TIME_SMOOTHING; // Weight of the latest frame in the averaged frame time
         
         std::chrono::steady_clock::time_point _lastFrameTime;
+
+        float _averageFrameTime;
+        bool _reducedQuality;
+        cglib::mat4x4<double> _lastModelviewProjectionMat;
+        std::vector<float> _layerDrawTimes;
+        float _billboardsDrawTime;
     
         ViewState _viewState;
     
@@ -7,7 +7,10 @@
 #ifndef _CARTO_MAPRENDERERLISTENER_H_
 #define _CARTO_MAPRENDERERLISTENER_H_
 
+#include <memory>
+
 namespace carto {
+    class FrameStatistics;
 
     /**
      * Listener for specific map renderer events.
@@ -29,6 +32,14 @@ namespace carto {
          * This method is called from GL renderer thread, not from main thread.
          */
         virtual void onAfterDrawFrame() { }
+
+        /**
+         * Listener method that gets called after each frame with the rendering statistics of the frame.
+         * The method is called only if frame statistics are enabled using Options::setFrameStatistics.
+         * This method is called from GL renderer thread, not from main thread.
+         * @param statistics The statistics of the rendered frame.
+         */
+        virtual void onFrameStatistics(const std::shared_ptr<FrameStatistics>& statistics) { }
     };
     
 }
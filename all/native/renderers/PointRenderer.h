@@ -48,6 +48,13 @@ namespace carto {
     
         virtual void calculateRayIntersectedElements(const std::shared_ptr<VectorLayer>& layer, const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const;
 
+        static bool FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
+                                               const std::shared_ptr<PointDrawData>& drawData,
+                                               const std::shared_ptr<VectorLayer>& layer,
+                                               const cglib::ray3<double>& ray,
+                                               const ViewState& viewState,
+                                               std::vector<RayIntersectedElement>& results);
+
     protected:
         friend class GeometryCollectionRenderer;
 
@@ -63,13 +70,6 @@ namespace carto {
                                         const cglib::vec2<float>& texCoordScale,
                                         StyleTextureCache& styleCache,
                                         const ViewState& viewState);
-        
-        static bool FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
-                                               const std::shared_ptr<PointDrawData>& drawData,
-                                               const std::shared_ptr<VectorLayer>& layer,
-                                               const cglib::ray3<double>& ray,
-                                               const ViewState& viewState,
-                                               std::vector<RayIntersectedElement>& results);
 
         void bind(const ViewState& viewState);
         void unbind();
@@ -9,6 +9,7 @@
 #include "renderers/drawdatas/TileDrawData.h"
 #include "utils/Log.h"
 #include "utils/Const.h"
+#include "utils/Tracer.h"
 
 #include <vt/TileLabelCuller.h>
 #include <vt/GLTileRenderer.h>
@@ -41,8 +42,11 @@ namespace carto {
         _useDepth(useDepth),
         _useStencil(useStencil),
         _interactionMode(false),
+        _frameNr(0),
+        _tileReloader(),
         _labelOrder(0),
         _buildingOrder(1),
+        _reducedQuality(false),
         _horizontalLayerOffset(0),
         _tiles(),
         _mutex()
@@ -57,6 +61,19 @@ namespace carto {
         _interactionMode = enabled;
     }
     
+    void TileRenderer::setFrameNr(int frameNr) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _frameNr = frameNr;
+    }
+    
+    void TileRenderer::setTileReloader(const std::function<std::shared_ptr<const vt::Tile>(const std::shared_ptr<const vt::Tile>&)>& tileReloader) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tileReloader = tileReloader;
+        if (_glRenderer) {
+            _glRenderer->setTileReloader(_tileReloader);
+        }
+    }
+    
     void TileRenderer::setLabelOrder(int order) {
         std::lock_guard<std::mutex> lock(_mutex);
         _labelOrder = order;
@@ -67,6 +84,11 @@ namespace carto {
         _buildingOrder = order;
     }
     
+    void TileRenderer::setReducedQuality(bool reduced) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _reducedQuality = reduced;
+    }
+    
     void TileRenderer::offsetLayerHorizontally(double offset) {
         std::lock_guard<std::mutex> lock(_mutex);
         _horizontalLayerOffset += offset;
@@ -89,12 +111,15 @@ namespace carto {
             new vt::GLTileRenderer(_glRendererMutex, std::make_shared<carto::vt::GLExtensions>(), carto::Const::WORLD_SIZE, _useFBO, _useDepth, _useStencil), glRendererDeleter
         );
         _glRenderer->setSubTileBlending(true);
+        _glRenderer->setTileReloader(_tileReloader);
         _glRenderer->initializeRenderer();
         _tiles.clear();
         GLContext::CheckGLError("TileRenderer::onSurfaceCreated()");
     }
     
     bool TileRenderer::onDrawFrame(float deltaSeconds, const ViewState& viewState) {
+        Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_TILE_RENDERER_DRAW_FRAME);
+
         std::lock_guard<std::mutex> lock(_mutex);
         
         if (!_glRenderer) {
@@ -105,17 +130,20 @@ namespace carto {
         modelViewMat = modelViewMat * cglib::translate4_matrix(cglib::vec3<double>(_horizontalLayerOffset, 0, 0));
         _glRenderer->setViewState(viewState.getProjectionMat(), modelViewMat, viewState.getZoom(), viewState.getAspectRatio(), viewState.getNormalizedResolution());
         _glRenderer->setInteractionMode(_interactionMode);
+        _glRenderer->setFrameNr(_frameNr);
+        _glRenderer->setSubTileBlending(!_reducedQuality);
         
         _glRenderer->startFrame(deltaSeconds * 3);
 
+        // In reduced quality mode labels and 3D geometry are skipped
         bool refresh = _glRenderer->renderGeometry2D();
-        if (_labelOrder == 0) {
+        if (_labelOrder == 0 && !_reducedQuality) {
             refresh = _glRenderer->renderLabels(true, false) || refresh;
         }
-        if (_buildingOrder == 0) {
+        if (_buildingOrder == 0 && !_reducedQuality) {
             refresh = _glRenderer->renderGeometry3D() || refresh;
         }
-        if (_labelOrder == 0) {
+        if (_labelOrder == 0 && !_reducedQuality) {
             refresh = _glRenderer->renderLabels(false, true) || refresh;
         }
     
@@ -137,13 +165,13 @@ namespace carto {
         }
 
         bool refresh = false;	
-        if (_labelOrder == 1) {
+        if (_labelOrder == 1 && !_reducedQuality) {
             refresh = _glRenderer->renderLabels(true, false) || refresh;
         }
-        if (_buildingOrder == 1) {
+        if (_buildingOrder == 1 && !_reducedQuality) {
             refresh = _glRenderer->renderGeometry3D() || refresh;
         }
-        if (_labelOrder == 1) {
+        if (_labelOrder == 1 && !_reducedQuality) {
             refresh = _glRenderer->renderLabels(false, true) || refresh;
         }
 
@@ -218,6 +246,8 @@ namespace carto {
     }
     
     bool TileRenderer::refreshTiles(const std::vector<std::shared_ptr<TileDrawData> >& drawDatas) {
+        Tracer::ScopedSpan span(TraceStage::TRACE_STAGE_TILE_RENDERER_REFRESH);
+
         std::lock_guard<std::mutex> lock(_mutex);
 
         if (!_glRenderer) {
@@ -10,6 +10,7 @@
 #include "graphics/Color.h"
 #include "graphics/ViewState.h"
 
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <map>
@@ -39,8 +40,11 @@ namespace carto {
         virtual ~TileRenderer();
     
         void setInteractionMode(bool enabled);
+        void setFrameNr(int frameNr);
+        void setTileReloader(const std::function<std::shared_ptr<const vt::Tile>(const std::shared_ptr<const vt::Tile>&)>& tileReloader);
         void setLabelOrder(int order);
         void setBuildingOrder(int order);
+        void setReducedQuality(bool reduced);
 
         void offsetLayerHorizontally(double offset);
     
@@ -67,8 +71,11 @@ namespace carto {
         bool _useDepth;
         bool _useStencil;
         bool _interactionMode;
+        int _frameNr;
+        std::function<std::shared_ptr<const vt::Tile>(const std::shared_ptr<const vt::Tile>&)> _tileReloader;
         int _labelOrder;
         int _buildingOrder;
+        bool _reducedQuality;
         double _horizontalLayerOffset;
         std::map<vt::TileId, std::shared_ptr<const vt::Tile> > _tiles;
 
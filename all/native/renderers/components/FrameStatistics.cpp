@@ -0,0 +1,45 @@
+#include "FrameStatistics.h"
+
+#include <numeric>
+
+namespace carto {
+
+    FrameStatistics::FrameStatistics(float frameTime, float billboardsDrawTime, const std::vector<float>& layerDrawTimes, bool reducedQuality) :
+        _frameTime(frameTime),
+        _billboardsDrawTime(billboardsDrawTime),
+        _layerDrawTimes(layerDrawTimes),
+        _reducedQuality(reducedQuality)
+    {
+    }
+    
+    FrameStatistics::~FrameStatistics() {
+    }
+    
+    float FrameStatistics::getFrameTime() const {
+        return _frameTime;
+    }
+    
+    float FrameStatistics::getLayersDrawTime() const {
+        return std::accumulate(_layerDrawTimes.begin(), _layerDrawTimes.end(), 0.0f);
+    }
+    
+    float FrameStatistics::getBillboardsDrawTime() const {
+        return _billboardsDrawTime;
+    }
+    
+    int FrameStatistics::getLayerCount() const {
+        return static_cast<int>(_layerDrawTimes.size());
+    }
+    
+    float FrameStatistics::getLayerDrawTime(int index) const {
+        if (index < 0 || index >= static_cast<int>(_layerDrawTimes.size())) {
+            return 0;
+        }
+        return _layerDrawTimes[index];
+    }
+    
+    bool FrameStatistics::isReducedQuality() const {
+        return _reducedQuality;
+    }
+    
+}
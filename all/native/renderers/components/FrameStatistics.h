@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_FRAMESTATISTICS_H_
+#define _CARTO_FRAMESTATISTICS_H_
+
+#include <memory>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * Rendering statistics of a single frame. All times are measured on the CPU side, in milliseconds.
+     */
+    class FrameStatistics {
+    public:
+        /**
+         * Constructs a FrameStatistics object from the measured times.
+         * @param frameTime The total frame time in milliseconds.
+         * @param billboardsDrawTime The billboard drawing time in milliseconds.
+         * @param layerDrawTimes The drawing times of individual layers in milliseconds.
+         * @param reducedQuality True if the frame was rendered with reduced quality.
+         */
+        FrameStatistics(float frameTime, float billboardsDrawTime, const std::vector<float>& layerDrawTimes, bool reducedQuality);
+        virtual ~FrameStatistics();
+    
+        /**
+         * Returns the total time spent rendering the frame.
+         * @return The frame time in milliseconds.
+         */
+        float getFrameTime() const;
+        /**
+         * Returns the time spent drawing all layers, excluding billboards.
+         * @return The layer drawing time in milliseconds.
+         */
+        float getLayersDrawTime() const;
+        /**
+         * Returns the time spent drawing billboards of all layers.
+         * @return The billboard drawing time in milliseconds.
+         */
+        float getBillboardsDrawTime() const;
+
+        /**
+         * Returns the number of layers drawn in the frame.
+         * @return The number of layers.
+         */
+        int getLayerCount() const;
+        /**
+         * Returns the time spent drawing the layer with given index.
+         * @param index The index of the layer.
+         * @return The drawing time of the layer in milliseconds. If the index is out of range, zero is returned.
+         */
+        float getLayerDrawTime(int index) const;
+
+        /**
+         * Returns true if the frame was rendered with reduced quality due to exceeded frame time budget.
+         * @return True if the frame was rendered with reduced quality.
+         */
+        bool isReducedQuality() const;
+    
+    private:
+        float _frameTime;
+        float _billboardsDrawTime;
+        std::vector<float> _layerDrawTimes;
+        bool _reducedQuality;
+    };
+    
+}
+
+#endif
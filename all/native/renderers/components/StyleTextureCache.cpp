@@ -8,7 +8,10 @@ namespace carto {
     StyleTextureCache::StyleTextureCache(const std::shared_ptr<TextureManager>& textureManager, unsigned int capacityInBytes) :
         _textureManager(textureManager),
         _cache(capacityInBytes),
-        _mutex()
+        _mutex(),
+        _cacheRegistration("StyleTextureCache::cache", CacheCategory::CACHE_CATEGORY_GENERAL, capacityInBytes,
+            [this]() { std::lock_guard<std::mutex> lock(_mutex); return _cache.size(); },
+            [this](std::size_t capacity) { std::lock_guard<std::mutex> lock(_mutex); _cache.resize(capacity); })
     {
     }
     
@@ -16,15 +19,11 @@ namespace carto {
     }
     
     std::size_t StyleTextureCache::getCapacity() const {
-        std::lock_guard<std::mutex> lock(_mutex);
-
-        return _cache.capacity();
+        return _cacheRegistration.getRequestedCapacity();
     }
     
     void StyleTextureCache::setCapacity(std::size_t capacityInBytes) {
-        std::lock_guard<std::mutex> lock(_mutex);
-
-        _cache.resize(capacityInBytes);
+        _cacheRegistration.setRequestedCapacity(capacityInBytes);
     }
         
     void StyleTextureCache::setTextureManager(const std::shared_ptr<TextureManager>& textureManager) {
@@ -37,7 +36,9 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
 
         std::shared_ptr<Texture> texture;
-        _cache.read(bitmap, texture);
+        if (_cache.read(bitmap, texture)) {
+            _cacheRegistration.recordHit();
+        }
         return texture;
     }
     
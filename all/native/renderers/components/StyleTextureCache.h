@@ -7,6 +7,8 @@
 #ifndef _CARTO_STYLETEXTURECACHE_H_
 #define _CARTO_STYLETEXTURECACHE_H_
 
+#include "utils/MemoryBudgetManager.h"
+
 #include <memory>
 #include <mutex>
 
@@ -37,6 +39,8 @@ namespace carto {
         cache::timed_lru_cache<std::shared_ptr<Bitmap>, std::shared_ptr<Texture> > _cache;
         
         mutable std::mutex _mutex;
+
+        MemoryBudgetManager::CacheRegistration _cacheRegistration;
     };
         
 }
@@ -37,10 +37,10 @@ namespace carto {
         _indices()
     {
         // Remove consecutive duplicates and project coordinates to internal coordinate system
-        const std::vector<MapPos>& poses = geometry.getPoses();
-        _poses.reserve(poses.size());
-        for (std::size_t i = 0; i < poses.size(); i++) {
-            MapPos posInternal = projection.toInternal(poses[i]);
+        std::vector<MapPos> internalPoses = projection.toInternalPoses(geometry.getPoses());
+        _poses.reserve(internalPoses.size());
+        for (std::size_t i = 0; i < internalPoses.size(); i++) {
+            const MapPos& posInternal = internalPoses[i];
             cglib::vec3<double> pos(posInternal.getX(), posInternal.getY(), posInternal.getZ());
             if (i == 0 || _poses.back() != pos) {
                 _poses.push_back(pos);
@@ -44,10 +44,11 @@ namespace carto {
         // Prepare polygon exterior, calculate bounding box
         const std::vector<MapPos>& poses = polygon3D.getGeometry()->getPoses();
         std::size_t edgeVertexCount = poses.size();
+        std::vector<MapPos> internalPoses = projection.toInternalPoses(poses);
         std::vector<double> posesArray(poses.size() * 2);
         for (std::size_t i = 0; i < poses.size() * 2; i += 2) {
             std::size_t index = i / 2;
-            const MapPos& internalPos = projection.toInternal(poses[index]);
+            const MapPos& internalPos = internalPoses[index];
             posesArray[i + 0] = internalPos.getX();
             posesArray[i + 1] = internalPos.getY();
             _boundingBox.add(cglib::vec3<double>(internalPos.getX(), internalPos.getY(), internalPos.getZ()));
@@ -62,9 +63,10 @@ namespace carto {
             edgeVertexCount += hole.size();
             std::vector<double>& holeArray = holesArray[n];
             holeArray.resize(hole.size() * 2);
+            internalPoses = projection.toInternalPoses(hole);
             for (std::size_t i = 0; i < hole.size() * 2; i += 2) {
                 std::size_t index = i / 2;
-                const MapPos& internalPos = projection.toInternal(hole[index]);
+                const MapPos& internalPos = internalPoses[index];
                 holeArray[i + 0] = internalPos.getX();
                 holeArray[i + 1] = internalPos.getY();
                 _boundingBox.add(cglib::vec3<double>(internalPos.getX(), internalPos.getY(), internalPos.getZ()));
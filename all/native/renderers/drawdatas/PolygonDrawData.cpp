@@ -14,6 +14,7 @@
 #include <cstdlib>
 #include <tesselator.h>
 #include <unordered_map>
+#include <utility>
 
 namespace {
 
@@ -51,19 +52,16 @@ namespace carto {
         TESStesselator* tess = tessNewTess(&ma);
     
         // Add polygon exterior, calculate bounding box
-        const std::vector<MapPos>& poses = geometry.getPoses();
-        std::vector<MapPos> internalPoses;
-        internalPoses.reserve(poses.size());
-        std::vector<double> posesArray(poses.size() * 2);
-        for (std::size_t i = 0; i < poses.size() * 2; i += 2) {
+        std::vector<MapPos> internalPoses = projection.toInternalPoses(geometry.getPoses());
+        std::vector<double> posesArray(internalPoses.size() * 2);
+        for (std::size_t i = 0; i < internalPoses.size() * 2; i += 2) {
             std::size_t index = i / 2;
-            MapPos internalPos = projection.toInternal(poses[index]);
-            internalPoses.push_back(internalPos);
+            const MapPos& internalPos = internalPoses[index];
             posesArray[i + 0] = internalPos.getX();
             posesArray[i + 1] = internalPos.getY();
             _boundingBox.add(cglib::vec3<double>(internalPos.getX(), internalPos.getY(), internalPos.getZ()));
         }
-        tessAddContour(tess, 2, posesArray.data(), sizeof(double) * 2, static_cast<unsigned int>(poses.size()));
+        tessAddContour(tess, 2, posesArray.data(), sizeof(double) * 2, static_cast<unsigned int>(internalPoses.size()));
     
         if (style.getLineStyle()) {
             _lineDrawDatas.push_back(std::make_shared<LineDrawData>(geometry, internalPoses, *style.getLineStyle(), projection));
@@ -72,13 +70,11 @@ namespace carto {
         // Add polygon holes
         const std::vector<std::vector<MapPos> >& holes = geometry.getHoles();
         for (const std::vector<MapPos>& hole : holes) {
-            internalPoses.clear();
-            internalPoses.reserve(hole.size());
-            std::vector<double> holeArray(hole.size() * 2);
-            for (std::size_t i = 0; i < hole.size() * 2; i += 2) {
+            internalPoses = projection.toInternalPoses(hole);
+            std::vector<double> holeArray(internalPoses.size() * 2);
+            for (std::size_t i = 0; i < internalPoses.size() * 2; i += 2) {
                 std::size_t index = i / 2;
-                MapPos internalPos = projection.toInternal(hole[index]);
-                internalPoses.push_back(internalPos);
+                const MapPos& internalPos = internalPoses[index];
                 holeArray[i + 0] = internalPos.getX();
                 holeArray[i + 1] = internalPos.getY();
                 _boundingBox.add(cglib::vec3<double>(internalPos.getX(), internalPos.getY(), internalPos.getZ()));
@@ -154,6 +150,56 @@ namespace carto {
         tessDeleteTess(tess);
     }
     
+    PolygonDrawData::PolygonDrawData(const PolygonDrawData& drawData, const PolygonGeometry& oldGeometry, const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection) :
+        VectorElementDrawData(style.getColor()),
+        _bitmap(style.getBitmap()),
+        _boundingBox(drawData._boundingBox),
+        _coords(drawData._coords),
+        _indices(drawData._indices),
+        _lineDrawDatas()
+    {
+        const std::vector<std::vector<MapPos> >& oldRings = oldGeometry.getRings();
+        const std::vector<std::vector<MapPos> >& rings = geometry.getRings();
+        _lineDrawDatas.reserve(style.getLineStyle() ? rings.size() : 0);
+
+        // Find the moved vertices. Outlines are recreated only for the rings containing moved vertices
+        std::vector<std::pair<MapPos, MapPos> > movedInternalPoses;
+        for (std::size_t n = 0; n < rings.size(); n++) {
+            const std::vector<MapPos>& ring = rings[n];
+            const std::vector<MapPos>& oldRing = oldRings[n];
+            bool ringMoved = false;
+            for (std::size_t i = 0; i < ring.size(); i++) {
+                if (ring[i] != oldRing[i]) {
+                    MapPos internalPos = projection.toInternal(ring[i]);
+                    movedInternalPoses.emplace_back(projection.toInternal(oldRing[i]), internalPos);
+                    _boundingBox.add(cglib::vec3<double>(internalPos.getX(), internalPos.getY(), internalPos.getZ()));
+                    ringMoved = true;
+                }
+            }
+
+            if (style.getLineStyle()) {
+                if (!ringMoved && n < drawData._lineDrawDatas.size()) {
+                    _lineDrawDatas.push_back(drawData._lineDrawDatas[n]);
+                } else {
+                    _lineDrawDatas.push_back(std::make_shared<LineDrawData>(geometry, projection.toInternalPoses(ring), *style.getLineStyle(), projection));
+                }
+            }
+        }
+
+        // Keep the triangles, move the tesselated vertices that match the old vertex positions. Vertices added by the tesselator stay in place
+        for (std::vector<cglib::vec3<double> >& coords : _coords) {
+            for (cglib::vec3<double>& coord : coords) {
+                for (const std::pair<MapPos, MapPos>& movedInternalPos : movedInternalPoses) {
+                    if (coord(0) == movedInternalPos.first.getX() && coord(1) == movedInternalPos.first.getY()) {
+                        coord(0) = movedInternalPos.second.getX();
+                        coord(1) = movedInternalPos.second.getY();
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
     PolygonDrawData::~PolygonDrawData() {
     }
     
@@ -26,6 +26,8 @@ namespace carto {
     class PolygonDrawData : public VectorElementDrawData {
     public:
         PolygonDrawData(const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection);
+        // Reuses the triangulation of the draw data created from oldGeometry, only moved vertices are updated. The rings must have the same vertex counts.
+        PolygonDrawData(const PolygonDrawData& drawData, const PolygonGeometry& oldGeometry, const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection);
         PolygonDrawData(const PolygonDrawData& drawData);
         virtual ~PolygonDrawData();
     
@@ -13,7 +13,14 @@ namespace carto {
     BillboardPlacementWorker::BillboardPlacementWorker() :
         _stop(false),
         _idle(false),
-        _kdTree(),
+        _coordBuf(),
+        _screenCoordBuf(),
+        _gridEnvelopes(),
+        _gridEnvelopeStamps(),
+        _gridCellHeads(GRID_RESOLUTION * GRID_RESOLUTION, -1),
+        _gridEntries(),
+        _gridQueryStamp(0),
+        _lastPlacement(),
         _sort3D(false),
         _pendingWakeup(false),
         _wakeupTime(std::chrono::steady_clock::now() + std::chrono::hours(24)),
@@ -66,7 +73,7 @@ namespace carto {
             {
                 std::unique_lock<std::mutex> lock(_mutex);
 
-                if (_stop) {
+                if (_stop.load()) {
                     return;
                 }
 
@@ -116,61 +123,84 @@ namespace carto {
         
         // Sort draw datas
         _sort3D = viewState.getTilt() < 90;
-        std::sort(billboardDrawDatas.begin(), billboardDrawDatas.end(), std::bind(&BillboardPlacementWorker::overlapComparator, this, std::placeholders::_1, std::placeholders::_2));
+        std::sort(billboardDrawDatas.begin(), billboardDrawDatas.end(), [this](const std::shared_ptr<BillboardDrawData>& drawData1, const std::shared_ptr<BillboardDrawData>& drawData2) {
+            return overlapComparator(drawData1, drawData2);
+        });
         
-        // Calculate billboard screen coordinates, add envelopes to the tree
-        std::vector<float> coordBuf(12);
+        // Calculate world coordinates of all billboards
+        std::size_t count = billboardDrawDatas.size();
+        _coordBuf.resize(count * 12);
+        for (std::size_t i = 0; i < count; i++) {
+            BillboardRenderer::CalculateBillboardCoords(*billboardDrawDatas[i], viewState, _coordBuf, static_cast<int>(i));
+        }
+        
+        if (_stop.load()) {
+            return false;
+        }
+        
+        // Transform all world coordinates to screen coordinates in a single pass
+        const float m00 = rteMVPMat(0, 0), m01 = rteMVPMat(0, 1), m02 = rteMVPMat(0, 2), m03 = rteMVPMat(0, 3);
+        const float m10 = rteMVPMat(1, 0), m11 = rteMVPMat(1, 1), m12 = rteMVPMat(1, 2), m13 = rteMVPMat(1, 3);
+        const float m30 = rteMVPMat(3, 0), m31 = rteMVPMat(3, 1), m32 = rteMVPMat(3, 2), m33 = rteMVPMat(3, 3);
+        _screenCoordBuf.resize(count * 8);
+        const float* coords = _coordBuf.data();
+        float* screenCoords = _screenCoordBuf.data();
+        for (std::size_t i = 0; i < count * 4; i++) {
+            float x = coords[i * 3 + 0], y = coords[i * 3 + 1], z = coords[i * 3 + 2];
+            float invW = 1.0f / (m30 * x + m31 * y + m32 * z + m33);
+            screenCoords[i * 2 + 0] = (m00 * x + m01 * y + m02 * z + m03) * invW;
+            screenCoords[i * 2 + 1] = (m10 * x + m11 * y + m12 * z + m13) * invW;
+        }
+        
+        // Check overlapping, add envelopes to the grid. Billboards in the unchanged prefix of the previous pass keep their previous state
+        std::vector<PlacementRecord> placement;
+        placement.reserve(count);
         std::vector<MapPos> convexHull;
         convexHull.reserve(4);
+        bool unchanged = true;
         bool changed = false;
-        for (const std::shared_ptr<BillboardDrawData>& drawData : billboardDrawDatas) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (_stop) {
+        clearGrid();
+        for (std::size_t i = 0; i < count; i++) {
+            if ((i & 255) == 0 && _stop.load()) {
                 return false;
             }
             
-            // Calculate billboard world coordinates
-            BillboardRenderer::CalculateBillboardCoords(*drawData, viewState, coordBuf, 0);
-            
-            // Transform the world coordinates to screen coordinates
-            cglib::vec3<float> topLeft(cglib::transform_point(cglib::vec3<float>(coordBuf[0], coordBuf[1], coordBuf[2]), rteMVPMat));
-            cglib::vec3<float> bottomLeft(cglib::transform_point(cglib::vec3<float>(coordBuf[3], coordBuf[4], coordBuf[5]), rteMVPMat));
-            cglib::vec3<float> topRight(cglib::transform_point(cglib::vec3<float>(coordBuf[6], coordBuf[7], coordBuf[8]), rteMVPMat));
-            cglib::vec3<float> bottomRight(cglib::transform_point(cglib::vec3<float>(coordBuf[9], coordBuf[10], coordBuf[11]), rteMVPMat));
+            const std::shared_ptr<BillboardDrawData>& drawData = billboardDrawDatas[i];
+            std::array<float, 8> billboardScreenCoords;
+            std::copy(_screenCoordBuf.begin() + i * 8, _screenCoordBuf.begin() + (i + 1) * 8, billboardScreenCoords.begin());
+            placement.emplace_back(drawData, billboardScreenCoords);
+
+            if (unchanged) {
+                unchanged = i < _lastPlacement.size() && _lastPlacement[i].drawData == drawData && _lastPlacement[i].screenCoords == billboardScreenCoords;
+            }
             
-            // Construct convex polygons from the screen coordinatees
-            convexHull.emplace_back(topLeft(0), topLeft(1), 0);
-            convexHull.emplace_back(bottomLeft(0), bottomLeft(1), 0);
-            convexHull.emplace_back(topRight(0), topRight(1), 0);
-            convexHull.emplace_back(bottomRight(0), bottomRight(1), 0);
+            // Construct convex polygons from the screen coordinates (top-left, bottom-left, top-right, bottom-right)
+            for (int j = 0; j < 4; j++) {
+                convexHull.emplace_back(billboardScreenCoords[j * 2 + 0], billboardScreenCoords[j * 2 + 1], 0);
+            }
             MapEnvelope envelope(convexHull);
+            convexHull.clear();
             
             bool overlapped = false;
-            if (drawData->isHideIfOverlapped()) {
+            if (unchanged) {
+                overlapped = drawData->isOverlapping();
+            } else if (drawData->isHideIfOverlapped()) {
                 // Check that there are higher priority billboards overlapping with this one
-                const std::vector<MapEnvelope>& overlappedEnvelopes = _kdTree.query(envelope.getBounds());
-                for (const MapEnvelope& overlappedEnvelope : overlappedEnvelopes) {
-                    if (overlappedEnvelope.intersects(envelope)) {
-                        // Overlapping detected, hide this billboard
-                        drawData->setOverlapping(true);
-                        changed = true;
-                        overlapped = true;
-                        break;
-                    }
-                }
+                overlapped = testGridOverlap(envelope);
             }
             
-            if (!overlapped) {
-                drawData->setOverlapping(false);
+            if (overlapped != drawData->isOverlapping()) {
+                drawData->setOverlapping(overlapped);
                 changed = true;
-                if (drawData->isCausesOverlap()) {
-                    _kdTree.insert(envelope.getBounds(), envelope);
-                }
             }
-            convexHull.clear();
+            
+            if (!overlapped && drawData->isCausesOverlap()) {
+                insertGrid(envelope);
+            }
         }
         
-        _kdTree.clear();
+        clearGrid();
+        std::swap(_lastPlacement, placement);
         
         if (changed) {
             mapRenderer->requestRedraw();
@@ -211,4 +241,65 @@ namespace carto {
         }
     }
     
+    void BillboardPlacementWorker::clearGrid() {
+        std::fill(_gridCellHeads.begin(), _gridCellHeads.end(), -1);
+        _gridEntries.clear();
+        _gridEnvelopes.clear();
+        _gridEnvelopeStamps.clear();
+    }
+    
+    bool BillboardPlacementWorker::testGridOverlap(const MapEnvelope& envelope) {
+        const MapBounds& bounds = envelope.getBounds();
+        int x0 = GetGridIndex(bounds.getMin().getX()), y0 = GetGridIndex(bounds.getMin().getY());
+        int x1 = GetGridIndex(bounds.getMax().getX()), y1 = GetGridIndex(bounds.getMax().getY());
+        _gridQueryStamp++;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                for (int entry = _gridCellHeads[y * GRID_RESOLUTION + x]; entry != -1; entry = _gridEntries[entry].next) {
+                    // Envelopes spanning multiple cells are tested only once
+                    int envelopeIndex = _gridEntries[entry].envelopeIndex;
+                    if (_gridEnvelopeStamps[envelopeIndex] == _gridQueryStamp) {
+                        continue;
+                    }
+                    _gridEnvelopeStamps[envelopeIndex] = _gridQueryStamp;
+                    
+                    const MapEnvelope& otherEnvelope = _gridEnvelopes[envelopeIndex];
+                    if (otherEnvelope.getBounds().intersects(bounds) && otherEnvelope.intersects(envelope)) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+    
+    void BillboardPlacementWorker::insertGrid(const MapEnvelope& envelope) {
+        int envelopeIndex = static_cast<int>(_gridEnvelopes.size());
+        _gridEnvelopes.push_back(envelope);
+        _gridEnvelopeStamps.push_back(0);
+        
+        const MapBounds& bounds = envelope.getBounds();
+        int x0 = GetGridIndex(bounds.getMin().getX()), y0 = GetGridIndex(bounds.getMin().getY());
+        int x1 = GetGridIndex(bounds.getMax().getX()), y1 = GetGridIndex(bounds.getMax().getY());
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                int& head = _gridCellHeads[y * GRID_RESOLUTION + x];
+                _gridEntries.emplace_back(envelopeIndex, head);
+                head = static_cast<int>(_gridEntries.size()) - 1;
+            }
+        }
+    }
+    
+    int BillboardPlacementWorker::GetGridIndex(double coord) {
+        // Screen coordinates are in normalized device coordinates, envelopes outside of the screen are clamped to border cells
+        double v = coord * 0.5 + 0.5;
+        if (!(v >= 0)) {
+            return 0;
+        }
+        if (v >= 1) {
+            return GRID_RESOLUTION - 1;
+        }
+        return static_cast<int>(v * GRID_RESOLUTION);
+    }
+    
 }
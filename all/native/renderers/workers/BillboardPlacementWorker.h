@@ -9,11 +9,13 @@
 
 #include "components/ThreadWorker.h"
 #include "core/MapEnvelope.h"
-#include "geometry/utils/KDTreeSpatialIndex.h"
 
+#include <array>
+#include <atomic>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace carto {
     class Billboard;
@@ -36,16 +38,47 @@ namespace carto {
         void operator()();
     
     private:
+        static const int GRID_RESOLUTION = 32;
+
+        struct PlacementRecord {
+            std::shared_ptr<BillboardDrawData> drawData;
+            std::array<float, 8> screenCoords;
+            
+            PlacementRecord(const std::shared_ptr<BillboardDrawData>& drawData, const std::array<float, 8>& screenCoords) : drawData(drawData), screenCoords(screenCoords) { }
+        };
+        
+        struct GridEntry {
+            int envelopeIndex;
+            int next;
+            
+            GridEntry(int envelopeIndex, int next) : envelopeIndex(envelopeIndex), next(next) { }
+        };
+        
         void run();
         
         bool calculateBillboardPlacement();
         
         bool overlapComparator(const std::shared_ptr<BillboardDrawData>& drawData1, const std::shared_ptr<BillboardDrawData>& drawData2) const;
         
-        bool _stop;
+        void clearGrid();
+        bool testGridOverlap(const MapEnvelope& envelope);
+        void insertGrid(const MapEnvelope& envelope);
+        
+        static int GetGridIndex(double coord);
+        
+        std::atomic<bool> _stop;
         bool _idle;
         
-        KDTreeSpatialIndex<MapEnvelope> _kdTree;
+        std::vector<float> _coordBuf;
+        std::vector<float> _screenCoordBuf;
+        
+        std::vector<MapEnvelope> _gridEnvelopes;
+        std::vector<int> _gridEnvelopeStamps;
+        std::vector<int> _gridCellHeads;
+        std::vector<GridEntry> _gridEntries;
+        int _gridQueryStamp;
+        
+        std::vector<PlacementRecord> _lastPlacement;
         
         bool _sort3D;
     
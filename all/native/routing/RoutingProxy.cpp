@@ -31,9 +31,10 @@ namespace carto {
         std::size_t totalPoints = 0;
         std::size_t totalInstructions = 0;
         std::vector<routing::Result> results;
-        for (std::size_t i = 1; i < request->getPoints().size(); i++) {
-            MapPos p0 = proj->toWgs84(request->getPoints()[i - 1]);
-            MapPos p1 = proj->toWgs84(request->getPoints()[i]);
+        std::vector<MapPos> wgs84RequestPoints = proj->toWgs84Poses(request->getPoints());
+        for (std::size_t i = 1; i < wgs84RequestPoints.size(); i++) {
+            const MapPos& p0 = wgs84RequestPoints[i - 1];
+            const MapPos& p1 = wgs84RequestPoints[i];
             routing::Query query(routing::WGSPos(p0.getY(), p0.getX()), routing::WGSPos(p1.getY(), p1.getX()));
             routing::Result result = routeFinder->find(query);
             if (result.getStatus() == routing::Result::Status::FAILED) {
@@ -57,10 +58,15 @@ namespace carto {
             }
 
             std::size_t pointIndex = points.size();
+            std::vector<MapPos> wgs84Points;
+            wgs84Points.reserve(result.getGeometry().size());
             for (const routing::WGSPos& pos : result.getGeometry()) {
-                points.push_back(proj->fromWgs84(MapPos(pos(1), pos(0))));
-                epsg3857Points.push_back(epsg3857.fromWgs84(MapPos(pos(1), pos(0))));
+                wgs84Points.emplace_back(pos(1), pos(0));
             }
+            std::vector<MapPos> resultPoints = proj->fromWgs84Poses(wgs84Points);
+            points.insert(points.end(), resultPoints.begin(), resultPoints.end());
+            std::vector<MapPos> resultEpsg3857Points = epsg3857.fromWgs84Poses(wgs84Points);
+            epsg3857Points.insert(epsg3857Points.end(), resultEpsg3857Points.begin(), resultEpsg3857Points.end());
 
             for (const routing::Instruction& instr : result.getInstructions()) {
                 double distance = instr.getDistance();
@@ -120,14 +126,8 @@ namespace carto {
         }
         
         std::vector<MapPos> wgs84Points = DecodeGeometry(responseDoc["route_geometry"].GetString());
-        std::vector<MapPos> points;
-        points.reserve(wgs84Points.size());
-        std::vector<MapPos> epsg3857Points;
-        epsg3857Points.reserve(wgs84Points.size());
-        for (const MapPos& pos : wgs84Points) {
-            points.push_back(proj->fromWgs84(pos));
-            epsg3857Points.push_back(epsg3857.fromWgs84(pos));
-        }
+        std::vector<MapPos> points = proj->fromWgs84Poses(wgs84Points);
+        std::vector<MapPos> epsg3857Points = epsg3857.fromWgs84Poses(wgs84Points);
         
         std::vector<RoutingInstruction> instructions;
         instructions.reserve(responseDoc["route_instructions"].Size() + 2);
@@ -41,43 +41,35 @@ namespace carto {
 #endif
 
     bool Log::IsShowError() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowError;
+        return _ShowError.load();
     }
 
     void Log::SetShowError(bool showError) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowError = showError;
+        _ShowError.store(showError);
     }
 
     bool Log::IsShowWarn() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowWarn;
+        return _ShowWarn.load();
     }
 
     void Log::SetShowWarn(bool showWarn) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowWarn = showWarn;
+        _ShowWarn.store(showWarn);
     }
 
     bool Log::IsShowInfo() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowInfo;
+        return _ShowInfo.load();
     }
 
     void Log::SetShowInfo(bool showInfo) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowInfo = showInfo;
+        _ShowInfo.store(showInfo);
     }
 
     bool Log::IsShowDebug() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowDebug;
+        return _ShowDebug.load();
     }
 
     void Log::SetShowDebug(bool showDebug) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowDebug = showDebug;
+        _ShowDebug.store(showDebug);
     }
 
     std::string Log::GetTag() {
@@ -118,8 +110,8 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowError) {
+        if (_ShowError.load()) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_ERROR, _Tag, message);
         }
     }
@@ -132,8 +124,8 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowWarn) {
+        if (_ShowWarn.load()) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_WARNING, _Tag, message);
         }
     }
@@ -146,8 +138,8 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowInfo) {
+        if (_ShowInfo.load()) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_INFO, _Tag, message);
         }
     }
@@ -160,8 +152,8 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowDebug) {
+        if (_ShowDebug.load()) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_DEBUG, _Tag, message);
         }
     }
@@ -169,10 +161,10 @@ namespace carto {
     Log::Log() {
     }
 
-    bool Log::_ShowError = true;
-    bool Log::_ShowWarn = true;
-    bool Log::_ShowInfo = true;
-    bool Log::_ShowDebug = false;
+    std::atomic<bool> Log::_ShowError(true);
+    std::atomic<bool> Log::_ShowWarn(true);
+    std::atomic<bool> Log::_ShowInfo(true);
+    std::atomic<bool> Log::_ShowDebug(false);
 
     std::string Log::_Tag = "carto-mobile-sdk";
 
@@ -9,6 +9,7 @@
 
 #include "components/DirectorPtr.h"
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <memory>
@@ -147,10 +148,10 @@ namespace carto {
     private:
         Log();
 
-        static bool _ShowError;
-        static bool _ShowWarn;
-        static bool _ShowInfo;
-        static bool _ShowDebug;
+        static std::atomic<bool> _ShowError;
+        static std::atomic<bool> _ShowWarn;
+        static std::atomic<bool> _ShowInfo;
+        static std::atomic<bool> _ShowDebug;
 
         static std::string _Tag;
 
@@ -0,0 +1,211 @@
+#include "MemoryBudgetManager.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+    const char* CATEGORY_NAMES[] = {
+        "visible",
+        "preloading",
+        "general"
+    };
+
+}
+
+namespace carto {
+
+    std::size_t MemoryBudgetManager::GetMemoryBudget() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        return _MemoryBudget;
+    }
+
+    void MemoryBudgetManager::SetMemoryBudget(std::size_t budgetInBytes) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if (budgetInBytes == _MemoryBudget) {
+            return;
+        }
+        _MemoryBudget = budgetInBytes;
+        Rebalance();
+    }
+
+    void MemoryBudgetManager::HandleMemoryPressure() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _MemoryPressure = true;
+        _MemoryPressureTime = std::chrono::steady_clock::now();
+        Rebalance();
+
+        std::size_t totalSize = 0;
+        for (CacheRegistration* registration : _Registrations) {
+            totalSize += registration->_sizeFunc();
+        }
+        Log::Infof("MemoryBudgetManager::HandleMemoryPressure: Resident cache size after eviction %d KB", static_cast<int>(totalSize / 1024));
+    }
+
+    std::string MemoryBudgetManager::GetStatisticsJSON() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        std::stringstream ss;
+        std::size_t totalSize = 0;
+        ss << "{\"caches\":[";
+        for (std::size_t i = 0; i < _Registrations.size(); i++) {
+            const CacheRegistration* registration = _Registrations[i];
+            std::size_t size = registration->_sizeFunc();
+            totalSize += size;
+            ss << (i > 0 ? "," : "");
+            ss << "{\"name\":\"" << registration->_name << "\"";
+            ss << ",\"category\":\"" << CATEGORY_NAMES[registration->_category] << "\"";
+            ss << ",\"resident\":" << size;
+            ss << ",\"capacity\":" << registration->_capacity;
+            ss << ",\"requestedCapacity\":" << registration->_requestedCapacity.load();
+            ss << ",\"hitValue\":" << registration->_hitValue;
+            ss << "}";
+        }
+        ss << "],\"budget\":" << _MemoryBudget;
+        ss << ",\"resident\":" << totalSize;
+        ss << ",\"memoryPressure\":" << (_MemoryPressure ? "true" : "false");
+        ss << "}";
+        return ss.str();
+    }
+
+    MemoryBudgetManager::CacheRegistration::CacheRegistration(const std::string& name, CacheCategory::CacheCategory category, std::size_t capacity, const std::function<std::size_t()>& sizeFunc, const std::function<void(std::size_t)>& resizeFunc) :
+        _name(name),
+        _category(category),
+        _requestedCapacity(capacity),
+        _capacity(capacity),
+        _hits(0),
+        _hitValue(0),
+        _sizeFunc(sizeFunc),
+        _resizeFunc(resizeFunc)
+    {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _Registrations.push_back(this);
+        _Dirty = true;
+    }
+
+    MemoryBudgetManager::CacheRegistration::~CacheRegistration() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _Registrations.erase(std::remove(_Registrations.begin(), _Registrations.end(), this), _Registrations.end());
+        _Dirty = true;
+    }
+
+    std::size_t MemoryBudgetManager::CacheRegistration::getRequestedCapacity() const {
+        return _requestedCapacity.load();
+    }
+
+    void MemoryBudgetManager::CacheRegistration::setRequestedCapacity(std::size_t capacity) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if (capacity == _requestedCapacity.load()) {
+            return;
+        }
+        _requestedCapacity.store(capacity);
+        Rebalance();
+    }
+
+    void MemoryBudgetManager::Update() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (_Dirty || now - _LastRebalanceTime >= REBALANCE_INTERVAL) {
+            Rebalance();
+        }
+    }
+
+    MemoryBudgetManager::MemoryBudgetManager() {
+    }
+
+    void MemoryBudgetManager::Rebalance() {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (_MemoryPressure && now - _MemoryPressureTime >= MEMORY_PRESSURE_DURATION) {
+            _MemoryPressure = false;
+        }
+        _LastRebalanceTime = now;
+        _Dirty = false;
+
+        // Update hit values. Use exponential decay, so that recent hits have larger weight
+        for (CacheRegistration* registration : _Registrations) {
+            registration->_hitValue = registration->_hitValue * HIT_VALUE_DECAY + static_cast<float>(registration->_hits.exchange(0, std::memory_order_relaxed));
+        }
+
+        // Visible caches are counted against the budget but not resized. Under memory pressure, preloading caches get nothing.
+        std::size_t budget = _MemoryPressure ? _MemoryBudget / 2 : _MemoryBudget;
+        std::size_t availableSize = budget;
+        std::vector<CacheRegistration*> registrations;
+        std::vector<std::size_t> capacities;
+        for (CacheRegistration* registration : _Registrations) {
+            if (registration->_category == CacheCategory::CACHE_CATEGORY_VISIBLE) {
+                availableSize -= std::min(availableSize, registration->_sizeFunc());
+            } else if (registration->_category == CacheCategory::CACHE_CATEGORY_PRELOADING && _MemoryPressure) {
+                registrations.push_back(registration);
+                capacities.push_back(0);
+            } else {
+                registrations.push_back(registration);
+                capacities.push_back(registration->_requestedCapacity.load());
+            }
+        }
+
+        if (budget > 0) {
+            // Give each cache a minimum share first, so that caches without recent hits are not starved completely
+            std::size_t minCapacity = registrations.empty() ? 0 : static_cast<std::size_t>(availableSize * MIN_CAPACITY_SHARE / registrations.size());
+            std::vector<std::size_t> requestedCapacities(capacities);
+            for (std::size_t i = 0; i < capacities.size(); i++) {
+                capacities[i] = std::min(requestedCapacities[i], minCapacity);
+                availableSize -= capacities[i];
+            }
+
+            // Distribute the rest proportionally to hit values. Repeat, as some caches may reach their configured capacities.
+            for (int iter = 0; iter < MAX_REBALANCE_ITERATIONS && availableSize > 0; iter++) {
+                float totalWeight = 0;
+                for (std::size_t i = 0; i < capacities.size(); i++) {
+                    if (capacities[i] < requestedCapacities[i]) {
+                        totalWeight += registrations[i]->_hitValue + 1.0f;
+                    }
+                }
+                if (totalWeight <= 0) {
+                    break;
+                }
+
+                std::size_t distributedSize = 0;
+                for (std::size_t i = 0; i < capacities.size(); i++) {
+                    if (capacities[i] < requestedCapacities[i]) {
+                        float share = (registrations[i]->_hitValue + 1.0f) / totalWeight;
+                        std::size_t extraCapacity = std::min(requestedCapacities[i] - capacities[i], static_cast<std::size_t>(availableSize * share));
+                        capacities[i] += extraCapacity;
+                        distributedSize += extraCapacity;
+                    }
+                }
+                if (distributedSize == 0) {
+                    break;
+                }
+                availableSize -= distributedSize;
+            }
+        }
+
+        for (std::size_t i = 0; i < registrations.size(); i++) {
+            CacheRegistration* registration = registrations[i];
+            if (registration->_capacity != capacities[i]) {
+                registration->_capacity = capacities[i];
+                registration->_resizeFunc(capacities[i]);
+            }
+        }
+    }
+
+    const std::chrono::milliseconds MemoryBudgetManager::REBALANCE_INTERVAL = std::chrono::milliseconds(1000);
+    const std::chrono::milliseconds MemoryBudgetManager::MEMORY_PRESSURE_DURATION = std::chrono::milliseconds(10000);
+    const float MemoryBudgetManager::MIN_CAPACITY_SHARE = 0.25f;
+    const float MemoryBudgetManager::HIT_VALUE_DECAY = 0.5f;
+
+    std::size_t MemoryBudgetManager::_MemoryBudget = DEFAULT_MEMORY_BUDGET;
+
+    bool MemoryBudgetManager::_Dirty = false;
+
+    bool MemoryBudgetManager::_MemoryPressure = false;
+
+    std::chrono::steady_clock::time_point MemoryBudgetManager::_LastRebalanceTime;
+
+    std::chrono::steady_clock::time_point MemoryBudgetManager::_MemoryPressureTime;
+
+    std::vector<MemoryBudgetManager::CacheRegistration*> MemoryBudgetManager::_Registrations;
+
+    std::mutex MemoryBudgetManager::_Mutex;
+
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_MEMORYBUDGETMANAGER_H_
+#define _CARTO_MEMORYBUDGETMANAGER_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace carto {
+
+#ifndef SWIG
+    namespace CacheCategory {
+        /**
+         * Categories of in-memory caches managed by the memory budget manager.
+         */
+        enum CacheCategory {
+            /**
+             * Cache of currently visible content. Counted against the budget, but never resized.
+             */
+            CACHE_CATEGORY_VISIBLE,
+            /**
+             * Cache of preloaded content. Evicted first under memory pressure.
+             */
+            CACHE_CATEGORY_PRELOADING,
+            /**
+             * General cache (data source caches, texture caches).
+             */
+            CACHE_CATEGORY_GENERAL
+        };
+    }
+#endif
+
+    /**
+     * A process-wide memory budget for in-memory tile, texture and style caches.
+     * The capacity configured for each cache acts as an upper limit, the actual capacities
+     * are rebalanced periodically so that the total stays within the budget. Caches with more recent hits get larger share of the budget.
+     */
+    class MemoryBudgetManager {
+    public:
+        /**
+         * Returns the total memory budget for all registered caches.
+         * @return The memory budget in bytes. 0 means that the budget is not limited.
+         */
+        static std::size_t GetMemoryBudget();
+        /**
+         * Sets the total memory budget for all registered caches. The default is 256MB.
+         * @param budgetInBytes The new memory budget in bytes. 0 means that the budget is not limited and each cache uses its configured capacity.
+         */
+        static void SetMemoryBudget(std::size_t budgetInBytes);
+
+        /**
+         * Releases cache memory. This should be called when the operating system reports low memory condition.
+         * Preloading caches are evicted first, the budget is temporarily halved and the rest of the caches are shrunk accordingly.
+         */
+        static void HandleMemoryPressure();
+
+        /**
+         * Returns per-cache residency statistics as a JSON string. For each cache, the name, category,
+         * resident size, current capacity, configured capacity and recent hit value are given.
+         * @return The statistics as a JSON string.
+         */
+        static std::string GetStatisticsJSON();
+
+#ifndef SWIG
+        /**
+         * Registration of a single cache. The registration is active during the lifetime of the object,
+         * so it should be declared after the cache and the mutex that the callbacks use.
+         * The callbacks are called with the manager lock held and must not call the manager.
+         */
+        class CacheRegistration {
+        public:
+            CacheRegistration(const std::string& name, CacheCategory::CacheCategory category, std::size_t capacity, const std::function<std::size_t()>& sizeFunc, const std::function<void(std::size_t)>& resizeFunc);
+            ~CacheRegistration();
+
+            std::size_t getRequestedCapacity() const;
+            // Must not be called while holding the lock used by the callbacks, as the caches are rebalanced synchronously
+            void setRequestedCapacity(std::size_t capacity);
+
+            void recordHit() { _hits.fetch_add(1, std::memory_order_relaxed); }
+
+        private:
+            friend class MemoryBudgetManager;
+
+            CacheRegistration(const CacheRegistration&);
+            CacheRegistration& operator = (const CacheRegistration&);
+
+            const std::string _name;
+            const CacheCategory::CacheCategory _category;
+            std::atomic<std::size_t> _requestedCapacity;
+            std::size_t _capacity;
+            std::atomic<long long> _hits;
+            float _hitValue;
+            const std::function<std::size_t()> _sizeFunc;
+            const std::function<void(std::size_t)> _resizeFunc;
+        };
+
+        /**
+         * Rebalances the caches, if needed. Called by the renderer once per frame.
+         */
+        static void Update();
+#endif
+
+    private:
+        MemoryBudgetManager();
+
+#ifndef SWIG
+        static const std::size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+        static const int MAX_REBALANCE_ITERATIONS = 8;
+        static const std::chrono::milliseconds REBALANCE_INTERVAL;
+        static const std::chrono::milliseconds MEMORY_PRESSURE_DURATION;
+        static const float MIN_CAPACITY_SHARE;
+        static const float HIT_VALUE_DECAY;
+
+        static void Rebalance();
+
+        static std::size_t _MemoryBudget;
+        static bool _Dirty;
+        static bool _MemoryPressure;
+        static std::chrono::steady_clock::time_point _LastRebalanceTime;
+        static std::chrono::steady_clock::time_point _MemoryPressureTime;
+
+        static std::vector<CacheRegistration*> _Registrations;
+
+        static std::mutex _Mutex;
+#endif
+    };
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+#include "Tracer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+namespace {
+
+    const char* STAGE_NAMES[carto::TraceStage::TRACE_STAGE_COUNT] = {
+        "TileLayer::loadData",
+        "TileDataSource::loadTile",
+        "VectorTileDecoder::decodeTile",
+        "UTFGridTile::getDecodedGrid",
+        "TileRenderer::refreshTiles",
+        "TileRenderer::onDrawFrame",
+        "MapRenderer::onDrawFrame"
+    };
+
+}
+
+namespace carto {
+
+    bool Tracer::IsEnabled() {
+        return _Enabled.load(std::memory_order_relaxed);
+    }
+
+    void Tracer::SetEnabled(bool enabled) {
+        _Enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    void Tracer::Reset() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        for (StageStatistics& stats : _StageStatistics) {
+            stats.count.store(0, std::memory_order_relaxed);
+            stats.totalDuration.store(0, std::memory_order_relaxed);
+            stats.maxDuration.store(0, std::memory_order_relaxed);
+            for (std::atomic<long long>& bucket : stats.buckets) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+        // Buffers are owned by the writer threads, so only mark the current position as the start
+        for (const std::shared_ptr<ThreadBuffer>& buffer : _ThreadBuffers) {
+            buffer->readStart.store(buffer->writeCount.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+    }
+
+    std::string Tracer::GetChromeTraceJSON() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        std::stringstream ss;
+        ss << "{\"traceEvents\":[";
+        bool first = true;
+        for (const std::shared_ptr<ThreadBuffer>& buffer : _ThreadBuffers) {
+            unsigned long long endIndex = buffer->writeCount.load(std::memory_order_acquire);
+            unsigned long long startIndex = std::max(buffer->readStart.load(std::memory_order_relaxed), endIndex > static_cast<unsigned long long>(EVENT_BUFFER_SIZE) ? endIndex - EVENT_BUFFER_SIZE : 0ULL);
+
+            std::vector<std::array<long long, 3> > events;
+            events.reserve(static_cast<std::size_t>(endIndex - startIndex));
+            for (unsigned long long index = startIndex; index < endIndex; index++) {
+                const Event& event = buffer->events[index % EVENT_BUFFER_SIZE];
+                events.push_back(std::array<long long, 3> {{ event.stage.load(std::memory_order_relaxed), event.startTime.load(std::memory_order_relaxed), event.duration.load(std::memory_order_relaxed) }});
+            }
+
+            // The writer may have wrapped around while copying, skip the events that could have been overwritten
+            unsigned long long writeCount = buffer->writeCount.load(std::memory_order_acquire);
+            std::size_t skipCount = 0;
+            if (writeCount + 1 > startIndex + EVENT_BUFFER_SIZE) {
+                skipCount = static_cast<std::size_t>(std::min(writeCount + 1 - EVENT_BUFFER_SIZE - startIndex, endIndex - startIndex));
+            }
+
+            for (std::size_t i = skipCount; i < events.size(); i++) {
+                const std::array<long long, 3>& event = events[i];
+                if (event[0] < 0 || event[0] >= TraceStage::TRACE_STAGE_COUNT) {
+                    continue;
+                }
+                ss << (first ? "" : ",");
+                ss << "{\"name\":\"" << STAGE_NAMES[event[0]] << "\",\"cat\":\"carto\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadIndex;
+                ss << ",\"ts\":" << event[1] << ",\"dur\":" << event[2] << "}";
+                first = false;
+            }
+        }
+        ss << "]}";
+        return ss.str();
+    }
+
+    std::string Tracer::GetStatisticsJSON() {
+        std::stringstream ss;
+        ss << "{";
+        for (int stage = 0; stage < TraceStage::TRACE_STAGE_COUNT; stage++) {
+            const StageStatistics& stats = _StageStatistics[stage];
+            ss << (stage > 0 ? "," : "");
+            ss << "\"" << STAGE_NAMES[stage] << "\":{";
+            ss << "\"count\":" << stats.count.load(std::memory_order_relaxed);
+            ss << ",\"total\":" << stats.totalDuration.load(std::memory_order_relaxed);
+            ss << ",\"max\":" << stats.maxDuration.load(std::memory_order_relaxed);
+            ss << ",\"p50\":" << GetLatencyPercentile(static_cast<TraceStage::TraceStage>(stage), 50);
+            ss << ",\"p90\":" << GetLatencyPercentile(static_cast<TraceStage::TraceStage>(stage), 90);
+            ss << ",\"p99\":" << GetLatencyPercentile(static_cast<TraceStage::TraceStage>(stage), 99);
+            ss << "}";
+        }
+        ss << "}";
+        return ss.str();
+    }
+
+    long long Tracer::GetEventCount(TraceStage::TraceStage stage) {
+        return _StageStatistics[stage].count.load(std::memory_order_relaxed);
+    }
+
+    long long Tracer::GetLatencyPercentile(TraceStage::TraceStage stage, double percentile) {
+        const StageStatistics& stats = _StageStatistics[stage];
+        std::vector<long long> buckets(HISTOGRAM_BUCKETS);
+        long long count = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            buckets[i] = stats.buckets[i].load(std::memory_order_relaxed);
+            count += buckets[i];
+        }
+        if (count == 0) {
+            return 0;
+        }
+
+        long long rank = static_cast<long long>(std::ceil(std::min(100.0, std::max(0.0, percentile)) / 100.0 * count));
+        long long total = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            total += buckets[i];
+            if (total >= std::max(rank, 1LL)) {
+                return std::min(GetHistogramBucketValue(i), stats.maxDuration.load(std::memory_order_relaxed));
+            }
+        }
+        return stats.maxDuration.load(std::memory_order_relaxed);
+    }
+
+    long long Tracer::GetTimestamp() {
+        static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    void Tracer::RecordSpan(TraceStage::TraceStage stage, long long startTime, long long endTime) {
+        long long duration = std::max(0LL, endTime - startTime);
+
+        StageStatistics& stats = _StageStatistics[stage];
+        stats.count.fetch_add(1, std::memory_order_relaxed);
+        stats.totalDuration.fetch_add(duration, std::memory_order_relaxed);
+        long long maxDuration = stats.maxDuration.load(std::memory_order_relaxed);
+        while (duration > maxDuration && !stats.maxDuration.compare_exchange_weak(maxDuration, duration, std::memory_order_relaxed)) {
+        }
+        stats.buckets[GetHistogramBucket(duration)].fetch_add(1, std::memory_order_relaxed);
+
+        // Each buffer has a single writer, so the slot can be filled before publishing the new count
+        ThreadBuffer& buffer = GetThreadBuffer();
+        unsigned long long index = buffer.writeCount.load(std::memory_order_relaxed);
+        Event& event = buffer.events[index % EVENT_BUFFER_SIZE];
+        event.stage.store(stage, std::memory_order_relaxed);
+        event.startTime.store(startTime, std::memory_order_relaxed);
+        event.duration.store(duration, std::memory_order_relaxed);
+        buffer.writeCount.store(index + 1, std::memory_order_release);
+    }
+
+    struct Tracer::ThreadBufferSlot {
+        // thread_local is not available for all supported targets (iOS 7), so use the platform TLS API.
+        // The slot destructor releases the buffer of an exiting thread, so that the buffer can be reused.
+        ThreadBufferSlot() {
+#ifdef _WIN32
+            _index = FlsAlloc(ReleaseFlsBuffer);
+#else
+            pthread_key_create(&_key, ReleaseBuffer);
+#endif
+        }
+
+        ThreadBuffer* get() const {
+#ifdef _WIN32
+            return static_cast<ThreadBuffer*>(FlsGetValue(_index));
+#else
+            return static_cast<ThreadBuffer*>(pthread_getspecific(_key));
+#endif
+        }
+
+        void set(ThreadBuffer* buffer) const {
+#ifdef _WIN32
+            FlsSetValue(_index, buffer);
+#else
+            pthread_setspecific(_key, buffer);
+#endif
+        }
+
+    private:
+        static void ReleaseBuffer(void* buffer) {
+            if (buffer) {
+                static_cast<ThreadBuffer*>(buffer)->owned.store(false, std::memory_order_release);
+            }
+        }
+
+#ifdef _WIN32
+        static void WINAPI ReleaseFlsBuffer(void* buffer) {
+            ReleaseBuffer(buffer);
+        }
+
+        DWORD _index;
+#else
+        pthread_key_t _key;
+#endif
+    };
+
+    Tracer::ThreadBuffer& Tracer::GetThreadBuffer() {
+        static const ThreadBufferSlot slot;
+        if (ThreadBuffer* threadBuffer = slot.get()) {
+            return *threadBuffer;
+        }
+
+        // First event of this thread. Reuse a buffer of an exited thread if possible, its remaining events are dropped.
+        std::lock_guard<std::mutex> lock(_Mutex);
+        ThreadBuffer* threadBuffer = nullptr;
+        for (const std::shared_ptr<ThreadBuffer>& buffer : _ThreadBuffers) {
+            if (!buffer->owned.load(std::memory_order_acquire)) {
+                threadBuffer = buffer.get();
+                threadBuffer->owned.store(true, std::memory_order_relaxed);
+                threadBuffer->threadIndex = ++_ThreadBufferCounter;
+                threadBuffer->readStart.store(threadBuffer->writeCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                break;
+            }
+        }
+        if (!threadBuffer) {
+            auto buffer = std::make_shared<ThreadBuffer>(++_ThreadBufferCounter);
+            _ThreadBuffers.push_back(buffer);
+            threadBuffer = buffer.get();
+        }
+        slot.set(threadBuffer);
+        return *threadBuffer;
+    }
+
+    int Tracer::GetHistogramBucket(long long duration) {
+        // Log-linear buckets: exact values below HISTOGRAM_SUB_BUCKETS, then HISTOGRAM_SUB_BUCKETS linear steps per power of two
+        if (duration < HISTOGRAM_SUB_BUCKETS) {
+            return static_cast<int>(duration);
+        }
+        int exponent = 0;
+        for (long long value = duration; value > 1 && exponent < HISTOGRAM_MAX_EXPONENT; value >>= 1) {
+            exponent++;
+        }
+        long long subBucket = std::min((duration >> (exponent - HISTOGRAM_SUB_BUCKET_BITS)) - HISTOGRAM_SUB_BUCKETS, static_cast<long long>(HISTOGRAM_SUB_BUCKETS - 1));
+        return HISTOGRAM_SUB_BUCKETS + (exponent - HISTOGRAM_SUB_BUCKET_BITS) * HISTOGRAM_SUB_BUCKETS + static_cast<int>(subBucket);
+    }
+
+    long long Tracer::GetHistogramBucketValue(int bucket) {
+        // Returns the upper bound of the bucket
+        if (bucket < HISTOGRAM_SUB_BUCKETS) {
+            return bucket;
+        }
+        int exponent = (bucket - HISTOGRAM_SUB_BUCKETS) / HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKET_BITS;
+        long long subBucket = (bucket - HISTOGRAM_SUB_BUCKETS) % HISTOGRAM_SUB_BUCKETS;
+        return ((HISTOGRAM_SUB_BUCKETS + subBucket + 1) << (exponent - HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+    }
+
+    Tracer::Tracer() {
+    }
+
+    std::atomic<bool> Tracer::_Enabled(false);
+
+    std::array<Tracer::StageStatistics, TraceStage::TRACE_STAGE_COUNT> Tracer::_StageStatistics;
+
+    std::vector<std::shared_ptr<Tracer::ThreadBuffer> > Tracer::_ThreadBuffers;
+
+    int Tracer::_ThreadBufferCounter = 0;
+
+    std::mutex Tracer::_Mutex;
+
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_TRACER_H_
+#define _CARTO_TRACER_H_
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace carto {
+
+#ifndef SWIG
+    namespace TraceStage {
+        /**
+         * Traced stages of the tile pipeline.
+         */
+        enum TraceStage {
+            TRACE_STAGE_TILE_LAYER_LOAD_DATA,
+            TRACE_STAGE_TILE_DATA_SOURCE_LOAD_TILE,
+            TRACE_STAGE_VECTOR_TILE_DECODE,
+            TRACE_STAGE_UTF_GRID_DECODE,
+            TRACE_STAGE_TILE_RENDERER_REFRESH,
+            TRACE_STAGE_TILE_RENDERER_DRAW_FRAME,
+            TRACE_STAGE_MAP_RENDERER_DRAW_FRAME,
+            TRACE_STAGE_COUNT
+        };
+    }
+#endif
+
+    /**
+     * A low-overhead tracer for the tile loading and rendering pipeline.
+     * When enabled, the duration of each pipeline stage is recorded into per-thread ring buffers
+     * and into per-stage latency histograms. When disabled, the cost of a traced stage is a single atomic load.
+     */
+    class Tracer {
+    public:
+        /**
+         * Returns the state of tracing.
+         * @return True if tracing is enabled.
+         */
+        static bool IsEnabled();
+        /**
+         * Enables or disables tracing. Tracing is disabled by default.
+         * @param enabled If true, then pipeline stages are traced.
+         */
+        static void SetEnabled(bool enabled);
+
+        /**
+         * Clears all recorded events and statistics.
+         */
+        static void Reset();
+
+        /**
+         * Returns the recorded events in Chrome trace event format (loadable in chrome://tracing).
+         * Only the most recent events of each thread are kept.
+         * @return The recorded events as a JSON string.
+         */
+        static std::string GetChromeTraceJSON();
+        /**
+         * Returns per-stage statistics as a JSON string. For each stage, event count, total and maximum durations
+         * and latency percentiles are given. All durations are in microseconds.
+         * @return The statistics as a JSON string.
+         */
+        static std::string GetStatisticsJSON();
+
+#ifndef SWIG
+        /**
+         * Returns the number of recorded events for the given stage.
+         * @param stage The stage to query.
+         * @return The number of recorded events.
+         */
+        static long long GetEventCount(TraceStage::TraceStage stage);
+        /**
+         * Returns the approximate latency percentile for the given stage.
+         * @param stage The stage to query.
+         * @param percentile The percentile in range 0..100.
+         * @return The approximate latency in microseconds.
+         */
+        static long long GetLatencyPercentile(TraceStage::TraceStage stage, double percentile);
+
+        /**
+         * Records the duration of the enclosing scope as a span of the given stage.
+         */
+        class ScopedSpan {
+        public:
+            explicit ScopedSpan(TraceStage::TraceStage stage) : _stage(stage), _startTime(IsEnabled() ? GetTimestamp() : -1) { }
+            ~ScopedSpan() {
+                if (_startTime >= 0) {
+                    RecordSpan(_stage, _startTime, GetTimestamp());
+                }
+            }
+
+        private:
+            ScopedSpan(const ScopedSpan&);
+            ScopedSpan& operator = (const ScopedSpan&);
+
+            TraceStage::TraceStage _stage;
+            long long _startTime;
+        };
+
+        static long long GetTimestamp();
+        static void RecordSpan(TraceStage::TraceStage stage, long long startTime, long long endTime);
+#endif
+
+    private:
+        Tracer();
+
+#ifndef SWIG
+        static const int EVENT_BUFFER_SIZE = 4096;
+        static const int HISTOGRAM_SUB_BUCKET_BITS = 4;
+        static const int HISTOGRAM_SUB_BUCKETS = 1 << HISTOGRAM_SUB_BUCKET_BITS;
+        static const int HISTOGRAM_MAX_EXPONENT = 40;
+        static const int HISTOGRAM_BUCKETS = HISTOGRAM_SUB_BUCKETS * (HISTOGRAM_MAX_EXPONENT - HISTOGRAM_SUB_BUCKET_BITS + 2);
+
+        struct Event {
+            std::atomic<int> stage;
+            std::atomic<long long> startTime;
+            std::atomic<long long> duration;
+        };
+
+        struct ThreadBuffer {
+            int threadIndex;
+            std::atomic<bool> owned; // false once the writer thread has exited, the buffer can then be given to a new thread
+            std::atomic<unsigned long long> writeCount;
+            std::atomic<unsigned long long> readStart;
+            std::array<Event, EVENT_BUFFER_SIZE> events;
+
+            explicit ThreadBuffer(int threadIndex) : threadIndex(threadIndex), owned(true), writeCount(0), readStart(0), events() { }
+        };
+
+        struct ThreadBufferSlot;
+
+        struct StageStatistics {
+            std::atomic<long long> count;
+            std::atomic<long long> totalDuration;
+            std::atomic<long long> maxDuration;
+            std::array<std::atomic<long long>, HISTOGRAM_BUCKETS> buckets;
+        };
+
+        static ThreadBuffer& GetThreadBuffer();
+
+        static int GetHistogramBucket(long long duration);
+        static long long GetHistogramBucketValue(int bucket);
+
+        static std::atomic<bool> _Enabled;
+
+        static std::array<StageStatistics, TraceStage::TRACE_STAGE_COUNT> _StageStatistics;
+
+        static std::vector<std::shared_ptr<ThreadBuffer> > _ThreadBuffers;
+        static int _ThreadBufferCounter;
+
+        static std::mutex _Mutex;
+#endif
+    };
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "core/BinaryData.h"
 #include "core/Variant.h"
 #include "components/Exceptions.h"
+#include "components/CancelableThreadPool.h"
 #include "geometry/Feature.h"
 #include "geometry/Geometry.h"
 #include "geometry/PointGeometry.h"
@@ -35,6 +36,8 @@
 #include <cartocss/CartoCSSMapLoader.h>
 
 #include <functional>
+#include <algorithm>
+#include <thread>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -51,7 +54,9 @@ namespace carto {
         _map(),
         _parameterValueMap(),
         _backgroundPattern(),
-        _symbolizerContext()
+        _symbolizerContext(),
+        _cachedFeatureDecoder(),
+        _layerBuildThreadPool(GetLayerBuildThreadPool())
     {
         if (!compiledStyleSet) {
             throw NullArgumentException("Null compiledStyleSet");
@@ -70,7 +75,9 @@ namespace carto {
         _map(),
         _parameterValueMap(),
         _backgroundPattern(),
-        _symbolizerContext()
+        _symbolizerContext(),
+        _cachedFeatureDecoder(),
+        _layerBuildThreadPool(GetLayerBuildThreadPool())
     {
         if (!cartoCSSStyleSet) {
             throw NullArgumentException("Null cartoCSSStyleSet");
@@ -375,6 +382,13 @@ namespace carto {
             
             mvt::MBVTTileReader reader(map, *symbolizerContext, decoder);
             reader.setLayerNameOverride(layerNameOverride);
+            int poolSize = _layerBuildThreadPool->getPoolSize();
+            if (poolSize > 0) {
+                std::shared_ptr<CancelableThreadPool> threadPool = _layerBuildThreadPool;
+                reader.setTaskExecutor([threadPool](std::function<void()> task) {
+                    threadPool->execute(std::make_shared<LayerBuildTask>(std::move(task)));
+                }, poolSize + 1);
+            }
 
             if (std::shared_ptr<vt::Tile> tile = reader.readTile(targetTile)) {
                 auto tileMap = std::make_shared<TileMap>();
@@ -387,6 +401,36 @@ namespace carto {
         return std::shared_ptr<TileMap>();
     }
 
+    MBVectorTileDecoder::LayerBuildTask::LayerBuildTask(std::function<void()> func) :
+        _func(std::move(func))
+    {
+    }
+
+    void MBVectorTileDecoder::LayerBuildTask::run() {
+        _func();
+    }
+
+    std::shared_ptr<CancelableThreadPool> MBVectorTileDecoder::GetLayerBuildThreadPool() {
+        // The pool is shared by all decoders, so that the number of threads does not grow with the number of layers
+        std::lock_guard<std::mutex> lock(_LayerBuildThreadPoolMutex);
+        if (!_LayerBuildThreadPool.threadPool) {
+            _LayerBuildThreadPool.threadPool = std::make_shared<CancelableThreadPool>();
+            _LayerBuildThreadPool.threadPool->setPoolSize(std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+        }
+        return _LayerBuildThreadPool.threadPool;
+    }
+
+    MBVectorTileDecoder::LayerBuildThreadPoolHolder::~LayerBuildThreadPoolHolder() {
+        // Stop the workers at exit. The threads are not joined: on Windows static destructors may run under the loader lock,
+        // where joining would deadlock. This is safe, as the workers keep the pool alive until they exit and
+        // tile readers never depend on the pool running their tasks. Decoders outliving this simply build the layers themselves.
+        std::lock_guard<std::mutex> lock(_LayerBuildThreadPoolMutex);
+        if (threadPool) {
+            threadPool->deinit();
+            threadPool.reset();
+        }
+    }
+
     void MBVectorTileDecoder::updateCurrentStyle(const boost::variant<std::shared_ptr<CompiledStyleSet>, std::shared_ptr<CartoCSSStyleSet> >& styleSet) {
         std::string styleAssetName;
         std::shared_ptr<AssetPackage> styleSetData;
@@ -497,4 +541,8 @@ namespace carto {
     const int MBVectorTileDecoder::DEFAULT_TILE_SIZE = 256;
     const int MBVectorTileDecoder::STROKEMAP_SIZE = 512;
     const int MBVectorTileDecoder::GLYPHMAP_SIZE = 2048;
+
+    std::mutex MBVectorTileDecoder::_LayerBuildThreadPoolMutex;
+
+    MBVectorTileDecoder::LayerBuildThreadPoolHolder MBVectorTileDecoder::_LayerBuildThreadPool;
 }
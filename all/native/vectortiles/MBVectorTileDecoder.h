@@ -8,12 +8,14 @@
 #define _CARTO_MBVECTORTILEDECODER_H_
 
 #include "vectortiles/VectorTileDecoder.h"
+#include "components/CancelableTask.h"
 
 #include <memory>
 #include <mutex>
 #include <map>
 #include <vector>
 #include <string>
+#include <functional>
 
 #include <boost/variant.hpp>
 
@@ -29,6 +31,7 @@ namespace carto {
 
     class CompiledStyleSet;
     class CartoCSSStyleSet;
+    class CancelableThreadPool;
     
     /**
      * Decoder for vector tiles in MapBox format.
@@ -156,8 +159,20 @@ namespace carto {
         virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData) const;
     
     protected:
+        class LayerBuildTask : public CancelableTask {
+        public:
+            explicit LayerBuildTask(std::function<void()> func);
+
+            virtual void run();
+
+        private:
+            std::function<void()> _func;
+        };
+
         void updateCurrentStyle(const boost::variant<std::shared_ptr<CompiledStyleSet>, std::shared_ptr<CartoCSSStyleSet> >& styleSet);
 
+        static std::shared_ptr<CancelableThreadPool> GetLayerBuildThreadPool();
+
         static const int DEFAULT_TILE_SIZE;
         static const int STROKEMAP_SIZE;
         static const int GLYPHMAP_SIZE;
@@ -174,8 +189,19 @@ namespace carto {
         std::shared_ptr<mvt::SymbolizerContext> _symbolizerContext;
 
         mutable std::pair<std::shared_ptr<BinaryData>, std::shared_ptr<mvt::MBVTFeatureDecoder> > _cachedFeatureDecoder;
+
+        std::shared_ptr<CancelableThreadPool> _layerBuildThreadPool;
     
         mutable std::mutex _mutex;
+
+        struct LayerBuildThreadPoolHolder {
+            std::shared_ptr<CancelableThreadPool> threadPool;
+
+            ~LayerBuildThreadPoolHolder();
+        };
+
+        static std::mutex _LayerBuildThreadPoolMutex;
+        static LayerBuildThreadPoolHolder _LayerBuildThreadPool;
     };
         
 }
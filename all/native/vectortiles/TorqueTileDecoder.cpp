@@ -15,6 +15,8 @@
 #include <mapnikvt/TorqueTileReader.h>
 #include <cartocss/TorqueCartoCSSMapLoader.h>
 
+#include <limits>
+
 #include <boost/lexical_cast.hpp>
 
 namespace carto {
@@ -95,8 +97,12 @@ namespace carto {
     }
 
     std::shared_ptr<TorqueTileDecoder::TileMap> TorqueTileDecoder::decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData) const {
+        return decodeFrames(tile, targetTile, tileData, 0, std::numeric_limits<int>::max());
+    }
+
+    std::shared_ptr<TorqueTileDecoder::TileMap> TorqueTileDecoder::decodeFrames(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData, int firstFrame, int frameCount) const {
         if (!tileData) {
-            Log::Warn("TorqueTileDecoder::decodeTile: Null tile data");
+            Log::Warn("TorqueTileDecoder::decodeFrames: Null tile data");
             return std::shared_ptr<TileMap>();
         }
         if (tileData->empty()) {
@@ -117,8 +123,18 @@ namespace carto {
             mvt::TorqueFeatureDecoder decoder(*tileData->getDataPtr(), resolution, _logger);
             decoder.setTransform(calculateTileTransform(tile, targetTile));
 
+            int animationFrameCount = map->getTorqueSettings().frameCount;
+            if (frameCount >= animationFrameCount) {
+                firstFrame = 0;
+                frameCount = animationFrameCount;
+            }
+
             auto tileMap = std::make_shared<TileMap>();
-            for (int frame = 0; frame < map->getTorqueSettings().frameCount; frame++) {
+            for (int i = 0; i < frameCount; i++) {
+                int frame = firstFrame + i;
+                if (animationFrameCount > 0) {
+                    frame = ((frame % animationFrameCount) + animationFrameCount) % animationFrameCount;
+                }
                 mvt::TorqueTileReader reader(map, frame, true, *symbolizerContext, decoder);
                 if (std::shared_ptr<vt::Tile> tile = reader.readTile(targetTile)) {
                     (*tileMap)[frame] = tile;
@@ -126,7 +142,42 @@ namespace carto {
             }
             return tileMap;
         } catch (const std::exception& ex) {
-            Log::Errorf("TorqueTileDecoder::decodeTile: Exception while decoding: %s", ex.what());
+            Log::Errorf("TorqueTileDecoder::decodeFrames: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<TileMap>();
+    }
+
+    std::shared_ptr<TorqueTileDecoder::TileMap> TorqueTileDecoder::decodeFrameFilteredTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData) const {
+        if (!tileData) {
+            Log::Warn("TorqueTileDecoder::decodeFrameFilteredTile: Null tile data");
+            return std::shared_ptr<TileMap>();
+        }
+        if (tileData->empty()) {
+            return std::shared_ptr<TileMap>();
+        }
+
+        int resolution;
+        std::shared_ptr<mvt::TorqueMap> map;
+        std::shared_ptr<mvt::SymbolizerContext> symbolizerContext;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            resolution = _resolution;
+            map = _map;
+            symbolizerContext = _symbolizerContext;
+        }
+    
+        try {
+            mvt::TorqueFeatureDecoder decoder(*tileData->getDataPtr(), resolution, _logger);
+            decoder.setTransform(calculateTileTransform(tile, targetTile));
+
+            auto tileMap = std::make_shared<TileMap>();
+            mvt::TorqueTileReader reader(map, *symbolizerContext, decoder);
+            if (std::shared_ptr<vt::Tile> tile = reader.readTile(targetTile)) {
+                (*tileMap)[0] = tile;
+            }
+            return tileMap;
+        } catch (const std::exception& ex) {
+            Log::Errorf("TorqueTileDecoder::decodeFrameFilteredTile: Exception while decoding: %s", ex.what());
         }
         return std::shared_ptr<TileMap>();
     }
@@ -79,6 +79,28 @@ namespace carto {
 
         virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData) const;
 
+#ifndef SWIG
+        /**
+         * Decodes only the given range of animation frames. Frames wrap around the frame count of the animation.
+         * @param tile The tile id of the data.
+         * @param targetTile The tile id of the decoded tile.
+         * @param tileData The tile data to decode.
+         * @param firstFrame The first frame to decode.
+         * @param frameCount The number of frames to decode. If larger than the frame count of the animation, all frames are decoded.
+         * @return The decoded frames, keyed by frame number. Null if the tile could not be decoded.
+         */
+        std::shared_ptr<TileMap> decodeFrames(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData, int firstFrame, int frameCount) const;
+        /**
+         * Decodes all animation frames into a single tile. Points are tagged with the frame they are visible in,
+         * so that the renderer can filter them by the current frame number.
+         * @param tile The tile id of the data.
+         * @param targetTile The tile id of the decoded tile.
+         * @param tileData The tile data to decode.
+         * @return The decoded tile with frame number 0 as the key. Null if the tile could not be decoded.
+         */
+        std::shared_ptr<TileMap> decodeFrameFilteredTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<BinaryData>& tileData) const;
+#endif
+
     protected:
         void updateCurrentStyle(const std::shared_ptr<CartoCSSStyleSet>& styleSet);
 
@@ -85,6 +85,7 @@
 
 #import "NTMapRenderer.h"
 #import "NTMapRendererListener.h"
+#import "NTFrameStatistics.h"
 #import "NTRendererCaptureListener.h"
 
 #import "ui/MapView.h"
@@ -97,6 +98,8 @@
 #import "NTBitmapUtils.h"
 #import "NTLog.h"
 #import "NTLogEventListener.h"
+#import "NTMemoryBudgetManager.h"
+#import "NTTracer.h"
 
 #import "NTBalloonPopup.h"
 #import "NTCustomPopup.h"
@@ -174,6 +177,7 @@
 #import "NTWKTGeometryWriter.h"
 #import "NTWKBGeometryReader.h"
 #import "NTWKBGeometryWriter.h"
+#import "NTTWKBGeometryReader.h"
 #endif
 
 #ifdef _CARTO_GDAL_SUPPORT
@@ -9,8 +9,10 @@
 
 #include "Value.h"
 
+#include <memory>
 #include <string>
 #include <algorithm>
+#include <functional>
 #include <vector>
 #include <unordered_set>
 
@@ -21,30 +23,128 @@ namespace carto { namespace mvt {
             NULL_GEOMETRY = 0, POINT_GEOMETRY = 1, LINE_GEOMETRY = 2, POLYGON_GEOMETRY = 3
         };
 
-        explicit FeatureData(GeometryType geomType, std::vector<std::pair<std::string, Value>> vars) : _geometryType(geomType), _variables(std::move(vars)) { }
+        // Immutable table of attribute names and values shared by feature data instances (typically of a single tile layer).
+        // Hashes of the entries are precalculated, so feature data hashing does not need to touch strings.
+        class Dictionary final {
+        public:
+            explicit Dictionary(std::vector<std::string> keys, std::vector<Value> values) : _keys(std::move(keys)), _values(std::move(values)), _keyHashes(), _valueHashes() {
+                _keyHashes.reserve(_keys.size());
+                for (const std::string& key : _keys) {
+                    _keyHashes.push_back(std::hash<std::string>()(key));
+                }
+                _valueHashes.reserve(_values.size());
+                for (const Value& value : _values) {
+                    _valueHashes.push_back(calculateValueHash(value));
+                }
+            }
+
+            std::size_t getKeyCount() const { return _keys.size(); }
+            std::size_t getValueCount() const { return _values.size(); }
+
+            const std::string& getKey(int index) const { return _keys[index]; }
+            const Value& getValue(int index) const { return _values[index]; }
+
+            std::size_t getKeyHash(int index) const { return _keyHashes[index]; }
+            std::size_t getValueHash(int index) const { return _valueHashes[index]; }
+
+            static std::size_t calculateValueHash(const Value& value) {
+                return boost::apply_visitor(ValueHasher(), value) + value.which();
+            }
+
+        private:
+            struct ValueHasher : boost::static_visitor<std::size_t> {
+                std::size_t operator() (boost::blank) const { return 0; }
+                std::size_t operator() (bool val) const { return std::hash<bool>()(val); }
+                std::size_t operator() (long long val) const { return std::hash<long long>()(val); }
+                std::size_t operator() (double val) const { return std::hash<double>()(val); }
+                std::size_t operator() (const std::string& str) const { return std::hash<std::string>()(str); }
+            };
+
+            std::vector<std::string> _keys;
+            std::vector<Value> _values;
+            std::vector<std::size_t> _keyHashes;
+            std::vector<std::size_t> _valueHashes;
+        };
+
+        explicit FeatureData(GeometryType geomType, std::vector<std::pair<std::string, Value>> vars) : _geometryType(geomType), _dictionary(), _variables(), _hash(0) {
+            std::vector<std::string> keys;
+            std::vector<Value> values;
+            keys.reserve(vars.size());
+            values.reserve(vars.size());
+            _variables.reserve(vars.size());
+            for (std::pair<std::string, Value>& var : vars) {
+                _variables.emplace_back(static_cast<int>(keys.size()), static_cast<int>(values.size()));
+                keys.push_back(std::move(var.first));
+                values.push_back(std::move(var.second));
+            }
+            _dictionary = std::make_shared<Dictionary>(std::move(keys), std::move(values));
+            _hash = calculateHash(_geometryType, *_dictionary, _variables);
+        }
+
+        // Variables are (key index, value index) pairs referring to the dictionary. The dictionary must not contain duplicate keys or values,
+        // this allows comparing feature data instances sharing the same dictionary by indices only.
+        explicit FeatureData(GeometryType geomType, std::shared_ptr<const Dictionary> dictionary, std::vector<std::pair<int, int>> vars) : _geometryType(geomType), _dictionary(std::move(dictionary)), _variables(std::move(vars)), _hash(0) {
+            std::sort(_variables.begin(), _variables.end());
+            _hash = calculateHash(_geometryType, *_dictionary, _variables);
+        }
 
         GeometryType getGeometryType() const { return _geometryType; }
 
         std::unordered_set<std::string> getVariableNames() const {
              std::unordered_set<std::string> names;
-             std::transform(_variables.begin(), _variables.end(), std::inserter(names, names.begin()), [](const std::pair<std::string, Value>& var) {
-                 return var.first;
+             std::transform(_variables.begin(), _variables.end(), std::inserter(names, names.begin()), [this](const std::pair<int, int>& var) {
+                 return _dictionary->getKey(var.first);
              });
              return names;
         }
 
         bool getVariable(const std::string& name, Value& value) const {
-            auto it = std::find_if(_variables.begin(), _variables.end(), [name](const std::pair<std::string, Value>& var) { return var.first == name; });
+            auto it = std::find_if(_variables.begin(), _variables.end(), [this, &name](const std::pair<int, int>& var) { return _dictionary->getKey(var.first) == name; });
             if (it == _variables.end()) {
                 return false;
             }
-            value = it->second;
+            value = _dictionary->getValue(it->second);
             return true;
         }
 
+        std::size_t getHash() const { return _hash; }
+
+        bool operator == (const FeatureData& other) const {
+            if (_hash != other._hash || _geometryType != other._geometryType || _variables.size() != other._variables.size()) {
+                return false;
+            }
+            if (_dictionary == other._dictionary) {
+                return _variables == other._variables;
+            }
+            for (const std::pair<int, int>& var : _variables) { // NOTE: variable order is not significant
+                const std::string& key = _dictionary->getKey(var.first);
+                auto it = std::find_if(other._variables.begin(), other._variables.end(), [&other, &key](const std::pair<int, int>& otherVar) { return other._dictionary->getKey(otherVar.first) == key; });
+                if (it == other._variables.end() || !(other._dictionary->getValue(it->second) == _dictionary->getValue(var.second))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool operator != (const FeatureData& other) const {
+            return !(*this == other);
+        }
+
     private:
+        static std::size_t calculateHash(GeometryType geomType, const Dictionary& dictionary, const std::vector<std::pair<int, int>>& vars) {
+            std::size_t hash = static_cast<std::size_t>(geomType);
+            for (const std::pair<int, int>& var : vars) {
+                std::size_t nameHash = dictionary.getKeyHash(var.first);
+                std::size_t valueHash = dictionary.getValueHash(var.second);
+                hash += nameHash ^ (valueHash + 0x9e3779b9 + (nameHash << 6) + (nameHash >> 2)); // order independent combination
+            }
+            return hash;
+        }
+
         GeometryType _geometryType;
-        std::vector<std::pair<std::string, Value>> _variables;
+        std::shared_ptr<const Dictionary> _dictionary;
+        std::vector<std::pair<int, int>> _variables;
+        std::size_t _hash;
     };
 } }
 
@@ -21,8 +21,8 @@
 namespace carto { namespace mvt {
     class MBVTFeatureDecoder::MBVTFeatureIterator : public carto::mvt::FeatureDecoder::FeatureIterator {
     public:
-        explicit MBVTFeatureIterator(const vector_tile::Tile& tile, const vector_tile::Tile::Layer& layer, const std::unordered_set<std::string>* fields, const cglib::mat3x3<float>& transform, const cglib::bbox2<float>& clipBox, float buffer, bool globalIdOverride, long tileIdOffset, std::map<std::vector<int>, std::shared_ptr<FeatureData>>& featureDataCache) :
-            _tile(tile), _layer(layer), _transform(transform), _clipBox(clipBox), _buffer(buffer), _globalIdOverride(globalIdOverride), _tileIdOffset(tileIdOffset), _featureDataCache(featureDataCache)
+        explicit MBVTFeatureIterator(const vector_tile::Tile& tile, const vector_tile::Tile::Layer& layer, const std::unordered_set<std::string>* fields, const cglib::mat3x3<float>& transform, const cglib::bbox2<float>& clipBox, float buffer, bool globalIdOverride, long tileIdOffset, std::shared_ptr<FeatureDataCache> featureDataCache) :
+            _tile(tile), _layer(layer), _transform(transform), _clipBox(clipBox), _buffer(buffer), _globalIdOverride(globalIdOverride), _tileIdOffset(tileIdOffset), _featureDataCache(std::move(featureDataCache))
         {
             for (int i = 0; i < tile.layers_size(); i++) {
                 if (&tile.layers(i) == &layer) {
@@ -104,27 +104,33 @@ namespace carto { namespace mvt {
             for (int i = 0; i + 1 < feature.tags_size(); i += 2) {
                 auto it = std::find(_fieldKeys.begin(), _fieldKeys.end(), feature.tags(i));
                 if (it != _fieldKeys.end()) {
-                    tags[it - _fieldKeys.begin()] = feature.tags(i + 1);
+                    int valueIdx = feature.tags(i + 1);
+                    if (valueIdx >= 0 && valueIdx < _layer.values_size()) {
+                        tags[it - _fieldKeys.begin()] = _featureDataCache->valueIndices[valueIdx];
+                    }
                 }
             }
 
-            auto it = _featureDataCache.find(tags);
-            if (it != _featureDataCache.end()) {
-                return it->second;
+            {
+                std::lock_guard<std::mutex> lock(_featureDataCache->mutex);
+                auto it = _featureDataCache->featureDataMap.find(tags);
+                if (it != _featureDataCache->featureDataMap.end()) {
+                    return it->second;
+                }
             }
 
             FeatureData::GeometryType geomType = convertGeometryType(feature.type());
-            std::vector<std::pair<std::string, Value>> dataMap;
-            dataMap.reserve(tags.size());
+            std::vector<std::pair<int, int>> vars;
+            vars.reserve(tags.size());
             for (std::size_t i = 0; i < _fieldKeys.size(); i++) {
-                if (tags[i] >= 0 && tags[i] < _layer.values_size()) {
-                    dataMap.emplace_back(_layer.keys(_fieldKeys[i]), convertValue(_layer.values(tags[i])));
+                if (tags[i] >= 0) {
+                    vars.emplace_back(_featureDataCache->keyIndices[_fieldKeys[i]], tags[i]);
                 }
             }
 
-            auto featureData = std::make_shared<FeatureData>(geomType, std::move(dataMap));
-            _featureDataCache.emplace(std::move(tags), featureData);
-            return featureData;
+            auto featureData = std::make_shared<FeatureData>(geomType, _featureDataCache->dictionary, std::move(vars));
+            std::lock_guard<std::mutex> lock(_featureDataCache->mutex);
+            return _featureDataCache->featureDataMap.emplace(std::move(tags), featureData).first->second;
         }
 
         virtual std::shared_ptr<const Geometry> getGeometry() const override {
@@ -173,6 +179,46 @@ namespace carto { namespace mvt {
             }
         }
 
+        static std::shared_ptr<FeatureDataCache> createFeatureDataCache(const vector_tile::Tile::Layer& layer) {
+            auto featureDataCache = std::make_shared<FeatureDataCache>();
+
+            std::vector<std::string> keys;
+            std::unordered_map<std::string, int> keyIndexMap;
+            featureDataCache->keyIndices.reserve(layer.keys_size());
+            for (int i = 0; i < layer.keys_size(); i++) {
+                auto it = keyIndexMap.emplace(layer.keys(i), static_cast<int>(keys.size()));
+                if (it.second) {
+                    keys.push_back(layer.keys(i));
+                }
+                featureDataCache->keyIndices.push_back(it.first->second);
+            }
+
+            std::vector<Value> values;
+            std::unordered_multimap<std::size_t, int> valueIndexMap;
+            featureDataCache->valueIndices.reserve(layer.values_size());
+            for (int i = 0; i < layer.values_size(); i++) {
+                Value value = convertValue(layer.values(i));
+                std::size_t hash = FeatureData::Dictionary::calculateValueHash(value);
+                int index = -1;
+                auto range = valueIndexMap.equal_range(hash);
+                for (auto it = range.first; it != range.second; it++) {
+                    if (values[it->second] == value) {
+                        index = it->second;
+                        break;
+                    }
+                }
+                if (index < 0) {
+                    index = static_cast<int>(values.size());
+                    values.push_back(std::move(value));
+                    valueIndexMap.emplace(hash, index);
+                }
+                featureDataCache->valueIndices.push_back(index);
+            }
+
+            featureDataCache->dictionary = std::make_shared<FeatureData::Dictionary>(std::move(keys), std::move(values));
+            return featureDataCache;
+        }
+
     private:
         static FeatureData::GeometryType convertGeometryType(vector_tile::Tile::GeomType geomType) {
             switch (geomType) {
@@ -308,7 +354,7 @@ namespace carto { namespace mvt {
         const float _buffer;
         const bool _globalIdOverride;
         const long long _tileIdOffset;
-        std::map<std::vector<int>, std::shared_ptr<FeatureData>>& _featureDataCache;
+        const std::shared_ptr<FeatureDataCache> _featureDataCache;
 
         static std::atomic<long long> _idCounter;
     };
@@ -358,8 +404,12 @@ namespace carto { namespace mvt {
 
     std::shared_ptr<Feature> MBVTFeatureDecoder::getFeature(long long localId, std::string& layerName) const {
         for (int i = 0; i < _tile->layers_size(); i++) {
-            std::map<std::vector<int>, std::shared_ptr<FeatureData>> featureDataCache;
-            MBVTFeatureIterator it(*_tile, _tile->layers(i), nullptr, _transform, _clipBox, _buffer, _globalIdOverride, _tileIdOffset, featureDataCache);
+            const vector_tile::Tile::Layer& layer = _tile->layers(i);
+            long long layerIndexOffset = static_cast<long long>(i) << 32;
+            if (localId < layerIndexOffset || localId >= layerIndexOffset + layer.features_size()) {
+                continue;
+            }
+            MBVTFeatureIterator it(*_tile, layer, nullptr, _transform, _clipBox, _buffer, _globalIdOverride, _tileIdOffset, getFeatureDataCache(i));
             if (it.findByLocalId(localId)) {
                  layerName = _tile->layers(i).name();
                  return std::make_shared<Feature>(it.getGlobalId(), it.getGeometry(), it.getFeatureData());
@@ -373,11 +423,16 @@ namespace carto { namespace mvt {
         if (layerIt == _layerMap.end()) {
             return std::shared_ptr<FeatureIterator>();
         }
-        if (_layerFeatureDataCache.find(name) == _layerFeatureDataCache.end()) { // flush the cache if previous layer was different
-            _layerFeatureDataCache.clear();
-        }
         const vector_tile::Tile::Layer& layer = _tile->layers(layerIt->second);
-        std::map<std::vector<int>, std::shared_ptr<FeatureData>>& featureDataCache = _layerFeatureDataCache[name];
-        return std::make_shared<MBVTFeatureIterator>(*_tile, layer, &fields, _transform, _clipBox, _buffer, _globalIdOverride, _tileIdOffset, featureDataCache);
+        return std::make_shared<MBVTFeatureIterator>(*_tile, layer, &fields, _transform, _clipBox, _buffer, _globalIdOverride, _tileIdOffset, getFeatureDataCache(layerIt->second));
+    }
+
+    std::shared_ptr<MBVTFeatureDecoder::FeatureDataCache> MBVTFeatureDecoder::getFeatureDataCache(int layerIndex) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto cacheIt = _layerFeatureDataCache.find(layerIndex);
+        if (cacheIt == _layerFeatureDataCache.end()) {
+            cacheIt = _layerFeatureDataCache.emplace(layerIndex, MBVTFeatureIterator::createFeatureDataCache(_tile->layers(layerIndex))).first;
+        }
+        return cacheIt->second;
     }
 } }
@@ -10,8 +10,10 @@
 #include "FeatureDecoder.h"
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <cglib/bbox.h>
@@ -40,6 +42,26 @@ namespace carto { namespace mvt {
     private:
         class MBVTFeatureIterator;
 
+        struct TagsHash {
+            std::size_t operator() (const std::vector<int>& tags) const {
+                std::size_t hash = tags.size();
+                for (int tag : tags) {
+                    hash ^= static_cast<std::size_t>(tag) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                }
+                return hash;
+            }
+        };
+
+        struct FeatureDataCache {
+            std::shared_ptr<const FeatureData::Dictionary> dictionary; // interned keys and values of the layer
+            std::vector<int> keyIndices; // layer key index -> dictionary key index
+            std::vector<int> valueIndices; // layer value index -> dictionary value index
+            std::mutex mutex; // guards the map, iterators of the same layer may be used concurrently
+            std::unordered_map<std::vector<int>, std::shared_ptr<FeatureData>, TagsHash> featureDataMap;
+        };
+
+        std::shared_ptr<FeatureDataCache> getFeatureDataCache(int layerIndex) const;
+
         cglib::mat3x3<float> _transform;
         cglib::bbox2<float> _clipBox;
         float _buffer;
@@ -47,7 +69,8 @@ namespace carto { namespace mvt {
         long long _tileIdOffset;
         std::shared_ptr<vector_tile::Tile> _tile;
         std::map<std::string, int> _layerMap;
-        mutable std::map<std::string, std::map<std::vector<int>, std::shared_ptr<FeatureData>>> _layerFeatureDataCache;
+        mutable std::map<int, std::shared_ptr<FeatureDataCache>> _layerFeatureDataCache; // built once per layer of the tile
+        mutable std::mutex _mutex;
 
         const std::shared_ptr<Logger> _logger;
     };
@@ -0,0 +1,45 @@
+#include "SymbolizerCache.h"
+#include "FeatureData.h"
+#include "Style.h"
+
+namespace carto { namespace mvt {
+    SymbolizerCache::SymbolizerCache(std::size_t capacity) :
+        _cache(capacity), _mutex()
+    {
+    }
+
+    bool SymbolizerCache::read(const std::shared_ptr<const Style>& style, int zoom, const std::shared_ptr<const FeatureData>& featureData, std::vector<std::shared_ptr<Symbolizer>>& symbolizers) const {
+        if (!featureData) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _cache.read(Key(style, zoom, featureData), symbolizers);
+    }
+
+    void SymbolizerCache::put(const std::shared_ptr<const Style>& style, int zoom, const std::shared_ptr<const FeatureData>& featureData, const std::vector<std::shared_ptr<Symbolizer>>& symbolizers) {
+        if (!featureData) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cache.put(Key(style, zoom, featureData), symbolizers);
+    }
+
+    void SymbolizerCache::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cache.clear();
+    }
+
+    bool SymbolizerCache::Key::operator == (const Key& other) const {
+        if (style != other.style || zoom != other.zoom) {
+            return false;
+        }
+        return featureData == other.featureData || *featureData == *other.featureData;
+    }
+
+    std::size_t SymbolizerCache::KeyHash::operator() (const Key& key) const {
+        std::size_t hash = key.featureData->getHash();
+        hash ^= std::hash<const Style*>()(key.style.get()) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        hash ^= std::hash<int>()(key.zoom) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+} }
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_MAPNIKVT_SYMBOLIZERCACHE_H_
+#define _CARTO_MAPNIKVT_SYMBOLIZERCACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <stdext/lru_cache.h>
+
+namespace carto { namespace mvt {
+    class FeatureData;
+    class Style;
+    class Symbolizer;
+
+    class SymbolizerCache final {
+    public:
+        explicit SymbolizerCache(std::size_t capacity);
+
+        bool read(const std::shared_ptr<const Style>& style, int zoom, const std::shared_ptr<const FeatureData>& featureData, std::vector<std::shared_ptr<Symbolizer>>& symbolizers) const;
+        void put(const std::shared_ptr<const Style>& style, int zoom, const std::shared_ptr<const FeatureData>& featureData, const std::vector<std::shared_ptr<Symbolizer>>& symbolizers);
+        void clear();
+
+    private:
+        struct Key {
+            std::shared_ptr<const Style> style;
+            int zoom;
+            std::shared_ptr<const FeatureData> featureData;
+
+            explicit Key(std::shared_ptr<const Style> style, int zoom, std::shared_ptr<const FeatureData> featureData) : style(std::move(style)), zoom(zoom), featureData(std::move(featureData)) { }
+
+            bool operator == (const Key& other) const;
+        };
+
+        struct KeyHash {
+            std::size_t operator() (const Key& key) const;
+        };
+
+        mutable cache::lru_cache<Key, std::vector<std::shared_ptr<Symbolizer>>, KeyHash> _cache;
+        mutable std::mutex _mutex;
+    };
+} }
+
+#endif
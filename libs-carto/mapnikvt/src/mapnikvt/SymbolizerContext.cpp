@@ -10,6 +10,8 @@
 #include "ShieldSymbolizer.h"
 
 namespace carto { namespace mvt {
+    constexpr std::size_t SymbolizerContext::SYMBOLIZER_CACHE_SIZE;
+
     SymbolizerContext::Settings::Settings(float tileSize, std::map<std::string, Value> nutiParameterValueMap) :
         _tileSize(tileSize), _geometryScale(1.0f), _fontScale(1.0f), _zoomLevelBias(0.0f), _nutiParameterValueMap(std::move(nutiParameterValueMap))
     {
@@ -8,6 +8,7 @@
 #define _CARTO_MAPNIKVT_SYMBOLIZERCONTEXT_H_
 
 #include "ExpressionContext.h"
+#include "SymbolizerCache.h"
 #include "vt/BitmapManager.h"
 #include "vt/FontManager.h"
 #include "vt/StrokeMap.h"
@@ -36,7 +37,7 @@ namespace carto { namespace mvt {
             std::map<std::string, Value> _nutiParameterValueMap;
         };
 
-        explicit SymbolizerContext(std::shared_ptr<vt::BitmapManager> bitmapManager, std::shared_ptr<vt::FontManager> fontManager, std::shared_ptr<vt::StrokeMap> strokeMap, std::shared_ptr<vt::GlyphMap> glyphMap, const Settings& settings) : _bitmapManager(std::move(bitmapManager)), _fontManager(std::move(fontManager)), _strokeMap(std::move(strokeMap)), _glyphMap(std::move(glyphMap)), _settings(settings) { }
+        explicit SymbolizerContext(std::shared_ptr<vt::BitmapManager> bitmapManager, std::shared_ptr<vt::FontManager> fontManager, std::shared_ptr<vt::StrokeMap> strokeMap, std::shared_ptr<vt::GlyphMap> glyphMap, const Settings& settings) : _bitmapManager(std::move(bitmapManager)), _fontManager(std::move(fontManager)), _strokeMap(std::move(strokeMap)), _glyphMap(std::move(glyphMap)), _settings(settings), _symbolizerCache(std::make_shared<SymbolizerCache>(SYMBOLIZER_CACHE_SIZE)) { }
 
         std::shared_ptr<vt::BitmapManager> getBitmapManager() const { return _bitmapManager; }
         std::shared_ptr<vt::FontManager> getFontManager() const { return _fontManager; }
@@ -44,12 +45,18 @@ namespace carto { namespace mvt {
         std::shared_ptr<vt::GlyphMap> getGlyphMap() const { return _glyphMap; }
         const Settings& getSettings() const { return _settings; }
 
+        // Feature symbolizer matches depend only on the style, zoom, feature data and settings, so they can be shared between tiles
+        std::shared_ptr<SymbolizerCache> getSymbolizerCache() const { return _symbolizerCache; }
+
     private:
+        constexpr static std::size_t SYMBOLIZER_CACHE_SIZE = 4096;
+
         const std::shared_ptr<vt::BitmapManager> _bitmapManager;
         const std::shared_ptr<vt::FontManager> _fontManager;
         const std::shared_ptr<vt::StrokeMap> _strokeMap;
         const std::shared_ptr<vt::GlyphMap> _glyphMap;
         const Settings _settings;
+        const std::shared_ptr<SymbolizerCache> _symbolizerCache;
     };
 } }
 
@@ -1,6 +1,8 @@
 #include "TileReader.h"
 #include "ParserUtils.h"
 #include "Symbolizer.h"
+#include "SymbolizerContext.h"
+#include "SymbolizerCache.h"
 #include "Predicate.h"
 #include "Expression.h"
 #include "ExpressionContext.h"
@@ -8,19 +10,25 @@
 #include "Filter.h"
 #include "Map.h"
 
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
+
 namespace carto { namespace mvt {
     TileReader::TileReader(std::shared_ptr<const Map> map, const SymbolizerContext& symbolizerContext) :
         _map(std::move(map)), _symbolizerContext(symbolizerContext), _trueFilter(std::make_shared<Filter>(Filter::Type::FILTER, std::make_shared<ConstPredicate>(true)))
     {
     }
 
-    std::shared_ptr<vt::Tile> TileReader::readTile(const vt::TileId& tileId) const {
-        FeatureExpressionContext exprContext;
-        exprContext.setZoom(tileId.zoom + static_cast<int>(_symbolizerContext.getSettings().getZoomLevelBias()));
-        exprContext.setNutiParameterValueMap(_symbolizerContext.getSettings().getNutiParameterValueMap());
-        vt::TileLayerBuilder tileLayerBuilder(tileId, _symbolizerContext.getSettings().getTileSize(), _symbolizerContext.getSettings().getGeometryScale());
+    void TileReader::setTaskExecutor(TaskExecutor taskExecutor, int maxTasks) {
+        _taskExecutor = std::move(taskExecutor);
+        _maxTasks = std::max(1, maxTasks);
+    }
 
-        std::vector<std::shared_ptr<vt::TileLayer>> tileLayers;
+    std::shared_ptr<vt::Tile> TileReader::readTile(const vt::TileId& tileId) const {
+        std::vector<LayerJob> jobs;
         int layerIdx = 0;
         for (const std::shared_ptr<Layer>& layer : _map->getLayers()) {
             int styleIdx = 0;
@@ -29,79 +37,166 @@ namespace carto { namespace mvt {
                 if (!style) {
                     continue;
                 }
-                
-                processLayer(layer, style, exprContext, tileLayerBuilder);
 
-                boost::optional<vt::CompOp> compOp;
+                int internalIdx = layerIdx * 65536 + static_cast<int>(layer->getStyleNames().size()) * 256 + styleIdx;
+                jobs.emplace_back(layer, style, internalIdx);
+                styleIdx++;
+            }
+            layerIdx++;
+        }
+
+        buildLayers(tileId, jobs);
+
+        std::vector<std::shared_ptr<vt::TileLayer>> tileLayers;
+        for (const LayerJob& job : jobs) {
+            if (job.tileLayer) {
+                tileLayers.push_back(job.tileLayer);
+            }
+        }
+        return std::make_shared<vt::Tile>(tileId, tileLayers);
+    }
+
+    void TileReader::buildLayers(const vt::TileId& tileId, std::vector<LayerJob>& jobs) const {
+        FeatureExpressionContext exprContext;
+        exprContext.setZoom(tileId.zoom + static_cast<int>(_symbolizerContext.getSettings().getZoomLevelBias()));
+        exprContext.setNutiParameterValueMap(_symbolizerContext.getSettings().getNutiParameterValueMap());
+
+        int taskCount = std::min(_maxTasks, static_cast<int>(jobs.size()));
+        if (!_taskExecutor || taskCount <= 1) {
+            vt::TileLayerBuilder tileLayerBuilder(tileId, _symbolizerContext.getSettings().getTileSize(), _symbolizerContext.getSettings().getGeometryScale());
+            for (LayerJob& job : jobs) {
+                buildLayer(job, exprContext, tileLayerBuilder);
+            }
+            return;
+        }
+
+        // Jobs are independent and each writes only its own result, so they can be built concurrently.
+        // The calling thread always participates, so completion never depends on the executor actually running the tasks.
+        struct State {
+            std::atomic<std::size_t> nextJob;
+            std::size_t finishedJobs = 0;
+            std::exception_ptr exception;
+            std::mutex mutex;
+            std::condition_variable condition;
+
+            State() : nextJob(0) { }
+        };
+        auto state = std::make_shared<State>();
+        std::size_t jobCount = jobs.size();
+        auto worker = [this, state, &jobs, jobCount, tileId, exprContext]() {
+            // NOTE: jobs and this can be accessed only while holding an unfinished job, as the caller may have returned otherwise
+            std::unique_ptr<vt::TileLayerBuilder> tileLayerBuilder;
+            FeatureExpressionContext workerExprContext(exprContext);
+            for (std::size_t jobIdx = state->nextJob++; jobIdx < jobCount; jobIdx = state->nextJob++) {
                 try {
-                    if (!style->getCompOp().empty()) {
-                        compOp = parseCompOp(style->getCompOp());
+                    if (!tileLayerBuilder) {
+                        tileLayerBuilder.reset(new vt::TileLayerBuilder(tileId, _symbolizerContext.getSettings().getTileSize(), _symbolizerContext.getSettings().getGeometryScale()));
                     }
+                    buildLayer(jobs[jobIdx], workerExprContext, *tileLayerBuilder);
                 }
-                catch (const ParserException&) {
-                    // ignore the error
+                catch (...) {
+                    tileLayerBuilder.reset(); // builder state is undefined after an exception
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->exception) {
+                        state->exception = std::current_exception();
+                    }
                 }
-                
-                float opacity = style->getOpacity();
-                std::shared_ptr<vt::FloatFunction> opacityFn = std::make_shared<vt::FloatFunction>([opacity](const vt::ViewState& viewState) { return opacity; });
 
-                int internalIdx = layerIdx * 65536 + static_cast<int>(layer->getStyleNames().size()) * 256 + styleIdx;
-                std::shared_ptr<vt::TileLayer> tileLayer = tileLayerBuilder.build(internalIdx, opacityFn, compOp);
-                if (!(tileLayer->getBitmaps().empty() && tileLayer->getLabels().empty() && tileLayer->getGeometries().empty() && !compOp)) {
-                    tileLayers.push_back(tileLayer);
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (++state->finishedJobs == jobCount) {
+                    state->condition.notify_all();
                 }
-                styleIdx++;
             }
-            layerIdx++;
+        };
+
+        for (int i = 1; i < taskCount; i++) {
+            _taskExecutor(worker);
+        }
+        worker();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [state, jobCount]() { return state->finishedJobs == jobCount; });
+        if (state->exception) {
+            std::rethrow_exception(state->exception);
+        }
+    }
+
+    void TileReader::buildLayer(LayerJob& job, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const {
+        processLayer(job.layer, job.style, exprContext, layerBuilder);
+
+        boost::optional<vt::CompOp> compOp;
+        try {
+            if (!job.style->getCompOp().empty()) {
+                compOp = parseCompOp(job.style->getCompOp());
+            }
+        }
+        catch (const ParserException&) {
+            // ignore the error
+        }
+
+        float opacity = job.style->getOpacity();
+        std::shared_ptr<vt::FloatFunction> opacityFn = std::make_shared<vt::FloatFunction>([opacity](const vt::ViewState& viewState) { return opacity; });
+
+        std::shared_ptr<vt::TileLayer> tileLayer = layerBuilder.build(job.internalIdx, opacityFn, compOp);
+        if (!(tileLayer->getBitmaps().empty() && tileLayer->getLabels().empty() && tileLayer->getGeometries().empty() && !compOp)) {
+            job.tileLayer = tileLayer;
         }
-        return std::make_shared<vt::Tile>(tileId, tileLayers);
     }
 
     void TileReader::processLayer(const std::shared_ptr<const Layer>& layer, const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const {
+        if (auto featureIt = createFeatureIterator(layer, style, exprContext)) {
+            processFeatures(*featureIt, style, exprContext, layerBuilder);
+        }
+    }
+
+    void TileReader::processFeatures(FeatureDecoder::FeatureIterator& featureIt, const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const {
         std::shared_ptr<Symbolizer> currentSymbolizer;
         FeatureCollection currentFeatureCollection;
         std::unordered_map<std::shared_ptr<const FeatureData>, std::vector<std::shared_ptr<Symbolizer>>> featureDataSymbolizersMap;
-        if (auto featureIt = createFeatureIterator(layer, style, exprContext)) {
-            for (; featureIt->valid(); featureIt->advance()) {
-                // Cache symbolizer evaluation for each feature data object
-                std::shared_ptr<const FeatureData> featureData = featureIt->getFeatureData();
-                auto symbolizersIt = featureDataSymbolizersMap.find(featureData);
-                if (symbolizersIt == featureDataSymbolizersMap.end()) {
+        std::shared_ptr<SymbolizerCache> symbolizerCache = _symbolizerContext.getSymbolizerCache();
+        for (; featureIt.valid(); featureIt.advance()) {
+            // Cache symbolizer evaluation for each feature data object
+            std::shared_ptr<const FeatureData> featureData = featureIt.getFeatureData();
+            auto symbolizersIt = featureDataSymbolizersMap.find(featureData);
+            if (symbolizersIt == featureDataSymbolizersMap.end()) {
+                std::vector<std::shared_ptr<Symbolizer>> symbolizers;
+                if (!symbolizerCache->read(style, exprContext.getZoom(), featureData, symbolizers)) {
                     exprContext.setFeatureData(featureData);
-                    std::vector<std::shared_ptr<Symbolizer>> symbolizers = findFeatureSymbolizers(style, exprContext);
-                    symbolizersIt = featureDataSymbolizersMap.emplace(featureData, std::move(symbolizers)).first;
+                    symbolizers = findFeatureSymbolizers(style, exprContext);
+                    symbolizerCache->put(style, exprContext.getZoom(), featureData, symbolizers);
                 }
+                symbolizersIt = featureDataSymbolizersMap.emplace(featureData, std::move(symbolizers)).first;
+            }
 
-                // Process symbolizers, try to batch as many calls together as possible
-                for (const std::shared_ptr<Symbolizer>& symbolizer : symbolizersIt->second) {
-                    if (std::shared_ptr<const Geometry> geometry = featureIt->getGeometry()) {
-                        bool batch = false;
-                        if (currentSymbolizer == symbolizer) {
-                            if (currentFeatureCollection.getFeatureData() == featureData || symbolizer->getParameterExpressions().empty()) {
-                                batch = true;
-                            }
+            // Process symbolizers, try to batch as many calls together as possible
+            for (const std::shared_ptr<Symbolizer>& symbolizer : symbolizersIt->second) {
+                if (std::shared_ptr<const Geometry> geometry = featureIt.getGeometry()) {
+                    bool batch = false;
+                    if (currentSymbolizer == symbolizer) {
+                        if (currentFeatureCollection.getFeatureData() == featureData || symbolizer->getParameterExpressions().empty()) {
+                            batch = true;
                         }
+                    }
 
-                        if (!batch) {
-                            if (currentSymbolizer) {
-                                exprContext.setFeatureData(currentFeatureCollection.getFeatureData());
-                                currentSymbolizer->build(currentFeatureCollection, exprContext, _symbolizerContext, layerBuilder);
-                            }
-                            currentFeatureCollection.clear();
-                            currentFeatureCollection.setFeatureData(featureData);
-                            currentSymbolizer = symbolizer;
+                    if (!batch) {
+                        if (currentSymbolizer) {
+                            exprContext.setFeatureData(currentFeatureCollection.getFeatureData());
+                            currentSymbolizer->build(currentFeatureCollection, exprContext, _symbolizerContext, layerBuilder);
                         }
-
-                        currentFeatureCollection.append(featureIt->getLocalId(), featureIt->getGlobalId(), geometry);
+                        currentFeatureCollection.clear();
+                        currentFeatureCollection.setFeatureData(featureData);
+                        currentSymbolizer = symbolizer;
                     }
+
+                    currentFeatureCollection.append(featureIt.getLocalId(), featureIt.getGlobalId(), geometry);
                 }
             }
+        }
 
-            // Flush the remaining batched features
-            if (currentSymbolizer) {
-                exprContext.setFeatureData(currentFeatureCollection.getFeatureData());
-                currentSymbolizer->build(currentFeatureCollection, exprContext, _symbolizerContext, layerBuilder);
-            }
+        // Flush the remaining batched features
+        if (currentSymbolizer) {
+            exprContext.setFeatureData(currentFeatureCollection.getFeatureData());
+            currentSymbolizer->build(currentFeatureCollection, exprContext, _symbolizerContext, layerBuilder);
         }
     }
 
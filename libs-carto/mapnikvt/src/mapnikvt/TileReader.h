@@ -12,6 +12,7 @@
 #include "vt/TileLayerBuilder.h"
 
 #include <memory>
+#include <functional>
 
 #include <cglib/vec.h>
 #include <cglib/mat.h>
@@ -29,14 +30,32 @@ namespace carto { namespace mvt {
     
     class TileReader {
     public:
+        using Task = std::function<void()>;
+        using TaskExecutor = std::function<void(Task task)>;
+
         virtual ~TileReader() = default;
 
+        void setTaskExecutor(TaskExecutor taskExecutor, int maxTasks);
+
         virtual std::shared_ptr<vt::Tile> readTile(const vt::TileId& tileId) const;
 
     protected:
+        struct LayerJob {
+            std::shared_ptr<const Layer> layer;
+            std::shared_ptr<const Style> style;
+            int internalIdx;
+            std::shared_ptr<vt::TileLayer> tileLayer;
+
+            explicit LayerJob(std::shared_ptr<const Layer> layer, std::shared_ptr<const Style> style, int internalIdx) : layer(std::move(layer)), style(std::move(style)), internalIdx(internalIdx), tileLayer() { }
+        };
+
         explicit TileReader(std::shared_ptr<const Map> map, const SymbolizerContext& symbolizerContext);
 
-        void processLayer(const std::shared_ptr<const Layer>& layer, const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const;
+        void buildLayers(const vt::TileId& tileId, std::vector<LayerJob>& jobs) const;
+        void buildLayer(LayerJob& job, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const;
+
+        virtual void processLayer(const std::shared_ptr<const Layer>& layer, const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const;
+        void processFeatures(FeatureDecoder::FeatureIterator& featureIt, const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const;
 
         std::vector<std::shared_ptr<Symbolizer>> findFeatureSymbolizers(const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext) const;
 
@@ -45,6 +64,9 @@ namespace carto { namespace mvt {
         const std::shared_ptr<const Map> _map;
         const SymbolizerContext& _symbolizerContext;
         const std::shared_ptr<const Filter> _trueFilter;
+
+        TaskExecutor _taskExecutor;
+        int _maxTasks = 1;
     };
 } }
 
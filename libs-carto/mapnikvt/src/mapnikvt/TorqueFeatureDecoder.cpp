@@ -1,6 +1,8 @@
 #include "TorqueFeatureDecoder.h"
 #include "Logger.h"
 
+#include <algorithm>
+
 #include <boost/lexical_cast.hpp>
 
 #include <rapidjson/rapidjson.h>
@@ -41,8 +43,8 @@ namespace {
 namespace carto { namespace mvt {
     class TorqueFeatureDecoder::TorqueFeatureIterator : public carto::mvt::FeatureDecoder::FeatureIterator {
     public:
-        explicit TorqueFeatureIterator(const std::vector<TorqueFeatureDecoder::Element>& elements, int resolution, const cglib::mat3x3<float>& transform, const cglib::bbox2<float>& clipBox) : _elements(elements), _resolution(resolution), _transform(transform), _clipBox(clipBox) {
-            while (++_index1 < _elements.size()) {
+        explicit TorqueFeatureIterator(const std::vector<TorqueFeatureDecoder::Element>& elements, std::size_t begin, std::size_t end, int resolution, const cglib::mat3x3<float>& transform, const cglib::bbox2<float>& clipBox) : _index0(begin), _index1(begin), _end(end), _elements(elements), _resolution(resolution), _transform(transform), _clipBox(clipBox) {
+            while (++_index1 < _end) {
                 if (_elements[_index0].value != _elements[_index1].value) {
                     break;
                 }
@@ -50,12 +52,12 @@ namespace carto { namespace mvt {
         }
 
         virtual bool valid() const override {
-            return _index0 < _elements.size();
+            return _index0 < _end;
         }
 
         virtual void advance() override {
             _index0 = _index1;
-            while (++_index1 < _elements.size()) {
+            while (++_index1 < _end) {
                 if (_elements[_index0].value != _elements[_index1].value) {
                     break;
                 }
@@ -97,8 +99,9 @@ namespace carto { namespace mvt {
         }
 
     private:
-        std::size_t _index0 = 0;
-        std::size_t _index1 = 0;
+        std::size_t _index0;
+        std::size_t _index1;
+        const std::size_t _end;
         const std::vector<TorqueFeatureDecoder::Element>& _elements;
         const int _resolution;
         const cglib::mat3x3<float> _transform;
@@ -150,6 +153,7 @@ namespace carto { namespace mvt {
             return;
         }
 
+        std::vector<std::pair<int, Element>> timeElements;
         for (rapidjson::Value::ConstValueIterator jit = rows->Begin(); jit != rows->End(); jit++) {
             const rapidjson::Value& rowValue = *jit;
             int x = readRapidJSONInt(rowValue[xField.c_str()]);
@@ -162,8 +166,21 @@ namespace carto { namespace mvt {
             for (unsigned int i = 0; i < valueCount; i++) {
                 int time = (i < timeCount ? readRapidJSONInt(rowValue[timeField.c_str()][i]) : -1);
                 double value = readRapidJSONDouble(rowValue[valueField.c_str()][i]);
-                _timeValueMap[time].emplace_back(x, y, value);
+                timeElements.emplace_back(time, Element(x, y, value));
+            }
+        }
+
+        // Build the time index: elements sorted by frame and element range for each frame
+        std::stable_sort(timeElements.begin(), timeElements.end(), [](const std::pair<int, Element>& timeElement1, const std::pair<int, Element>& timeElement2) {
+            return timeElement1.first < timeElement2.first;
+        });
+        _elements.reserve(timeElements.size());
+        for (const std::pair<int, Element>& timeElement : timeElements) {
+            if (_frameRanges.empty() || _frameRanges.back().frame != timeElement.first) {
+                _frameRanges.emplace_back(timeElement.first, _elements.size(), _elements.size());
             }
+            _elements.push_back(timeElement.second);
+            _frameRanges.back().end = _elements.size();
         }
     }
 
@@ -175,12 +192,23 @@ namespace carto { namespace mvt {
         _clipBox = clipBox;
     }
 
+    std::vector<int> TorqueFeatureDecoder::getFrames() const {
+        std::vector<int> frames;
+        frames.reserve(_frameRanges.size());
+        for (const FrameRange& frameRange : _frameRanges) {
+            frames.push_back(frameRange.frame);
+        }
+        return frames;
+    }
+
     std::shared_ptr<FeatureDecoder::FeatureIterator> TorqueFeatureDecoder::createFrameFeatureIterator(int frame) const {
-        auto it = _timeValueMap.find(frame);
-        if (it == _timeValueMap.end()) {
+        auto it = std::lower_bound(_frameRanges.begin(), _frameRanges.end(), frame, [](const FrameRange& frameRange, int frame) {
+            return frameRange.frame < frame;
+        });
+        if (it == _frameRanges.end() || it->frame != frame) {
             return std::shared_ptr<FeatureIterator>();
         }
 
-        return std::make_shared<TorqueFeatureIterator>(it->second, _resolution, _transform, _clipBox);
+        return std::make_shared<TorqueFeatureIterator>(_elements, it->begin, it->end, _resolution, _transform, _clipBox);
     }
 } }
@@ -27,6 +27,7 @@ namespace carto { namespace mvt {
         void setTransform(const cglib::mat3x3<float>& transform);
         void setClipBox(const cglib::bbox2<float>& clipBox);
 
+        std::vector<int> getFrames() const;
         std::shared_ptr<FeatureIterator> createFrameFeatureIterator(int frame) const;
 
     private:
@@ -40,7 +41,16 @@ namespace carto { namespace mvt {
             explicit Element(int x, int y, double value) : x(x), y(y), value(value) { }
         };
 
-        std::unordered_map<int, std::vector<Element>> _timeValueMap;
+        struct FrameRange {
+            int frame;
+            std::size_t begin;
+            std::size_t end;
+
+            explicit FrameRange(int frame, std::size_t begin, std::size_t end) : frame(frame), begin(begin), end(end) { }
+        };
+
+        std::vector<Element> _elements; // sorted by frame, original order is kept within frames
+        std::vector<FrameRange> _frameRanges; // sorted by frame
 
         const int _resolution;
         cglib::mat3x3<float> _transform;
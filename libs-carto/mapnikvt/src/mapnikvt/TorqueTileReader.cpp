@@ -3,6 +3,32 @@
 #include "TorqueFeatureDecoder.h"
 
 namespace carto { namespace mvt {
+    void TorqueTileReader::processLayer(const std::shared_ptr<const Layer>& layer, const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const {
+        if (!_allFrames) {
+            TileReader::processLayer(layer, style, exprContext, layerBuilder);
+            return;
+        }
+
+        int frameOffset = 0;
+        if (auto torqueLayer = std::dynamic_pointer_cast<const TorqueLayer>(layer)) {
+            frameOffset = torqueLayer->getFrameOffset();
+        }
+        int frameCount = std::dynamic_pointer_cast<const TorqueMap>(_map)->getTorqueSettings().frameCount;
+
+        // Time value t is displayed at frame t + frameOffset, so trail layers are simply shifted in time
+        for (int time : _featureDecoder.getFrames()) {
+            int frame = time + frameOffset;
+            if (frame < 0 || (frameCount > 0 && frame >= frameCount)) {
+                continue;
+            }
+            if (auto featureIt = _featureDecoder.createFrameFeatureIterator(time)) {
+                layerBuilder.setFrame(frame);
+                processFeatures(*featureIt, style, exprContext, layerBuilder);
+            }
+        }
+        layerBuilder.setFrame(boost::optional<int>());
+    }
+
     std::shared_ptr<FeatureDecoder::FeatureIterator> TorqueTileReader::createFeatureIterator(const std::shared_ptr<const Layer>& layer, const std::shared_ptr<const Style>& style, const FeatureExpressionContext& exprContext) const {
         int frameOffset = 0;
         if (auto torqueLayer = std::dynamic_pointer_cast<const TorqueLayer>(layer)) {
@@ -15,14 +15,18 @@ namespace carto { namespace mvt {
     
     class TorqueTileReader : public TileReader {
     public:
-        explicit TorqueTileReader(std::shared_ptr<TorqueMap> map, int frame, bool loop, const SymbolizerContext& symbolizerContext, const TorqueFeatureDecoder& featureDecoder) : TileReader(std::move(map), symbolizerContext), _frame(frame), _loop(loop), _featureDecoder(featureDecoder) { }
+        explicit TorqueTileReader(std::shared_ptr<TorqueMap> map, int frame, bool loop, const SymbolizerContext& symbolizerContext, const TorqueFeatureDecoder& featureDecoder) : TileReader(std::move(map), symbolizerContext), _frame(frame), _loop(loop), _allFrames(false), _featureDecoder(featureDecoder) { }
+        // Reads all frames into a single tile, each vertex is tagged with the frame it is visible in
+        explicit TorqueTileReader(std::shared_ptr<TorqueMap> map, const SymbolizerContext& symbolizerContext, const TorqueFeatureDecoder& featureDecoder) : TileReader(std::move(map), symbolizerContext), _frame(0), _loop(false), _allFrames(true), _featureDecoder(featureDecoder) { }
 
     protected:
+        virtual void processLayer(const std::shared_ptr<const Layer>& layer, const std::shared_ptr<const Style>& style, FeatureExpressionContext& exprContext, vt::TileLayerBuilder& layerBuilder) const override;
         virtual std::shared_ptr<FeatureDecoder::FeatureIterator> createFeatureIterator(const std::shared_ptr<const Layer>& layer, const std::shared_ptr<const Style>& style, const FeatureExpressionContext& exprContext) const override;
 
     private:
         const int _frame;
         const bool _loop;
+        const bool _allFrames;
         const TorqueFeatureDecoder& _featureDecoder;
     };
 } }
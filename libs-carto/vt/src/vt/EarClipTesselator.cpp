@@ -0,0 +1,349 @@
+#include "EarClipTesselator.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace carto { namespace vt {
+    bool EarClipTesselator::tesselate(const VerticesList& verticesList, std::vector<unsigned int>& indices) {
+        if (verticesList.empty()) {
+            return true;
+        }
+
+        std::size_t vertexCount = 0;
+        for (const Vertices& vertices : verticesList) {
+            vertexCount += vertices.size();
+        }
+        if (vertexCount > MAX_VERTICES) {
+            return false;
+        }
+
+        // Check ring orientations. All holes must have opposite orientation compared to the outer ring, otherwise we have a multipolygon or invalid input
+        double outerArea = signedArea(verticesList.front());
+        if (outerArea == 0) {
+            return false;
+        }
+        double polygonArea = std::abs(outerArea);
+        for (auto it = verticesList.begin() + 1; it != verticesList.end(); it++) {
+            if (it->size() < 3) {
+                continue;
+            }
+            double holeArea = signedArea(*it);
+            if (holeArea * outerArea >= 0) {
+                return false;
+            }
+            polygonArea -= std::abs(holeArea);
+        }
+        if (polygonArea <= 0) {
+            return false;
+        }
+
+        // Build linked lists. Outer ring is always stored in CCW order, holes in CW order
+        _nodes.clear();
+        _nodes.reserve(vertexCount + verticesList.size() * 2);
+        int outerNode = createRing(verticesList.front(), 0, true);
+        if (outerNode == -1 || _nodes[outerNode].next == _nodes[outerNode].prev) {
+            return false;
+        }
+
+        std::vector<int> holeNodes;
+        unsigned int offset = static_cast<unsigned int>(verticesList.front().size());
+        for (auto it = verticesList.begin() + 1; it != verticesList.end(); it++) {
+            if (it->size() >= 3) {
+                int holeNode = createRing(*it, offset, false);
+                if (holeNode != -1) {
+                    if (_nodes[holeNode].next == holeNode) {
+                        _nodes[holeNode].steiner = true;
+                    }
+                    holeNodes.push_back(getLeftmost(holeNode));
+                }
+            }
+            offset += static_cast<unsigned int>(it->size());
+        }
+
+        // Connect holes to the outer ring, starting from the leftmost
+        std::sort(holeNodes.begin(), holeNodes.end(), [this](int a, int b) { return _nodes[a].x < _nodes[b].x; });
+        for (int holeNode : holeNodes) {
+            outerNode = eliminateHole(holeNode, outerNode);
+        }
+
+        std::size_t firstIndex = indices.size();
+        if (!clipEars(outerNode, indices)) {
+            indices.resize(firstIndex);
+            return false;
+        }
+
+        // Validate the result by comparing triangle area to polygon area. This catches self-intersections and other bad input
+        double trianglesArea = 0;
+        for (std::size_t i = firstIndex; i < indices.size(); i += 3) {
+            const Vertex* v[3];
+            for (int j = 0; j < 3; j++) {
+                unsigned int index = indices[i + j];
+                for (const Vertices& vertices : verticesList) {
+                    if (index < vertices.size()) {
+                        v[j] = &vertices[index];
+                        break;
+                    }
+                    index -= static_cast<unsigned int>(vertices.size());
+                }
+            }
+            double dx1 = static_cast<double>((*v[1])(0)) - (*v[0])(0), dy1 = static_cast<double>((*v[1])(1)) - (*v[0])(1);
+            double dx2 = static_cast<double>((*v[2])(0)) - (*v[0])(0), dy2 = static_cast<double>((*v[2])(1)) - (*v[0])(1);
+            trianglesArea += std::abs(dx1 * dy2 - dx2 * dy1) * 0.5;
+        }
+        if (std::abs(trianglesArea - polygonArea) > polygonArea * MAX_AREA_DEVIATION) {
+            indices.resize(firstIndex);
+            return false;
+        }
+
+        // Match the orientation of the input outer ring
+        if (outerArea < 0) {
+            for (std::size_t i = firstIndex; i < indices.size(); i += 3) {
+                std::swap(indices[i + 0], indices[i + 2]);
+            }
+        }
+        return true;
+    }
+
+    int EarClipTesselator::createRing(const Vertices& vertices, unsigned int offset, bool ccw) {
+        int last = -1;
+        if (ccw == (signedArea(vertices) > 0)) {
+            for (std::size_t i = 0; i < vertices.size(); i++) {
+                last = insertNode(offset + static_cast<unsigned int>(i), vertices[i](0), vertices[i](1), last);
+            }
+        } else {
+            for (std::size_t i = vertices.size(); i-- > 0; ) {
+                last = insertNode(offset + static_cast<unsigned int>(i), vertices[i](0), vertices[i](1), last);
+            }
+        }
+        if (last != -1 && equals(last, _nodes[last].next)) {
+            int next = _nodes[last].next;
+            removeNode(last);
+            last = next;
+        }
+        return last;
+    }
+
+    int EarClipTesselator::insertNode(unsigned int index, double x, double y, int last) {
+        int p = static_cast<int>(_nodes.size());
+        _nodes.emplace_back(index, x, y);
+        if (last == -1) {
+            _nodes[p].prev = p;
+            _nodes[p].next = p;
+        } else {
+            _nodes[p].next = _nodes[last].next;
+            _nodes[p].prev = last;
+            _nodes[_nodes[last].next].prev = p;
+            _nodes[last].next = p;
+        }
+        return p;
+    }
+
+    void EarClipTesselator::removeNode(int p) {
+        _nodes[_nodes[p].next].prev = _nodes[p].prev;
+        _nodes[_nodes[p].prev].next = _nodes[p].next;
+    }
+
+    int EarClipTesselator::filterPoints(int start, int end) {
+        if (end == -1) {
+            end = start;
+        }
+
+        // Remove duplicate and collinear points
+        int p = start;
+        bool again;
+        do {
+            again = false;
+            if (!_nodes[p].steiner && (equals(p, _nodes[p].next) || area(_nodes[p].prev, p, _nodes[p].next) == 0)) {
+                removeNode(p);
+                p = end = _nodes[p].prev;
+                if (p == _nodes[p].next) {
+                    break;
+                }
+                again = true;
+            } else {
+                p = _nodes[p].next;
+            }
+        } while (again || p != end);
+        return end;
+    }
+
+    bool EarClipTesselator::clipEars(int ear, std::vector<unsigned int>& indices) {
+        bool filtered = false;
+        int stop = ear;
+        while (_nodes[ear].prev != _nodes[ear].next) {
+            int prev = _nodes[ear].prev;
+            int next = _nodes[ear].next;
+            if (isEar(ear)) {
+                indices.push_back(_nodes[prev].index);
+                indices.push_back(_nodes[ear].index);
+                indices.push_back(_nodes[next].index);
+                removeNode(ear);
+                ear = stop = _nodes[next].next;
+                filtered = false;
+                continue;
+            }
+            ear = next;
+            if (ear == stop) {
+                // No ears found in a full pass. Try once more after removing degenerate points, then give up
+                if (filtered) {
+                    return false;
+                }
+                ear = stop = filterPoints(ear, -1);
+                filtered = true;
+            }
+        }
+        return true;
+    }
+
+    bool EarClipTesselator::isEar(int ear) const {
+        const Node& a = _nodes[_nodes[ear].prev];
+        const Node& b = _nodes[ear];
+        const Node& c = _nodes[_nodes[ear].next];
+        if (area(b.prev, ear, b.next) >= 0) {
+            return false; // reflex, can not be an ear
+        }
+
+        // Make sure no other point is inside the potential ear
+        for (int p = _nodes[b.next].next; p != b.prev; p = _nodes[p].next) {
+            if (pointInTriangle(a.x, a.y, b.x, b.y, c.x, c.y, _nodes[p].x, _nodes[p].y) && area(_nodes[p].prev, p, _nodes[p].next) >= 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int EarClipTesselator::eliminateHole(int hole, int outerNode) {
+        int bridge = findHoleBridge(hole, outerNode);
+        if (bridge == -1) {
+            return outerNode;
+        }
+
+        int bridgeReverse = splitPolygon(bridge, hole);
+        int filteredBridge = filterPoints(bridge, _nodes[bridge].next);
+        filterPoints(bridgeReverse, _nodes[bridgeReverse].next);
+        return outerNode == bridge ? filteredBridge : outerNode;
+    }
+
+    int EarClipTesselator::findHoleBridge(int hole, int outerNode) const {
+        double hx = _nodes[hole].x;
+        double hy = _nodes[hole].y;
+        double qx = -std::numeric_limits<double>::infinity();
+        int m = -1;
+
+        // Find a segment intersected by a ray from the hole's leftmost point to the left
+        int p = outerNode;
+        do {
+            const Node& pn = _nodes[p];
+            const Node& nn = _nodes[pn.next];
+            if (hy <= pn.y && hy >= nn.y && nn.y != pn.y) {
+                double x = pn.x + (hy - pn.y) * (nn.x - pn.x) / (nn.y - pn.y);
+                if (x <= hx && x > qx) {
+                    qx = x;
+                    if (x == hx) {
+                        if (hy == pn.y) {
+                            return p;
+                        }
+                        if (hy == nn.y) {
+                            return pn.next;
+                        }
+                    }
+                    m = pn.x < nn.x ? p : pn.next;
+                }
+            }
+            p = pn.next;
+        } while (p != outerNode);
+
+        if (m == -1) {
+            return -1;
+        }
+        if (hx == qx) {
+            return m; // hole touches outer segment
+        }
+
+        // Look for points inside the triangle of hole point, segment intersection and endpoint.
+        // If there are no points found, we have a valid connection, otherwise choose the point of the minimum angle with the ray
+        int stop = m;
+        double mx = _nodes[m].x;
+        double my = _nodes[m].y;
+        double tanMin = std::numeric_limits<double>::infinity();
+        p = m;
+        do {
+            const Node& pn = _nodes[p];
+            if (hx >= pn.x && pn.x >= mx && hx != pn.x && pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, pn.x, pn.y)) {
+                double tan = std::abs(hy - pn.y) / (hx - pn.x);
+                if (locallyInside(p, hole) && (tan < tanMin || (tan == tanMin && (pn.x > _nodes[m].x || (pn.x == _nodes[m].x && sectorContainsSector(m, p)))))) {
+                    m = p;
+                    tanMin = tan;
+                }
+            }
+            p = pn.next;
+        } while (p != stop);
+        return m;
+    }
+
+    int EarClipTesselator::splitPolygon(int a, int b) {
+        int a2 = static_cast<int>(_nodes.size());
+        _nodes.emplace_back(_nodes[a].index, _nodes[a].x, _nodes[a].y);
+        int b2 = static_cast<int>(_nodes.size());
+        _nodes.emplace_back(_nodes[b].index, _nodes[b].x, _nodes[b].y);
+        int an = _nodes[a].next;
+        int bp = _nodes[b].prev;
+
+        _nodes[a].next = b;
+        _nodes[b].prev = a;
+        _nodes[a2].next = an;
+        _nodes[an].prev = a2;
+        _nodes[b2].next = a2;
+        _nodes[a2].prev = b2;
+        _nodes[bp].next = b2;
+        _nodes[b2].prev = bp;
+        return b2;
+    }
+
+    int EarClipTesselator::getLeftmost(int start) const {
+        int p = start;
+        int leftmost = start;
+        do {
+            if (_nodes[p].x < _nodes[leftmost].x || (_nodes[p].x == _nodes[leftmost].x && _nodes[p].y < _nodes[leftmost].y)) {
+                leftmost = p;
+            }
+            p = _nodes[p].next;
+        } while (p != start);
+        return leftmost;
+    }
+
+    bool EarClipTesselator::locallyInside(int a, int b) const {
+        if (area(_nodes[a].prev, a, _nodes[a].next) < 0) {
+            return area(a, b, _nodes[a].next) >= 0 && area(a, _nodes[a].prev, b) >= 0;
+        }
+        return area(a, b, _nodes[a].prev) < 0 || area(a, _nodes[a].next, b) < 0;
+    }
+
+    bool EarClipTesselator::sectorContainsSector(int m, int p) const {
+        return area(_nodes[m].prev, m, _nodes[p].prev) < 0 && area(_nodes[p].next, m, _nodes[m].next) < 0;
+    }
+
+    bool EarClipTesselator::equals(int a, int b) const {
+        return _nodes[a].x == _nodes[b].x && _nodes[a].y == _nodes[b].y;
+    }
+
+    double EarClipTesselator::area(int p, int q, int r) const {
+        const Node& pn = _nodes[p];
+        const Node& qn = _nodes[q];
+        const Node& rn = _nodes[r];
+        return (qn.y - pn.y) * (rn.x - qn.x) - (qn.x - pn.x) * (rn.y - qn.y);
+    }
+
+    double EarClipTesselator::signedArea(const Vertices& vertices) {
+        double area = 0;
+        for (std::size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++) {
+            area += (static_cast<double>(vertices[j](0)) - vertices[i](0)) * (static_cast<double>(vertices[i](1)) + vertices[j](1));
+        }
+        return area * 0.5;
+    }
+
+    bool EarClipTesselator::pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+        return (cx - px) * (ay - py) - (ax - px) * (cy - py) >= 0 && (ax - px) * (by - py) - (bx - px) * (ay - py) >= 0 && (bx - px) * (cy - py) - (cx - px) * (by - py) >= 0;
+    }
+} }
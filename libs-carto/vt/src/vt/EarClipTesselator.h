@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_VT_EARCLIPTESSELATOR_H_
+#define _CARTO_VT_EARCLIPTESSELATOR_H_
+
+#include <vector>
+
+#include <cglib/vec.h>
+
+namespace carto { namespace vt {
+    class EarClipTesselator final {
+    public:
+        using Vertex = cglib::vec2<float>;
+        using Vertices = std::vector<Vertex>;
+        using VerticesList = std::vector<Vertices>;
+
+        EarClipTesselator() = default;
+
+        // Triangulates a simple polygon (first ring is the outer ring, other rings are holes).
+        // Resulting indices refer to the concatenated vertices of all rings. Triangles have the same orientation as the outer ring.
+        // Returns false if the polygon is too complex, self-intersecting or otherwise not handled, in that case general tesselator should be used.
+        bool tesselate(const VerticesList& verticesList, std::vector<unsigned int>& indices);
+
+    private:
+        constexpr static std::size_t MAX_VERTICES = 512; // ear clipping is quadratic in vertex count, larger polygons are better handled by general tesselator
+        constexpr static double MAX_AREA_DEVIATION = 1.0e-4;
+
+        struct Node {
+            unsigned int index;
+            double x;
+            double y;
+            int prev;
+            int next;
+            bool steiner;
+
+            explicit Node(unsigned int index, double x, double y) : index(index), x(x), y(y), prev(-1), next(-1), steiner(false) { }
+        };
+
+        int createRing(const Vertices& vertices, unsigned int offset, bool ccw);
+        int insertNode(unsigned int index, double x, double y, int last);
+        void removeNode(int p);
+        int filterPoints(int start, int end);
+        bool clipEars(int ear, std::vector<unsigned int>& indices);
+        bool isEar(int ear) const;
+        int eliminateHole(int hole, int outerNode);
+        int findHoleBridge(int hole, int outerNode) const;
+        int splitPolygon(int a, int b);
+        int getLeftmost(int start) const;
+        bool locallyInside(int a, int b) const;
+        bool sectorContainsSector(int m, int p) const;
+        bool equals(int a, int b) const;
+        double area(int p, int q, int r) const;
+
+        static double signedArea(const Vertices& vertices);
+        static bool pointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py);
+
+        std::vector<Node> _nodes;
+    };
+} }
+
+#endif
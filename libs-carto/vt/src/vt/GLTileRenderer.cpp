@@ -3,6 +3,7 @@
 #include "BitmapManager.h"
 
 #include <cassert>
+#include <cmath>
 #include <algorithm>
 
 namespace {
@@ -122,12 +123,18 @@ namespace {
         attribute vec2 aVertexUV;
         #endif
         attribute vec4 aVertexAttribs;
+        #ifdef FRAMES
+        attribute float aVertexFrame;
+        #endif
         #ifdef PATTERN
         uniform vec2 uUVScale;
         #endif
         uniform float uBinormalScale;
         uniform vec3 uXAxis;
         uniform vec3 uYAxis;
+        #ifdef FRAMES
+        uniform float uFrame;
+        #endif
         #ifdef TRANSFORM
         uniform mat3 uTransformMatrix;
         #endif
@@ -150,6 +157,11 @@ namespace {
             vUV = uUVScale * aVertexUV;
         #endif
             gl_Position = uMVPMatrix * vec4(pos, 1.0);
+        #ifdef FRAMES
+            if (abs(aVertexFrame - uFrame) > 0.5) {
+                gl_Position = vec4(0.0, 0.0, 2.0, 1.0); // outside of the clip volume, so the whole point is culled
+            }
+        #endif
         }
     )GLSL";
 
@@ -365,6 +377,11 @@ namespace carto { namespace vt {
     
     void GLTileRenderer::setViewState(const cglib::mat4x4<double>& projectionMatrix, const cglib::mat4x4<double>& cameraMatrix, float zoom, float aspectRatio, float resolution) {
         std::lock_guard<std::mutex> lock(*_mutex);
+
+        // Label vertex data depends on the view state, invalidate compiled label batches if anything changes
+        if (projectionMatrix != _projectionMatrix || cameraMatrix != _cameraMatrix || zoom != _zoom || aspectRatio != _viewState.aspect || resolution * 0.5f != _halfResolution) {
+            _viewStateVersion++;
+        }
         
         _projectionMatrix = projectionMatrix;
         _cameraMatrix = cameraMatrix;
@@ -388,12 +405,25 @@ namespace carto { namespace vt {
         _subTileBlending = blend;
     }
     
+    void GLTileRenderer::setFrameNr(int frameNr) {
+        std::lock_guard<std::mutex> lock(*_mutex);
+
+        _frameNr = frameNr;
+    }
+
     void GLTileRenderer::setInteractionMode(bool enabled) {
         std::lock_guard<std::mutex> lock(*_mutex);
 
         _interactionEnabled = enabled;
     }
 
+    void GLTileRenderer::setTileReloader(TileReloader tileReloader) {
+        std::lock_guard<std::mutex> lock(*_mutex);
+
+        _tileReloader = std::move(tileReloader);
+        _reloadedTiles.clear();
+    }
+
     void GLTileRenderer::setFBOClearColor(const Color& clearColor) {
         std::lock_guard<std::mutex> lock(*_mutex);
         
@@ -587,6 +617,8 @@ namespace carto { namespace vt {
                     defs.insert("TRANSFORM");
                 }
                 _patternTransformContext[i][j] = std::make_shared<std::set<std::string>>(defs);
+                defs.insert("FRAMES");
+                _framePatternTransformContext[i][j] = std::make_shared<std::set<std::string>>(defs);
             }
         }
     }
@@ -857,20 +889,58 @@ namespace carto { namespace vt {
             }
         }
 
-        // Note: we do not release unused label batches. These are unlinkely very big and can be reused later
+        // Release label batches not used in this frame, these keep the compiled labels and the bitmaps alive
+        for (auto it = _compiledLabelBatches.lower_bound(_labelBatchCounter); it != _compiledLabelBatches.end();) {
+            deleteBuffer(it->second.vertexGeometryVBO);
+            deleteBuffer(it->second.vertexUVVBO);
+            deleteBuffer(it->second.vertexColorVBO);
+            deleteBuffer(it->second.vertexIndicesVBO);
+            it = _compiledLabelBatches.erase(it);
+        }
     }
 
     bool GLTileRenderer::findGeometryIntersections(const cglib::ray3<double>& ray, std::vector<std::tuple<TileId, double, long long>>& results, float radius, bool geom2D, bool geom3D) const {
-        std::lock_guard<std::mutex> lock(*_mutex);
+        std::unique_lock<std::mutex> lock(*_mutex);
+
+        std::size_t initialResults = results.size();
+        std::vector<std::shared_ptr<const Tile>> reloadTiles;
+        findLoadedGeometryIntersections(ray, results, radius, geom2D, geom3D, reloadTiles);
+        if (!reloadTiles.empty()) {
+            // Decoding is slow and the mutex is shared with the rendering thread, so reload the tiles without holding the lock.
+            // After that redo the picking, as the visible tiles may have changed meanwhile.
+            TileReloader tileReloader = _tileReloader;
+            lock.unlock();
+            std::vector<std::pair<std::shared_ptr<const Tile>, std::shared_ptr<const Tile>>> reloadedTiles;
+            for (const std::shared_ptr<const Tile>& tile : reloadTiles) {
+                if (std::shared_ptr<const Tile> reloadedTile = tileReloader(tile)) {
+                    reloadedTiles.emplace_back(tile, reloadedTile);
+                }
+            }
+            lock.lock();
+
+            for (const std::pair<std::shared_ptr<const Tile>, std::shared_ptr<const Tile>>& reloadedTile : reloadedTiles) {
+                if (_reloadedTiles.size() >= MAX_RELOADED_TILES) {
+                    _reloadedTiles.erase(_reloadedTiles.begin());
+                }
+                _reloadedTiles.emplace_back(reloadedTile.first, reloadedTile.second);
+            }
 
+            results.erase(results.begin() + initialResults, results.end());
+            reloadTiles.clear();
+            findLoadedGeometryIntersections(ray, results, radius, geom2D, geom3D, reloadTiles);
+        }
+
+        return results.size() > initialResults;
+    }
+    
+    void GLTileRenderer::findLoadedGeometryIntersections(const cglib::ray3<double>& ray, std::vector<std::tuple<TileId, double, long long>>& results, float radius, bool geom2D, bool geom3D, std::vector<std::shared_ptr<const Tile>>& reloadTiles) const {
         // Calculate intersection with z=0 plane
         double t = 0;
         if (!cglib::intersect_plane(cglib::vec4<double>(0, 0, 1, 0), ray, &t)) {
-            return false;
+            return;
         }
 
         // First find the intersecting tile. NOTE: we ignore building height information
-        std::size_t initialResults = results.size();
         for (const std::shared_ptr<BlendNode>& blendNode : *_blendNodes) {
             std::multimap<int, RenderNode> renderNodeMap;
             if (!buildRenderNodes(*blendNode, 1.0f, renderNodeMap)) {
@@ -901,8 +971,28 @@ namespace carto { namespace vt {
                     if ((!polygon3D && geom2D) || (polygon3D && geom3D)) {
                         cglib::ray3<double> rayTile = cglib::transform_ray(ray, invTileMatrix);
 
+                        // If the vertex arrays were released after uploading, use the geometry of the reloaded tile instead.
+                        // Tiles that are not reloaded yet are returned to the caller.
+                        std::shared_ptr<TileGeometry> pickingGeometry = geometry;
+                        if (geometry->isVertexArraysReleased()) {
+                            if (!_tileReloader || !renderNode.tile) {
+                                continue;
+                            }
+                            std::shared_ptr<const Tile> reloadedTile = findReloadedTile(renderNode.tile);
+                            if (!reloadedTile) {
+                                if (std::find(reloadTiles.begin(), reloadTiles.end(), renderNode.tile) == reloadTiles.end()) {
+                                    reloadTiles.push_back(renderNode.tile);
+                                }
+                                continue;
+                            }
+                            pickingGeometry = findReloadedTileGeometry(renderNode, reloadedTile, geometry);
+                            if (!pickingGeometry) {
+                                continue;
+                            }
+                        }
+
                         std::vector<std::pair<double, long long>> resultsTile;
-                        findTileGeometryIntersections(renderNode.tileId, geometry, rayTile, static_cast<float>(radius), resultsTile);
+                        findTileGeometryIntersections(renderNode.tileId, pickingGeometry, rayTile, static_cast<float>(radius), resultsTile);
 
                         for (std::pair<double, long long> resultTile : resultsTile) {
                             long long id = resultTile.second;
@@ -927,8 +1017,6 @@ namespace carto { namespace vt {
                 }
             }
         }
-
-        return results.size() > initialResults;
     }
     
     bool GLTileRenderer::findLabelIntersections(const cglib::ray3<double>& ray, std::vector<std::tuple<TileId, double, long long>>& results, float radius, bool labels2D, bool labels3D) const {
@@ -1062,7 +1150,7 @@ namespace carto { namespace vt {
             // Add render nodes for each layer
             for (const std::shared_ptr<TileLayer>& layer : blendNode.tile->getLayers()) {
                 // Special case for raster layers - ignore global blend factor
-                RenderNode renderNode(tileId, layer, (layer->getGeometries().empty() ? blendNode.blend : blend * blendNode.blend));
+                RenderNode renderNode(tileId, blendNode.tile, layer, (layer->getGeometries().empty() ? blendNode.blend : blend * blendNode.blend));
                 addRenderNode(renderNode, renderNodeMap);
             }
             exists = true;
@@ -1143,15 +1231,69 @@ namespace carto { namespace vt {
         yAxis = cglib::transform_vector(yAxis * _viewState.scale, invTileMatrix);
     }
 
+    std::shared_ptr<const Tile> GLTileRenderer::findReloadedTile(const std::shared_ptr<const Tile>& tile) const {
+        // Find the reloaded tile, drop entries of tiles that are no longer used
+        std::shared_ptr<const Tile> reloadedTile;
+        for (auto it = _reloadedTiles.begin(); it != _reloadedTiles.end(); ) {
+            std::shared_ptr<const Tile> originalTile = it->first.lock();
+            if (!originalTile) {
+                it = _reloadedTiles.erase(it);
+                continue;
+            }
+            if (originalTile == tile) {
+                reloadedTile = it->second;
+            }
+            it++;
+        }
+        return reloadedTile;
+    }
+
+    std::shared_ptr<TileGeometry> GLTileRenderer::findReloadedTileGeometry(const RenderNode& renderNode, const std::shared_ptr<const Tile>& reloadedTile, const std::shared_ptr<TileGeometry>& geometry) const {
+        // Match the geometry by its position in the tile. The tile is decoded from the same data, so the structure must be identical
+        const std::vector<std::shared_ptr<TileLayer>>& layers = renderNode.tile->getLayers();
+        const std::vector<std::shared_ptr<TileLayer>>& reloadedLayers = reloadedTile->getLayers();
+        auto layerIt = std::find(layers.begin(), layers.end(), renderNode.layer);
+        if (layerIt == layers.end() || layers.size() != reloadedLayers.size()) {
+            return std::shared_ptr<TileGeometry>();
+        }
+        const std::vector<std::shared_ptr<TileGeometry>>& geometries = (*layerIt)->getGeometries();
+        const std::vector<std::shared_ptr<TileGeometry>>& reloadedGeometries = reloadedLayers[layerIt - layers.begin()]->getGeometries();
+        auto geometryIt = std::find(geometries.begin(), geometries.end(), geometry);
+        if (geometryIt == geometries.end() || geometries.size() != reloadedGeometries.size()) {
+            return std::shared_ptr<TileGeometry>();
+        }
+        const std::shared_ptr<TileGeometry>& reloadedGeometry = reloadedGeometries[geometryIt - geometries.begin()];
+        if (reloadedGeometry->getType() != geometry->getType() || reloadedGeometry->getIndicesCount() != geometry->getIndicesCount()) {
+            return std::shared_ptr<TileGeometry>();
+        }
+        return reloadedGeometry;
+    }
+
     void GLTileRenderer::findTileGeometryIntersections(const TileId& tileId, const std::shared_ptr<TileGeometry>& geometry, const cglib::ray3<double>& ray, float radius, std::vector<std::pair<double, long long>>& results) const {
         cglib::vec3<float> xAxis, yAxis;
         setupPointCoordinateSystem(geometry->getStyleParameters().pointOrientation, tileId, 1.0f, xAxis, yAxis);
 
-        for (std::size_t i = 0; i + 2 < geometry->getIndices().size(); i += 3) {
+        // Use the geometry index to find candidate triangles, build the index if this is the first query for the geometry
+        std::shared_ptr<const TileGeometryIndex> geometryIndex = geometry->getGeometryIndex();
+        if (!geometryIndex) {
+            geometryIndex = buildTileGeometryIndex(geometry);
+            geometry->setGeometryIndex(geometryIndex);
+        }
+
+        std::vector<unsigned int> triangles;
+        geometryIndex->findTriangles(ray, calculateTileGeometryIndexMargin(geometry, *geometryIndex, xAxis, yAxis, radius), triangles);
+
+        for (unsigned int triangle : triangles) {
+            std::size_t i = static_cast<std::size_t>(triangle) * 3;
             std::size_t index0 = geometry->getIndices()[i + 0];
             std::size_t index1 = geometry->getIndices()[i + 1];
             std::size_t index2 = geometry->getIndices()[i + 2];
 
+            // Points of other frames are not visible, so they can not be picked
+            if (geometry->getGeometryLayoutParameters().frameOffset >= 0 && std::abs(decodeFrame(geometry, index0) - _frameNr) > 0.5f) {
+                continue;
+            }
+
             cglib::vec3<float> p0 = decodeVertex(geometry, index0);
             cglib::vec3<float> p1 = decodeVertex(geometry, index1);
             cglib::vec3<float> p2 = decodeVertex(geometry, index2);
@@ -1177,16 +1319,70 @@ namespace carto { namespace vt {
 
             double t = 0;
             if (cglib::intersect_triangle(cglib::vec3<double>::convert(p0), cglib::vec3<double>::convert(p1), cglib::vec3<double>::convert(p2), ray, &t)) {
-                std::size_t counter = i;
-                for (std::size_t j = 0; j < geometry->getIds().size(); j++) {
-                    if (counter < geometry->getIds()[j].first) {
-                        results.emplace_back(t, geometry->getIds()[j].second);
-                        break;
+                long long id = 0;
+                if (geometryIndex->findFeatureId(i, id)) {
+                    results.emplace_back(t, id);
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<const TileGeometryIndex> GLTileRenderer::buildTileGeometryIndex(const std::shared_ptr<TileGeometry>& geometry) const {
+        const TileGeometry::GeometryLayoutParameters& geometryLayoutParams = geometry->getGeometryLayoutParameters();
+        bool offsets = geometry->getType() == TileGeometry::Type::POINT || geometry->getType() == TileGeometry::Type::LINE;
+
+        // Triangle bounds use the vertex positions without view dependent offsets, these are handled using query margins
+        float maxOffset = 0;
+        std::vector<cglib::bbox3<float>> triangleBounds;
+        triangleBounds.reserve(geometry->getIndices().size() / 3);
+        for (std::size_t i = 0; i + 2 < geometry->getIndices().size(); i += 3) {
+            cglib::bbox3<float> bounds = cglib::bbox3<float>::smallest();
+            for (int j = 0; j < 3; j++) {
+                std::size_t index = geometry->getIndices()[i + j];
+                cglib::vec3<float> p = decodeVertex(geometry, index);
+                if (geometry->getType() == TileGeometry::Type::POLYGON3D) {
+                    p += decodePolygon3DOffset(geometry, index);
+                }
+                bounds.add(p);
+
+                if (offsets) {
+                    std::size_t binormalOffset = index * geometryLayoutParams.vertexSize + geometryLayoutParams.binormalOffset;
+                    const short* binormalPtr = reinterpret_cast<const short*>(&geometry->getVertexGeometry()[binormalOffset]);
+                    maxOffset = std::max(maxOffset, cglib::length(cglib::vec2<float>(binormalPtr[0], binormalPtr[1])) / geometryLayoutParams.binormalScale);
+                }
+            }
+            triangleBounds.push_back(bounds);
+        }
+
+        return std::make_shared<TileGeometryIndex>(triangleBounds, geometry->getIds(), maxOffset);
+    }
+
+    float GLTileRenderer::calculateTileGeometryIndexMargin(const std::shared_ptr<TileGeometry>& geometry, const TileGeometryIndex& geometryIndex, const cglib::vec3<float>& xAxis, const cglib::vec3<float>& yAxis, float radius) const {
+        // Calculate conservative upper bound for the offsets applied in decodePointOffset/decodeLineOffset
+        const TileGeometry::StyleParameters& styleParams = geometry->getStyleParameters();
+        if (geometry->getType() == TileGeometry::Type::POINT) {
+            float offset = geometryIndex.getMaxOffset() + radius;
+            if (styleParams.transform) {
+                const cglib::mat3x3<float>& transform = styleParams.transform.get();
+                float scale = std::sqrt(transform(0, 0) * transform(0, 0) + transform(0, 1) * transform(0, 1) + transform(1, 0) * transform(1, 0) + transform(1, 1) * transform(1, 1));
+                offset = offset * scale + cglib::length(cglib::vec2<float>(transform(0, 2), transform(1, 2)));
+            }
+            return offset * (cglib::length(xAxis) + cglib::length(yAxis)) * (geometry->getGeometryScale() / geometry->getTileSize());
+        }
+        else if (geometry->getType() == TileGeometry::Type::LINE) {
+            float maxWidth = 0;
+            for (int i = 0; i < styleParams.parameterCount; i++) {
+                if (styleParams.widthTable[i]) {
+                    float width = 0.5f * std::abs((*styleParams.widthTable[i])(_viewState));
+                    if (width > 0) {
+                        width += radius;
                     }
-                    counter -= geometry->getIds()[j].first;
+                    maxWidth = std::max(maxWidth, width);
                 }
             }
+            return geometryIndex.getMaxOffset() * maxWidth * geometry->getGeometryScale() / geometry->getTileSize();
         }
+        return 0;
     }
 
     bool GLTileRenderer::findLabelIntersection(const std::shared_ptr<TileLabel>& label, const cglib::ray3<double>& ray, float radius, double& result) const {
@@ -1255,6 +1451,13 @@ namespace carto { namespace vt {
         return cglib::vec3<float>(0, 0, *heightPtr);
     }
 
+    float GLTileRenderer::decodeFrame(const std::shared_ptr<TileGeometry>& geometry, std::size_t index) const {
+        const TileGeometry::GeometryLayoutParameters& geometryLayoutParams = geometry->getGeometryLayoutParameters();
+        std::size_t frameOffset = index * geometryLayoutParams.vertexSize + geometryLayoutParams.frameOffset;
+        const float* framePtr = reinterpret_cast<const float*>(&geometry->getVertexGeometry()[frameOffset]);
+        return *framePtr;
+    }
+
     bool GLTileRenderer::renderBlendNodes2D(const std::vector<std::shared_ptr<BlendNode>>& blendNodes) {
         GLint stencilBits = 0;
         if (_useStencil) {
@@ -1445,7 +1648,9 @@ namespace carto { namespace vt {
     
     bool GLTileRenderer::renderLabels(const std::shared_ptr<const Bitmap>& bitmap, const std::vector<std::shared_ptr<TileLabel>>& labels) {
         bool update = false;
-        
+
+        std::vector<const std::shared_ptr<TileLabel>*> visibleLabels;
+        visibleLabels.reserve(labels.size());
         for (const std::shared_ptr<TileLabel>& label : labels) {
             if (!label->isValid()) {
                 continue;
@@ -1454,19 +1659,33 @@ namespace carto { namespace vt {
                 continue;
             }
             
-            std::size_t verticesSize = _labelVertices.size();
-            label->calculateVertexData(_viewState, _labelVertices, _labelTexCoords, _labelIndices);
-            Color color = Color::fromColorOpacity(label->getColor(), label->getOpacity());
-            _labelColors.fill(color.rgba(), _labelVertices.size() - verticesSize);
-
-            if (_labelVertices.size() >= 32768) { // flush the batch if largest vertex index is getting 'close' to 64k limit
-                renderLabelBatch(bitmap);
-            }
+            visibleLabels.push_back(&label);
             
             update = label->getOpacity() < 1.0f || update;
         }
 
-        renderLabelBatch(bitmap);
+        // Reuse label batches from the previous frame if possible, otherwise rebuild them
+        for (std::size_t labelIndex = 0; labelIndex < visibleLabels.size(); ) {
+            auto itBatch = _compiledLabelBatches.find(_labelBatchCounter);
+            if (itBatch == _compiledLabelBatches.end()) {
+                CompiledLabelBatch compiledLabelBatch;
+                compiledLabelBatch.vertexGeometryVBO = createBuffer();
+                compiledLabelBatch.vertexUVVBO = createBuffer();
+                compiledLabelBatch.vertexColorVBO = createBuffer();
+                compiledLabelBatch.vertexIndicesVBO = createBuffer();
+
+                itBatch = _compiledLabelBatches.emplace(_labelBatchCounter, std::move(compiledLabelBatch)).first;
+            }
+            _labelBatchCounter++;
+
+            CompiledLabelBatch& compiledLabelBatch = itBatch->second;
+            if (!updateLabelBatch(compiledLabelBatch, bitmap, visibleLabels, labelIndex)) {
+                buildLabelBatch(compiledLabelBatch, bitmap, visibleLabels, labelIndex);
+            }
+            labelIndex += compiledLabelBatch.labels.size();
+
+            renderLabelBatch(compiledLabelBatch, bitmap);
+        }
 
         return update;
     }
@@ -1709,7 +1928,12 @@ namespace carto { namespace vt {
         GLuint shaderProgram = 0;
         switch (geometry->getType()) {
             case TileGeometry::Type::POINT:
-                shaderProgram = _shaderManager.createProgram("point", _patternTransformContext[styleParams.pattern ? 1 : 0][styleParams.transform ? 1 : 0]);
+                if (geometryLayoutParams.frameOffset >= 0) {
+                    shaderProgram = _shaderManager.createProgram("point", _framePatternTransformContext[styleParams.pattern ? 1 : 0][styleParams.transform ? 1 : 0]);
+                }
+                else {
+                    shaderProgram = _shaderManager.createProgram("point", _patternTransformContext[styleParams.pattern ? 1 : 0][styleParams.transform ? 1 : 0]);
+                }
                 break;
             case TileGeometry::Type::LINE:
                 shaderProgram = _shaderManager.createProgram("line", _patternTransformContext[styleParams.pattern ? 1 : 0][styleParams.transform ? 1 : 0]);
@@ -1741,8 +1965,8 @@ namespace carto { namespace vt {
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, compiledGeometry.indicesVBO);
             glBufferData(GL_ELEMENT_ARRAY_BUFFER, geometry->getIndices().size() * sizeof(unsigned short), geometry->getIndices().data(), GL_STATIC_DRAW);
             
-            if (!_interactionEnabled) {
-                geometry->releaseVertexArrays(); // if interaction is enabled, we must keep the vertex arrays. Otherwise optimize for lower memory usage
+            if (!_interactionEnabled || _tileReloader) {
+                geometry->releaseVertexArrays(); // if interaction is enabled, we must keep the vertex arrays, unless they can be reloaded. Otherwise optimize for lower memory usage
             }
             
             _compiledTileGeometryMap[geometry] = compiledGeometry;
@@ -1817,6 +2041,9 @@ namespace carto { namespace vt {
             glUniform1f(glGetUniformLocation(shaderProgram, "uBinormalScale"), geometry->getGeometryScale() / geometry->getTileSize() / geometryLayoutParams.binormalScale);
             glUniform3fv(glGetUniformLocation(shaderProgram, "uXAxis"), 1, xAxis.data());
             glUniform3fv(glGetUniformLocation(shaderProgram, "uYAxis"), 1, yAxis.data());
+            if (geometryLayoutParams.frameOffset >= 0) {
+                glUniform1f(glGetUniformLocation(shaderProgram, "uFrame"), static_cast<float>(_frameNr));
+            }
         }
         else if (geometry->getType() == TileGeometry::Type::LINE) {
             float gamma = 0.5f;
@@ -1872,6 +2099,11 @@ namespace carto { namespace vt {
                 glEnableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexHeight"));
             }
             
+            if (geometryLayoutParams.frameOffset >= 0) {
+                glVertexAttribPointer(glGetAttribLocation(shaderProgram, "aVertexFrame"), 1, GL_FLOAT, GL_FALSE, geometryLayoutParams.vertexSize, reinterpret_cast<const GLvoid*>(geometryLayoutParams.frameOffset));
+                glEnableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexFrame"));
+            }
+            
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, compiledGeometry.indicesVBO);
         }
         
@@ -1883,6 +2115,10 @@ namespace carto { namespace vt {
         else {
             glDisableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexAttribs"));
             
+            if (geometryLayoutParams.frameOffset >= 0) {
+                glDisableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexFrame"));
+            }
+            
             if (geometryLayoutParams.heightOffset >= 0) {
                 glDisableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexHeight"));
             }
@@ -1902,25 +2138,124 @@ namespace carto { namespace vt {
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
-    void GLTileRenderer::renderLabelBatch(const std::shared_ptr<const Bitmap>& bitmap) {
-        if (_labelIndices.empty()) {
-            return;
+    bool GLTileRenderer::updateLabelBatch(CompiledLabelBatch& labelBatch, const std::shared_ptr<const Bitmap>& bitmap, const std::vector<const std::shared_ptr<TileLabel>*>& labels, std::size_t labelIndex) {
+        if (labelBatch.bitmap != bitmap || labelBatch.viewStateVersion != _viewStateVersion || labelBatch.labels.empty()) {
+            return false;
+        }
+        if (labelIndex + labelBatch.labels.size() > labels.size()) {
+            return false;
         }
+        for (std::size_t i = 0; i < labelBatch.labels.size(); i++) {
+            if (labelBatch.labels[i].label != *labels[labelIndex + i]) {
+                return false;
+            }
+        }
+
+        // Same labels and view state, only re-tessellate labels with changed placement and update colors
+        bool updateColors = false;
+        for (CompiledLabel& compiledLabel : labelBatch.labels) {
+            const std::shared_ptr<TileLabel>& label = compiledLabel.label;
+            if (label->getPlacementVersion() != compiledLabel.placementVersion) {
+                _labelVertices.clear();
+                _labelTexCoords.clear();
+                _labelIndices.clear();
+                label->calculateVertexData(_viewState, _labelVertices, _labelTexCoords, _labelIndices);
+                if (_labelVertices.size() != compiledLabel.vertexCount || _labelIndices.size() != compiledLabel.indexCount) {
+                    return false;
+                }
 
-        CompiledLabelBatch compiledLabelBatch;
-        auto itBatch = _compiledLabelBatches.find(_labelBatchCounter);
-        if (itBatch == _compiledLabelBatches.end()) {
-            compiledLabelBatch.vertexGeometryVBO = createBuffer();
-            compiledLabelBatch.vertexUVVBO = createBuffer();
-            compiledLabelBatch.vertexColorVBO = createBuffer();
-            compiledLabelBatch.vertexIndicesVBO = createBuffer();
+                for (unsigned short* it = _labelIndices.begin(); it != _labelIndices.end(); it++) {
+                    *it += static_cast<unsigned short>(compiledLabel.vertexOffset);
+                }
 
-            _compiledLabelBatches[_labelBatchCounter] = compiledLabelBatch;
+                glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexGeometryVBO);
+                glBufferSubData(GL_ARRAY_BUFFER, compiledLabel.vertexOffset * 3 * sizeof(float), _labelVertices.size() * 3 * sizeof(float), _labelVertices.data());
+                glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexUVVBO);
+                glBufferSubData(GL_ARRAY_BUFFER, compiledLabel.vertexOffset * 2 * sizeof(float), _labelTexCoords.size() * 2 * sizeof(float), _labelTexCoords.data());
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, labelBatch.vertexIndicesVBO);
+                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, compiledLabel.indexOffset * sizeof(unsigned short), _labelIndices.size() * sizeof(unsigned short), _labelIndices.data());
+                
+                compiledLabel.placementVersion = label->getPlacementVersion();
+            }
+
+            cglib::vec4<float> color = Color::fromColorOpacity(label->getColor(), label->getOpacity()).rgba();
+            if (color != compiledLabel.color) {
+                compiledLabel.color = color;
+                updateColors = true;
+            }
         }
-        else {
-            compiledLabelBatch = itBatch->second;
+
+        if (updateColors) {
+            _labelColors.clear();
+            for (const CompiledLabel& compiledLabel : labelBatch.labels) {
+                _labelColors.fill(compiledLabel.color, compiledLabel.vertexCount);
+            }
+
+            glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexColorVBO);
+            glBufferSubData(GL_ARRAY_BUFFER, 0, _labelColors.size() * 4 * sizeof(float), _labelColors.data());
+        }
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        _labelVertices.clear();
+        _labelTexCoords.clear();
+        _labelColors.clear();
+        _labelIndices.clear();
+        return true;
+    }
+
+    void GLTileRenderer::buildLabelBatch(CompiledLabelBatch& labelBatch, const std::shared_ptr<const Bitmap>& bitmap, const std::vector<const std::shared_ptr<TileLabel>*>& labels, std::size_t labelIndex) {
+        _labelVertices.clear();
+        _labelTexCoords.clear();
+        _labelColors.clear();
+        _labelIndices.clear();
+
+        labelBatch.labels.clear();
+        for (std::size_t i = labelIndex; i < labels.size(); i++) {
+            const std::shared_ptr<TileLabel>& label = *labels[i];
+
+            std::size_t verticesSize = _labelVertices.size();
+            std::size_t indicesSize = _labelIndices.size();
+            label->calculateVertexData(_viewState, _labelVertices, _labelTexCoords, _labelIndices);
+            cglib::vec4<float> color = Color::fromColorOpacity(label->getColor(), label->getOpacity()).rgba();
+            _labelColors.fill(color, _labelVertices.size() - verticesSize);
+
+            labelBatch.labels.emplace_back(label, label->getPlacementVersion(), color, verticesSize, _labelVertices.size() - verticesSize, indicesSize, _labelIndices.size() - indicesSize);
+
+            if (_labelVertices.size() >= 32768) { // close the batch if largest vertex index is getting 'close' to 64k limit
+                break;
+            }
+        }
+        labelBatch.bitmap = bitmap;
+        labelBatch.viewStateVersion = _viewStateVersion;
+        labelBatch.indexCount = _labelIndices.size();
+
+        glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexGeometryVBO);
+        glBufferData(GL_ARRAY_BUFFER, _labelVertices.size() * 3 * sizeof(float), _labelVertices.data(), GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexUVVBO);
+        glBufferData(GL_ARRAY_BUFFER, _labelTexCoords.size() * 2 * sizeof(float), _labelTexCoords.data(), GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexColorVBO);
+        glBufferData(GL_ARRAY_BUFFER, _labelColors.size() * 4 * sizeof(float), _labelColors.data(), GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, labelBatch.vertexIndicesVBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, _labelIndices.size() * sizeof(unsigned short), _labelIndices.data(), GL_DYNAMIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        _labelVertices.clear();
+        _labelTexCoords.clear();
+        _labelColors.clear();
+        _labelIndices.clear();
+    }
+
+    void GLTileRenderer::renderLabelBatch(const CompiledLabelBatch& labelBatch, const std::shared_ptr<const Bitmap>& bitmap) {
+        if (labelBatch.indexCount == 0) {
+            return;
         }
-        _labelBatchCounter++;
 
         CompiledBitmap compiledBitmap;
         auto itBitmap = _compiledBitmapMap.find(bitmap);
@@ -1954,30 +2289,26 @@ namespace carto { namespace vt {
         cglib::mat4x4<float> mvpMatrix = cglib::mat4x4<float>::convert(_projectionMatrix * _labelMatrix);
         glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "uMVPMatrix"), 1, GL_FALSE, mvpMatrix.data());
 
-        glBindBuffer(GL_ARRAY_BUFFER, compiledLabelBatch.vertexGeometryVBO);
-        glBufferData(GL_ARRAY_BUFFER, _labelVertices.size() * 3 * sizeof(float), _labelVertices.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexGeometryVBO);
         glVertexAttribPointer(glGetAttribLocation(shaderProgram, "aVertexPosition"), 3, GL_FLOAT, GL_FALSE, 0, 0);
         glEnableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexPosition"));
 
-        glBindBuffer(GL_ARRAY_BUFFER, compiledLabelBatch.vertexUVVBO);
-        glBufferData(GL_ARRAY_BUFFER, _labelTexCoords.size() * 2 * sizeof(float), _labelTexCoords.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexUVVBO);
         glVertexAttribPointer(glGetAttribLocation(shaderProgram, "aVertexUV"), 2, GL_FLOAT, GL_FALSE, 0, 0);
         glEnableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexUV"));
 
-        glBindBuffer(GL_ARRAY_BUFFER, compiledLabelBatch.vertexColorVBO);
-        glBufferData(GL_ARRAY_BUFFER, _labelColors.size() * 4 * sizeof(float), _labelColors.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, labelBatch.vertexColorVBO);
         glVertexAttribPointer(glGetAttribLocation(shaderProgram, "aVertexColor"), 4, GL_FLOAT, GL_FALSE, 0, 0);
         glEnableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexColor"));
 
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, compiledLabelBatch.vertexIndicesVBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, _labelIndices.size() * sizeof(unsigned short), _labelIndices.data(), GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, labelBatch.vertexIndicesVBO);
 
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, compiledBitmap.texture);
         glUniform1i(glGetUniformLocation(shaderProgram, "uBitmap"), 0);
         glUniform2f(glGetUniformLocation(shaderProgram, "uUVScale"), 1.0f / bitmap->width, 1.0f / bitmap->height);
 
-        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(_labelIndices.size()), GL_UNSIGNED_SHORT, 0);
+        glDrawElements(GL_TRIANGLES, static_cast<unsigned int>(labelBatch.indexCount), GL_UNSIGNED_SHORT, 0);
 
         glDisableVertexAttribArray(glGetAttribLocation(shaderProgram, "aVertexColor"));
 
@@ -1987,11 +2318,6 @@ namespace carto { namespace vt {
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        _labelVertices.clear();
-        _labelTexCoords.clear();
-        _labelColors.clear();
-        _labelIndices.clear();
     }
 
     void GLTileRenderer::setBlendState(CompOp compOp) {
@@ -22,18 +22,23 @@
 #include <unordered_map>
 #include <utility>
 #include <mutex>
+#include <functional>
 
 #include <cglib/ray.h>
 
 namespace carto { namespace vt {
     class GLTileRenderer final {
     public:
+        using TileReloader = std::function<std::shared_ptr<const Tile>(const std::shared_ptr<const Tile>&)>;
+
         explicit GLTileRenderer(std::shared_ptr<std::mutex> mutex, std::shared_ptr<GLExtensions> glExtensions, float scale, bool useFBO, bool useDepth, bool useStencil);
 
         void setViewState(const cglib::mat4x4<double>& projectionMatrix, const cglib::mat4x4<double>& cameraMatrix, float zoom, float aspectRatio, float resolution);
         void setLightDir(const cglib::vec3<float>& lightDir);
         void setSubTileBlending(bool blend);
+        void setFrameNr(int frameNr);
         void setInteractionMode(bool enabled);
+        void setTileReloader(TileReloader tileReloader);
         void setFBOClearColor(const Color& clearColor);
         void setBackgroundColor(const Color& backgroundColor);
         void setBackgroundPattern(std::shared_ptr<const BitmapPattern> pattern);
@@ -67,11 +72,12 @@ namespace carto { namespace vt {
 
         struct RenderNode {
             TileId tileId;
+            std::shared_ptr<const Tile> tile;
             std::shared_ptr<const TileLayer> layer;
             float initialBlend;
             float blend;
 
-            explicit RenderNode(const TileId& tileId, std::shared_ptr<const TileLayer> layer, float blend) : tileId(tileId), layer(std::move(layer)), initialBlend(blend), blend(blend) { }
+            explicit RenderNode(const TileId& tileId, std::shared_ptr<const Tile> tile, std::shared_ptr<const TileLayer> layer, float blend) : tileId(tileId), tile(std::move(tile)), layer(std::move(layer)), initialBlend(blend), blend(blend) { }
         };
 
         struct LayerFBO {
@@ -117,13 +123,29 @@ namespace carto { namespace vt {
             CompiledGeometry() : vertexGeometryVBO(0), indicesVBO(0), geometryVAO(0) { }
         };
 
+        struct CompiledLabel {
+            std::shared_ptr<TileLabel> label;
+            unsigned int placementVersion;
+            cglib::vec4<float> color;
+            std::size_t vertexOffset;
+            std::size_t vertexCount;
+            std::size_t indexOffset;
+            std::size_t indexCount;
+
+            explicit CompiledLabel(std::shared_ptr<TileLabel> label, unsigned int placementVersion, const cglib::vec4<float>& color, std::size_t vertexOffset, std::size_t vertexCount, std::size_t indexOffset, std::size_t indexCount) : label(std::move(label)), placementVersion(placementVersion), color(color), vertexOffset(vertexOffset), vertexCount(vertexCount), indexOffset(indexOffset), indexCount(indexCount) { }
+        };
+
         struct CompiledLabelBatch {
             GLuint vertexGeometryVBO;
             GLuint vertexUVVBO;
             GLuint vertexColorVBO;
             GLuint vertexIndicesVBO;
+            std::shared_ptr<const Bitmap> bitmap;
+            unsigned int viewStateVersion;
+            std::size_t indexCount;
+            std::vector<CompiledLabel> labels;
 
-            CompiledLabelBatch() : vertexGeometryVBO(0), vertexUVVBO(0), vertexColorVBO(0), vertexIndicesVBO(0) { }
+            CompiledLabelBatch() : vertexGeometryVBO(0), vertexUVVBO(0), vertexColorVBO(0), vertexIndicesVBO(0), bitmap(), viewStateVersion(0), indexCount(0), labels() { }
         };
 
         struct LabelHash {
@@ -149,13 +171,19 @@ namespace carto { namespace vt {
 
         void setupPointCoordinateSystem(PointOrientation orientation, const TileId& tileId, float vertexScale, cglib::vec3<float>& xAxis, cglib::vec3<float>& yAxis) const;
 
+        void findLoadedGeometryIntersections(const cglib::ray3<double>& ray, std::vector<std::tuple<TileId, double, long long>>& results, float radius, bool geom2D, bool geom3D, std::vector<std::shared_ptr<const Tile>>& reloadTiles) const;
+        std::shared_ptr<const Tile> findReloadedTile(const std::shared_ptr<const Tile>& tile) const;
+        std::shared_ptr<TileGeometry> findReloadedTileGeometry(const RenderNode& renderNode, const std::shared_ptr<const Tile>& reloadedTile, const std::shared_ptr<TileGeometry>& geometry) const;
         void findTileGeometryIntersections(const TileId& tileId, const std::shared_ptr<TileGeometry>& geometry, const cglib::ray3<double>& ray, float radius, std::vector<std::pair<double, long long>>& results) const;
+        std::shared_ptr<const TileGeometryIndex> buildTileGeometryIndex(const std::shared_ptr<TileGeometry>& geometry) const;
+        float calculateTileGeometryIndexMargin(const std::shared_ptr<TileGeometry>& geometry, const TileGeometryIndex& geometryIndex, const cglib::vec3<float>& xAxis, const cglib::vec3<float>& yAxis, float radius) const;
         bool findLabelIntersection(const std::shared_ptr<TileLabel>& label, const cglib::ray3<double>& ray, float radius, double& result) const;
 
         cglib::vec3<float> decodeVertex(const std::shared_ptr<TileGeometry>& geometry, std::size_t index) const;
         cglib::vec3<float> decodePointOffset(const std::shared_ptr<TileGeometry>& geometry, std::size_t index, const cglib::vec3<float>& xAxis, const cglib::vec3<float>& yAxis, float radius) const;
         cglib::vec3<float> decodeLineOffset(const std::shared_ptr<TileGeometry>& geometry, std::size_t index, float radius) const;
         cglib::vec3<float> decodePolygon3DOffset(const std::shared_ptr<TileGeometry>& geometry, std::size_t index) const;
+        float decodeFrame(const std::shared_ptr<TileGeometry>& geometry, std::size_t index) const;
 
         bool renderBlendNodes2D(const std::vector<std::shared_ptr<BlendNode>>& blendNodes);
         bool renderBlendNodes3D(const std::vector<std::shared_ptr<BlendNode>>& blendNodes);
@@ -167,7 +195,9 @@ namespace carto { namespace vt {
         void renderTileBackground(const TileId& tileId, float opacity);
         void renderTileBitmap(const TileId& tileId, const TileId& targetTileId, float blend, float opacity, const std::shared_ptr<TileBitmap>& bitmap);
         void renderTileGeometry(const TileId& tileId, const TileId& targetTileId, float blend, float opacity, const std::shared_ptr<TileGeometry>& geometry);
-        void renderLabelBatch(const std::shared_ptr<const Bitmap>& bitmap);
+        bool updateLabelBatch(CompiledLabelBatch& labelBatch, const std::shared_ptr<const Bitmap>& bitmap, const std::vector<const std::shared_ptr<TileLabel>*>& labels, std::size_t labelIndex);
+        void buildLabelBatch(CompiledLabelBatch& labelBatch, const std::shared_ptr<const Bitmap>& bitmap, const std::vector<const std::shared_ptr<TileLabel>*>& labels, std::size_t labelIndex);
+        void renderLabelBatch(const CompiledLabelBatch& labelBatch, const std::shared_ptr<const Bitmap>& bitmap);
         void setBlendState(CompOp compOp);
         bool isEmptyBlendRequired(CompOp compOp) const;
         void checkGLError();
@@ -187,13 +217,19 @@ namespace carto { namespace vt {
         ScreenVBO createScreenVBO();
         void deleteScreenVBO(ScreenVBO& screenVBO);
 
+        constexpr static std::size_t MAX_RELOADED_TILES = 4; // reloading is relatively slow, so keep tiles that were picked recently
+
         bool _subTileBlending = false;
+        int _frameNr = 0;
         bool _interactionEnabled = false;
+        TileReloader _tileReloader;
+        mutable std::vector<std::pair<std::weak_ptr<const Tile>, std::shared_ptr<const Tile>>> _reloadedTiles; // original tile, tile with vertex arrays for picking
         Color _fboClearColor;
         Color _backgroundColor;
         std::shared_ptr<const BitmapPattern> _backgroundPattern;
 
         GLShaderManager::ShaderContext _patternTransformContext[2][2];
+        GLShaderManager::ShaderContext _framePatternTransformContext[2][2];
         GLShaderManager _shaderManager;
 
         std::vector<LayerFBO> _layerFBOs;
@@ -209,6 +245,7 @@ namespace carto { namespace vt {
         cglib::frustum3<double> _frustum;
         cglib::mat4x4<double> _labelMatrix;
         ViewState _viewState;
+        unsigned int _viewStateVersion = 1;
         VertexArray<cglib::vec3<float>> _labelVertices;
         VertexArray<cglib::vec2<float>> _labelTexCoords;
         VertexArray<cglib::vec4<float>> _labelColors;
@@ -12,10 +12,13 @@
 #include "StrokeMap.h"
 #include "VertexArray.h"
 #include "Styles.h"
+#include "TileGeometryIndex.h"
 
 #include <memory>
 #include <array>
 #include <vector>
+#include <mutex>
+#include <algorithm>
 
 #include <boost/optional.hpp>
 
@@ -50,14 +53,15 @@ namespace carto { namespace vt {
             int texCoordOffset;
             int binormalOffset;
             int heightOffset;
+            int frameOffset;
             float vertexScale;
             float texCoordScale;
             float binormalScale;
 
-            GeometryLayoutParameters() : vertexSize(0), vertexOffset(-1), attribsOffset(-1), texCoordOffset(-1), binormalOffset(-1), heightOffset(-1), vertexScale(0), texCoordScale(0), binormalScale(0) { }
+            GeometryLayoutParameters() : vertexSize(0), vertexOffset(-1), attribsOffset(-1), texCoordOffset(-1), binormalOffset(-1), heightOffset(-1), frameOffset(-1), vertexScale(0), texCoordScale(0), binormalScale(0) { }
         };
 
-        explicit TileGeometry(Type type, float tileSize, float geomScale, const StyleParameters& styleParameters, const GeometryLayoutParameters& geometryLayoutParameters, VertexArray<unsigned char> vertexGeometry, VertexArray<unsigned short> indices, std::vector<std::pair<unsigned int, long long>> ids) : _type(type), _tileSize(tileSize), _geomScale(geomScale), _styleParameters(styleParameters), _geometryLayoutParameters(geometryLayoutParameters), _indicesCount(0), _vertexGeometry(std::move(vertexGeometry)), _indices(std::move(indices)), _ids(std::move(ids)) { _indicesCount = static_cast<unsigned int>(_indices.size()); }
+        explicit TileGeometry(Type type, float tileSize, float geomScale, const StyleParameters& styleParameters, const GeometryLayoutParameters& geometryLayoutParameters, VertexArray<unsigned char> vertexGeometry, VertexArray<unsigned short> indices, std::vector<std::pair<unsigned int, long long>> ids, std::vector<std::pair<int, unsigned int>> frameFeatureCounts) : _type(type), _tileSize(tileSize), _geomScale(geomScale), _styleParameters(styleParameters), _geometryLayoutParameters(geometryLayoutParameters), _indicesCount(0), _vertexGeometry(std::move(vertexGeometry)), _indices(std::move(indices)), _ids(std::move(ids)), _frameFeatureCounts(std::move(frameFeatureCounts)) { _indicesCount = static_cast<unsigned int>(_indices.size()); }
 
         Type getType() const { return _type; }
         float getTileSize() const { return _tileSize; }
@@ -70,6 +74,18 @@ namespace carto { namespace vt {
         const VertexArray<unsigned short>& getIndices() const { return _indices; }
         const std::vector<std::pair<unsigned int, long long>>& getIds() const { return _ids; }
 
+        std::shared_ptr<const TileGeometryIndex> getGeometryIndex() const {
+            std::lock_guard<std::mutex> lock(_geometryIndexMutex);
+            return _geometryIndex;
+        }
+
+        void setGeometryIndex(std::shared_ptr<const TileGeometryIndex> geometryIndex) {
+            std::lock_guard<std::mutex> lock(_geometryIndexMutex);
+            _geometryIndex = std::move(geometryIndex);
+        }
+
+        bool isVertexArraysReleased() const { return _indices.empty() && _indicesCount > 0; }
+
         void releaseVertexArrays() {
             _vertexGeometry.clear();
             _vertexGeometry.shrink_to_fit();
@@ -92,8 +108,20 @@ namespace carto { namespace vt {
             }
         }
 
+        std::size_t getFeatureCount(int frame) const {
+            if (_geometryLayoutParameters.frameOffset < 0) {
+                return getFeatureCount();
+            }
+            auto it = std::lower_bound(_frameFeatureCounts.begin(), _frameFeatureCounts.end(), frame, [](const std::pair<int, unsigned int>& frameFeatureCount, int frame) { return frameFeatureCount.first < frame; });
+            return it != _frameFeatureCounts.end() && it->first == frame ? it->second : 0;
+        }
+
+        std::size_t getVertexArraysSize() const {
+            return _vertexGeometry.size() * sizeof(unsigned char) + _indices.size() * sizeof(unsigned short) + _ids.size() * sizeof(std::pair<unsigned int, long long>);
+        }
+
         std::size_t getResidentSize() const {
-            return 16 + _vertexGeometry.size() * sizeof(unsigned char) + _indices.size() * sizeof(unsigned short) + _ids.size() * sizeof(std::pair<unsigned int, long long>);
+            return 16 + getVertexArraysSize() + _frameFeatureCounts.size() * sizeof(std::pair<int, unsigned int>);
         }
 
     private:
@@ -107,6 +135,10 @@ namespace carto { namespace vt {
         VertexArray<unsigned char> _vertexGeometry;
         VertexArray<unsigned short> _indices;
         std::vector<std::pair<unsigned int, long long>> _ids; // vertex count, feature id
+        std::vector<std::pair<int, unsigned int>> _frameFeatureCounts; // frame, feature count. Sorted by frame, only used if vertices have frame attributes
+
+        std::shared_ptr<const TileGeometryIndex> _geometryIndex; // built lazily when geometry is picked for the first time
+        mutable std::mutex _geometryIndexMutex;
     };
 } }
 
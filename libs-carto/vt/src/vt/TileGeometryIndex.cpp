@@ -0,0 +1,101 @@
+#include "TileGeometryIndex.h"
+
+#include <algorithm>
+
+namespace carto { namespace vt {
+    TileGeometryIndex::TileGeometryIndex(const std::vector<cglib::bbox3<float>>& triangleBounds, const std::vector<std::pair<unsigned int, long long>>& ids, float maxOffset) :
+        _maxOffset(maxOffset), _nodes(), _triangles(), _idOffsets(), _ids()
+    {
+        _idOffsets.reserve(ids.size());
+        _ids.reserve(ids.size());
+        std::size_t idOffset = 0;
+        for (const std::pair<unsigned int, long long>& id : ids) {
+            idOffset += id.first;
+            _idOffsets.push_back(idOffset);
+            _ids.push_back(id.second);
+        }
+
+        if (triangleBounds.empty()) {
+            return;
+        }
+
+        std::vector<cglib::vec3<float>> centers;
+        centers.reserve(triangleBounds.size());
+        _triangles.reserve(triangleBounds.size());
+        for (std::size_t i = 0; i < triangleBounds.size(); i++) {
+            centers.push_back((triangleBounds[i].min + triangleBounds[i].max) * 0.5f);
+            _triangles.push_back(static_cast<unsigned int>(i));
+        }
+
+        _nodes.reserve(2 * (triangleBounds.size() / MAX_LEAF_TRIANGLES + 1));
+        buildNode(triangleBounds, centers, 0, static_cast<unsigned int>(_triangles.size()));
+    }
+
+    void TileGeometryIndex::findTriangles(const cglib::ray3<double>& ray, float margin, std::vector<unsigned int>& triangles) const {
+        if (_nodes.empty()) {
+            return;
+        }
+
+        cglib::vec3<double> marginVec(margin, margin, margin);
+        std::vector<unsigned int> stack;
+        stack.push_back(0);
+        while (!stack.empty()) {
+            const Node& node = _nodes[stack.back()];
+            unsigned int nodeIndex = stack.back();
+            stack.pop_back();
+
+            cglib::bbox3<double> bounds(cglib::vec3<double>::convert(node.bounds.min) - marginVec, cglib::vec3<double>::convert(node.bounds.max) + marginVec);
+            if (!cglib::intersect_bbox(bounds, ray)) {
+                continue;
+            }
+
+            if (node.count > 0) {
+                triangles.insert(triangles.end(), _triangles.begin() + node.first, _triangles.begin() + node.first + node.count);
+            }
+            else {
+                stack.push_back(node.first);
+                stack.push_back(nodeIndex + 1);
+            }
+        }
+    }
+
+    bool TileGeometryIndex::findFeatureId(std::size_t indexOffset, long long& id) const {
+        auto it = std::upper_bound(_idOffsets.begin(), _idOffsets.end(), indexOffset);
+        if (it == _idOffsets.end()) {
+            return false;
+        }
+        id = _ids[it - _idOffsets.begin()];
+        return true;
+    }
+
+    unsigned int TileGeometryIndex::buildNode(const std::vector<cglib::bbox3<float>>& triangleBounds, const std::vector<cglib::vec3<float>>& centers, unsigned int begin, unsigned int end) {
+        cglib::bbox3<float> bounds = cglib::bbox3<float>::smallest();
+        cglib::bbox3<float> centerBounds = cglib::bbox3<float>::smallest();
+        for (unsigned int i = begin; i < end; i++) {
+            bounds.add(triangleBounds[_triangles[i]].min);
+            bounds.add(triangleBounds[_triangles[i]].max);
+            centerBounds.add(centers[_triangles[i]]);
+        }
+
+        unsigned int nodeIndex = static_cast<unsigned int>(_nodes.size());
+        _nodes.emplace_back(bounds);
+        if (end - begin <= MAX_LEAF_TRIANGLES) {
+            _nodes[nodeIndex].first = begin;
+            _nodes[nodeIndex].count = end - begin;
+            return nodeIndex;
+        }
+
+        // Split at the median along the longest axis of the triangle centers
+        cglib::vec3<float> size = centerBounds.max - centerBounds.min;
+        int axis = (size(0) >= size(1) && size(0) >= size(2)) ? 0 : (size(1) >= size(2) ? 1 : 2);
+        unsigned int mid = begin + (end - begin) / 2;
+        std::nth_element(_triangles.begin() + begin, _triangles.begin() + mid, _triangles.begin() + end, [&centers, axis](unsigned int triangle1, unsigned int triangle2) {
+            return centers[triangle1](axis) < centers[triangle2](axis);
+        });
+
+        buildNode(triangleBounds, centers, begin, mid);
+        unsigned int secondChild = buildNode(triangleBounds, centers, mid, end);
+        _nodes[nodeIndex].first = secondChild;
+        return nodeIndex;
+    }
+} }
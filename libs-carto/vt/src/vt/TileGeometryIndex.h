@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_VT_TILEGEOMETRYINDEX_H_
+#define _CARTO_VT_TILEGEOMETRYINDEX_H_
+
+#include <vector>
+#include <utility>
+
+#include <cglib/vec.h>
+#include <cglib/bbox.h>
+#include <cglib/ray.h>
+
+namespace carto { namespace vt {
+    class TileGeometryIndex final {
+    public:
+        // Builds bounding volume hierarchy from triangle bounds (one per triangle of the index buffer).
+        // maxOffset is geometry specific maximum vertex offset length that is needed for calculating query margins.
+        explicit TileGeometryIndex(const std::vector<cglib::bbox3<float>>& triangleBounds, const std::vector<std::pair<unsigned int, long long>>& ids, float maxOffset);
+
+        float getMaxOffset() const { return _maxOffset; }
+
+        // Finds all triangles whose bounds, expanded by margin, intersect the ray. Triangle indices are returned, not index buffer offsets.
+        void findTriangles(const cglib::ray3<double>& ray, float margin, std::vector<unsigned int>& triangles) const;
+
+        // Finds the feature id of the triangle with given index buffer offset
+        bool findFeatureId(std::size_t indexOffset, long long& id) const;
+
+        std::size_t getResidentSize() const {
+            return 16 + _nodes.size() * sizeof(Node) + _triangles.size() * sizeof(unsigned int) + _idOffsets.size() * sizeof(std::size_t) + _ids.size() * sizeof(long long);
+        }
+
+    private:
+        constexpr static unsigned int MAX_LEAF_TRIANGLES = 4;
+
+        struct Node {
+            cglib::bbox3<float> bounds;
+            unsigned int first; // first triangle in leaf nodes, second child index in inner nodes
+            unsigned int count; // zero for inner nodes
+
+            explicit Node(const cglib::bbox3<float>& bounds) : bounds(bounds), first(0), count(0) { }
+        };
+
+        unsigned int buildNode(const std::vector<cglib::bbox3<float>>& triangleBounds, const std::vector<cglib::vec3<float>>& centers, unsigned int begin, unsigned int end);
+
+        float _maxOffset;
+        std::vector<Node> _nodes;
+        std::vector<unsigned int> _triangles;
+        std::vector<std::size_t> _idOffsets; // prefix sums of index counts
+        std::vector<long long> _ids;
+    };
+} }
+
+#endif
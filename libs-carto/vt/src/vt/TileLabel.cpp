@@ -44,6 +44,8 @@ namespace carto { namespace vt {
     }
 
     void TileLabel::mergeGeometries(TileLabel& label) {
+        _placementVersion++;
+
         for (Vertex& labelVertex : label._transformedPositions) {
             if (std::find(_transformedPositions.begin(), _transformedPositions.end(), labelVertex) == _transformedPositions.end()) {
                 _transformedPositions.push_back(labelVertex);
@@ -58,6 +60,8 @@ namespace carto { namespace vt {
     }
     
     void TileLabel::snapPlacement(const TileLabel& label) {
+        _placementVersion++;
+
         _placement = label._placement;
         if (!_placement) {
             return;
@@ -89,6 +93,8 @@ namespace carto { namespace vt {
             }
         }
 
+        _placementVersion++;
+
         if (!_transformedPositions.empty()) {
             _placement = _flippedPlacement = findClippedPointPlacement(viewState, _transformedPositions);
             if (_placement && !_transformedVerticesList.empty()) {
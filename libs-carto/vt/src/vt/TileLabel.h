@@ -60,6 +60,7 @@ namespace carto { namespace vt {
 
         void snapPlacement(const TileLabel& label);
         bool updatePlacement(const ViewState& viewState);
+        unsigned int getPlacementVersion() const { return _placementVersion; } // incremented each time the placement or geometry changes
 
         bool calculateCenter(cglib::vec3<double>& pos) const;
         bool calculateEnvelope(const ViewState& viewState, std::array<cglib::vec3<float>, 4>& envelope) const;
@@ -134,6 +135,7 @@ namespace carto { namespace vt {
 
         std::shared_ptr<const Placement> _placement;
         std::shared_ptr<const Placement> _flippedPlacement;
+        unsigned int _placementVersion = 0;
 
         mutable bool _cachedValid = false;
         mutable float _cachedScale = 0;
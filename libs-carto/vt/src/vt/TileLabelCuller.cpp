@@ -1,5 +1,6 @@
 #include "TileLabelCuller.h"
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <list>
@@ -62,52 +63,78 @@ namespace carto { namespace vt {
     }
 
     void TileLabelCuller::process(const std::vector<std::shared_ptr<TileLabel>>& labelList) {
-        // Start by collecting valid labels and updating label placements
-        std::vector<std::shared_ptr<TileLabel>> validLabelList;
-        validLabelList.reserve(labelList.size());
-        for (const std::shared_ptr<TileLabel>& label : labelList) {
+        // Update label placements and take a snapshot of all data needed for overlap analysis within a single lock scope
+        _labelInfos.clear();
+        _labelInfos.reserve(labelList.size());
+        {
             std::lock_guard<std::mutex> lock(*_mutex);
-            
-            // Analyze only active and valid labels
-            if (!label->isActive()) {
-                continue;
-            }
 
-            if (label->updatePlacement(_viewState)) {
-                label->setOpacity(0);
-            }
-                
-            if (label->isValid()) {
-                validLabelList.push_back(label);
+            for (const std::shared_ptr<TileLabel>& label : labelList) {
+                // Analyze only active and valid labels
+                if (!label->isActive()) {
+                    continue;
+                }
+
+                if (label->updatePlacement(_viewState)) {
+                    label->setOpacity(0);
+                }
+
+                if (!label->isValid()) {
+                    continue;
+                }
+
+                LabelInfo labelInfo(label);
+                labelInfo.priority = label->getPriority();
+                labelInfo.opacity = label->getOpacity();
+                labelInfo.groupId = label->getGroupId();
+                labelInfo.minimumGroupDistance = label->getMinimumGroupDistance();
+                if (labelInfo.groupId >= 0) {
+                    std::array<cglib::vec3<float>, 4> mapEnvelope;
+                    if (label->calculateEnvelope(_viewState, mapEnvelope)) {
+                        for (int i = 0; i < 4; i++) {
+                            cglib::vec2<float> p_proj(cglib::proj_o(cglib::transform_point(mapEnvelope[i], _mvpMatrix)));
+                            labelInfo.envelope[i] = p_proj;
+                            labelInfo.bounds.add(p_proj);
+                        }
+                        labelInfo.envelopeValid = true;
+                    }
+                }
+                if (labelInfo.groupId > 0) {
+                    labelInfo.centerValid = label->calculateCenter(labelInfo.center);
+                }
+                _labelInfos.push_back(std::move(labelInfo));
             }
         }
 
         // Sort active labels by priority/opacity
-        {
-            std::lock_guard<std::mutex> lock(*_mutex);
-            std::sort(validLabelList.begin(), validLabelList.end(), [](const std::shared_ptr<TileLabel>& label1, const std::shared_ptr<TileLabel>& label2) {
-                return std::pair<int, float>(-label1->getPriority(), label1->getOpacity()) > std::pair<int, float>(-label2->getPriority(), label2->getOpacity());
-            });
+        std::vector<int> labelOrder(_labelInfos.size());
+        for (std::size_t i = 0; i < labelOrder.size(); i++) {
+            labelOrder[i] = static_cast<int>(i);
         }
+        std::stable_sort(labelOrder.begin(), labelOrder.end(), [this](int index1, int index2) {
+            const LabelInfo& labelInfo1 = _labelInfos[index1];
+            const LabelInfo& labelInfo2 = _labelInfos[index2];
+            return std::pair<int, float>(-labelInfo1.priority, labelInfo1.opacity) > std::pair<int, float>(-labelInfo2.priority, labelInfo2.opacity);
+        });
 
-        // Update label visibility flag based on overlap analysis
+        // Calculate label visibility based on overlap analysis. This works on the snapshot only and does not require locking
         clearGrid();
-        std::unordered_map<long long, std::vector<std::shared_ptr<TileLabel>>> groupMap;
-        for (const std::shared_ptr<TileLabel>& label : validLabelList) {
-            std::lock_guard<std::mutex> lock(*_mutex);
+        std::unordered_map<long long, std::vector<int>> groupMap;
+        for (int labelIndex : labelOrder) {
+            LabelInfo& labelInfo = _labelInfos[labelIndex];
 
             // Label is always visible if its group is set to negative value. Otherwise test visibility against other labels
-            bool visible = label->getGroupId() < 0 || testOverlap(label);
-            if (visible && label->getGroupId() > 0) {
-                cglib::vec3<double> center;
-                if (!label->calculateCenter(center)) {
+            bool visible = labelInfo.groupId < 0 || testOverlap(labelIndex);
+            if (visible && labelInfo.groupId > 0) {
+                if (!labelInfo.centerValid) {
                     visible = false;
                 }
-                for (const std::shared_ptr<TileLabel>& otherLabel : groupMap[label->getGroupId()]) {
-                    cglib::vec3<double> otherCenter;
-                    if (otherLabel->calculateCenter(otherCenter)) {
-                        float minimumDistance = std::min(label->getMinimumGroupDistance(), otherLabel->getMinimumGroupDistance());
-                        double centerDistance = cglib::length(center - otherCenter);
+                std::vector<int>& groupLabelIndices = groupMap[labelInfo.groupId];
+                for (int otherLabelIndex : groupLabelIndices) {
+                    const LabelInfo& otherLabelInfo = _labelInfos[otherLabelIndex];
+                    if (otherLabelInfo.centerValid) {
+                        float minimumDistance = std::min(labelInfo.minimumGroupDistance, otherLabelInfo.minimumGroupDistance);
+                        double centerDistance = cglib::length(labelInfo.center - otherLabelInfo.center);
                         if (centerDistance * _resolution / _scale < minimumDistance) {
                             visible = false;
                             break;
@@ -115,42 +142,49 @@ namespace carto { namespace vt {
                     }
                 }
                 if (visible) {
-                    groupMap[label->getGroupId()].push_back(label);
+                    groupLabelIndices.push_back(labelIndex);
                 }
             }
-            label->setVisible(visible);
+            labelInfo.visible = visible;
         }
-    }
 
-    void TileLabelCuller::clearGrid() {
-        for (int y = 0; y < GRID_RESOLUTION; y++) {
-            for (int x = 0; x < GRID_RESOLUTION; x++) {
-                _recordGrid[y][x].clear();
+        // Publish the results, all labels are updated within a single lock scope so the renderer never sees a partial result
+        {
+            std::lock_guard<std::mutex> lock(*_mutex);
+
+            for (const LabelInfo& labelInfo : _labelInfos) {
+                labelInfo.label->setVisible(labelInfo.visible);
             }
         }
+        _labelInfos.clear();
     }
 
-    bool TileLabelCuller::testOverlap(const std::shared_ptr<TileLabel>& label) {
-        std::array<cglib::vec3<float>, 4> mapEnvelope;
-        if (!label->calculateEnvelope(_viewState, mapEnvelope)) {
-            return false;
-        }
+    void TileLabelCuller::clearGrid() {
+        std::fill(_cellHeads.begin(), _cellHeads.end(), -1);
+        _cellEntries.clear();
+    }
 
-        std::array<cglib::vec2<float>, 4> envelope;
-        cglib::bbox2<float> bounds = cglib::bbox2<float>::smallest();
-        for (int i = 0; i < 4; i++) {
-            cglib::vec2<float> p_proj(cglib::proj_o(cglib::transform_point(mapEnvelope[i], _mvpMatrix)));
-            envelope[i] = p_proj;
-            bounds.add(p_proj);
+    bool TileLabelCuller::testOverlap(int labelIndex) {
+        LabelInfo& labelInfo = _labelInfos[labelIndex];
+        if (!labelInfo.envelopeValid) {
+            return false;
         }
 
-        int x0 = getGridIndex(bounds.min(0)), y0 = getGridIndex(bounds.min(1));
-        int x1 = getGridIndex(bounds.max(0)), y1 = getGridIndex(bounds.max(1));
+        int x0 = getGridIndex(labelInfo.bounds.min(0)), y0 = getGridIndex(labelInfo.bounds.min(1));
+        int x1 = getGridIndex(labelInfo.bounds.max(0)), y1 = getGridIndex(labelInfo.bounds.max(1));
         for (int y = y0; y <= y1; y++) {
             for (int x = x0; x <= x1; x++) {
-                for (const Record& record : _recordGrid[y][x]) {
-                    if (record.bounds.inside(bounds)) {
-                        if (!findSeparatingAxis(record.envelope, envelope) && !findSeparatingAxis(envelope, record.envelope)) {
+                for (int entry = _cellHeads[y * GRID_RESOLUTION + x]; entry != -1; entry = _cellEntries[entry].next) {
+                    // Records spanning multiple cells are tested only once per label
+                    LabelInfo& otherLabelInfo = _labelInfos[_cellEntries[entry].labelIndex];
+                    if (otherLabelInfo.testStamp == labelIndex) {
+                        continue;
+                    }
+                    otherLabelInfo.testStamp = labelIndex;
+
+                    // Cheap bounding box rejection before the separating axis test
+                    if (otherLabelInfo.bounds.inside(labelInfo.bounds)) {
+                        if (!findSeparatingAxis(otherLabelInfo.envelope, labelInfo.envelope) && !findSeparatingAxis(labelInfo.envelope, otherLabelInfo.envelope)) {
                             return false;
                         }
                     }
@@ -160,7 +194,9 @@ namespace carto { namespace vt {
 
         for (int y = y0; y <= y1; y++) {
             for (int x = x0; x <= x1; x++) {
-                _recordGrid[y][x].emplace_back(bounds, envelope, label);
+                int& head = _cellHeads[y * GRID_RESOLUTION + x];
+                _cellEntries.emplace_back(labelIndex, head);
+                head = static_cast<int>(_cellEntries.size()) - 1;
             }
         }
         return true;
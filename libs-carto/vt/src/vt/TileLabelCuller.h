@@ -30,19 +30,34 @@ namespace carto { namespace vt {
         void process(const std::vector<std::shared_ptr<TileLabel>>& labelList);
 
     private:
-        constexpr static int GRID_RESOLUTION = 16;
+        constexpr static int GRID_RESOLUTION = 32;
 
-        struct Record {
-            cglib::bbox2<float> bounds;
-            std::array<cglib::vec2<float>, 4> envelope;
+        struct LabelInfo {
             std::shared_ptr<TileLabel> label;
+            int priority = 0;
+            float opacity = 0;
+            long long groupId = 0;
+            float minimumGroupDistance = 0;
+            bool envelopeValid = false;
+            std::array<cglib::vec2<float>, 4> envelope;
+            cglib::bbox2<float> bounds = cglib::bbox2<float>::smallest();
+            bool centerValid = false;
+            cglib::vec3<double> center = cglib::vec3<double>::zero();
+            bool visible = false;
+            int testStamp = -1;
+
+            explicit LabelInfo(std::shared_ptr<TileLabel> label) : label(std::move(label)) { }
+        };
+
+        struct CellEntry {
+            int labelIndex;
+            int next;
 
-            Record() = default;
-            explicit Record(const cglib::bbox2<float>& bounds, const std::array<cglib::vec2<float>, 4>& envelope, std::shared_ptr<TileLabel> label) : bounds(bounds), envelope(envelope), label(std::move(label)) { }
+            explicit CellEntry(int labelIndex, int next) : labelIndex(labelIndex), next(next) { }
         };
 
         void clearGrid();
-        bool testOverlap(const std::shared_ptr<TileLabel>& label);
+        bool testOverlap(int labelIndex);
 
         static int getGridIndex(float x);
         static cglib::mat4x4<double> calculateLocalViewMatrix(const cglib::mat4x4<double>& cameraMatrix);
@@ -50,7 +65,9 @@ namespace carto { namespace vt {
         cglib::mat4x4<float> _mvpMatrix;
         ViewState _viewState;
         float _resolution = 0;
-        std::vector<Record> _recordGrid[GRID_RESOLUTION][GRID_RESOLUTION];
+        std::vector<LabelInfo> _labelInfos;
+        std::array<int, GRID_RESOLUTION * GRID_RESOLUTION> _cellHeads;
+        std::vector<CellEntry> _cellEntries;
 
         const float _scale;
         const std::shared_ptr<std::mutex> _mutex;
@@ -5,6 +5,7 @@
 #include <utility>
 #include <algorithm>
 #include <iterator>
+#include <map>
 
 #include <boost/math/constants/constants.hpp>
 
@@ -18,6 +19,7 @@ namespace carto { namespace vt {
         _texCoords.reserve(RESERVED_VERTICES);
         _binormals.reserve(RESERVED_VERTICES);
         _heights.reserve(RESERVED_VERTICES);
+        _frames.reserve(RESERVED_VERTICES);
         _attribs.reserve(RESERVED_VERTICES);
         _indices.reserve(RESERVED_VERTICES);
         _ids.reserve(RESERVED_VERTICES);
@@ -25,6 +27,10 @@ namespace carto { namespace vt {
         _nullWidth = std::make_shared<FloatFunction>([](const ViewState& viewState) { return 0.0f; });
     }
 
+    void TileLayerBuilder::setFrame(const boost::optional<int>& frame) {
+        _frame = frame;
+    }
+
     void TileLayerBuilder::addBitmap(const std::shared_ptr<TileBitmap>& bitmap) {
         _bitmapList.push_back(bitmap);
     }
@@ -37,10 +43,11 @@ namespace carto { namespace vt {
         }
         boost::optional<cglib::mat3x3<float>> transform = flipTransform(style.transform);
 
-        if (_builderParameters.type != TileGeometry::Type::POINT || _builderParameters.glyphMap != style.glyphMap || _styleParameters.transform != transform || _styleParameters.compOp != style.compOp || _styleParameters.pointOrientation != style.orientation || _styleParameters.parameterCount >= TileGeometry::StyleParameters::MAX_PARAMETERS) {
+        if (_builderParameters.type != TileGeometry::Type::POINT || _builderParameters.frames != static_cast<bool>(_frame) || _builderParameters.glyphMap != style.glyphMap || _styleParameters.transform != transform || _styleParameters.compOp != style.compOp || _styleParameters.pointOrientation != style.orientation || _styleParameters.parameterCount >= TileGeometry::StyleParameters::MAX_PARAMETERS) {
             appendGeometry();
         }
         _builderParameters.type = TileGeometry::Type::POINT;
+        _builderParameters.frames = static_cast<bool>(_frame);
         _builderParameters.glyphMap = style.glyphMap;
         _styleParameters.transform = transform;
         _styleParameters.compOp = style.compOp;
@@ -67,6 +74,9 @@ namespace carto { namespace vt {
             }
             tesselateGlyph(vertex, static_cast<char>(styleIndex), pen, glyph);
             _ids.fill(id, _indices.size() - i0);
+            if (_frame) {
+                _frames.fill(static_cast<float>(*_frame), _vertices.size() - _frames.size());
+            }
         } while (generator(id, vertex));
     }
 
@@ -79,7 +89,7 @@ namespace carto { namespace vt {
         }
         boost::optional<cglib::mat3x3<float>> transform = flipTransform(style.transform);
 
-        if (_builderParameters.type != TileGeometry::Type::POINT || _builderParameters.glyphMap != style.font->getGlyphMap() || _styleParameters.transform != transform || _styleParameters.compOp != style.compOp || _styleParameters.pointOrientation != style.orientation || _styleParameters.parameterCount >= TileGeometry::StyleParameters::MAX_PARAMETERS) {
+        if (_builderParameters.type != TileGeometry::Type::POINT || _builderParameters.frames || _builderParameters.glyphMap != style.font->getGlyphMap() || _styleParameters.transform != transform || _styleParameters.compOp != style.compOp || _styleParameters.pointOrientation != style.orientation || _styleParameters.parameterCount >= TileGeometry::StyleParameters::MAX_PARAMETERS) {
             appendGeometry();
         }
         _builderParameters.type = TileGeometry::Type::POINT;
@@ -401,7 +411,7 @@ namespace carto { namespace vt {
                 _binormals[i] = cglib::unit(cglib::transform_vector(_binormals[i], invTransTransform)) * cglib::length(_binormals[i]);
             }
         }
-        appendGeometry(calculateScale(_vertices), calculateScale(_binormals), calculateScale(_texCoords), _vertices, _texCoords, _binormals, _heights, _attribs, _indices, _ids, 0, _vertices.size());
+        appendGeometry(calculateScale(_vertices), calculateScale(_binormals), calculateScale(_texCoords), _vertices, _texCoords, _binormals, _heights, _frames, _attribs, _indices, _ids, 0, _vertices.size());
 
         _builderParameters = BuilderParameters();
         _styleParameters = TileGeometry::StyleParameters();
@@ -409,12 +419,13 @@ namespace carto { namespace vt {
         _texCoords.clear();
         _binormals.clear();
         _heights.clear();
+        _frames.clear();
         _attribs.clear();
         _indices.clear();
         _ids.clear();
     }
 
-    void TileLayerBuilder::appendGeometry(float verticesScale, float binormalsScale, float texCoordsScale, const VertexArray<cglib::vec2<float>>& vertices, const VertexArray<cglib::vec2<float>>& texCoords, const VertexArray<cglib::vec2<float>>& binormals, const VertexArray<float>& heights, const VertexArray<cglib::vec4<char>>& attribs, const VertexArray<unsigned int>& indices, const VertexArray<long long>& ids, std::size_t offset, std::size_t count) {
+    void TileLayerBuilder::appendGeometry(float verticesScale, float binormalsScale, float texCoordsScale, const VertexArray<cglib::vec2<float>>& vertices, const VertexArray<cglib::vec2<float>>& texCoords, const VertexArray<cglib::vec2<float>>& binormals, const VertexArray<float>& heights, const VertexArray<float>& frames, const VertexArray<cglib::vec4<char>>& attribs, const VertexArray<unsigned int>& indices, const VertexArray<long long>& ids, std::size_t offset, std::size_t count) {
         if (count < 65536) {
             // Build geometry layout info
             TileGeometry::GeometryLayoutParameters geometryLayoutParameters;
@@ -439,6 +450,11 @@ namespace carto { namespace vt {
                 geometryLayoutParameters.vertexSize += sizeof(float);
             }
 
+            if (!frames.empty()) {
+                geometryLayoutParameters.frameOffset = geometryLayoutParameters.vertexSize;
+                geometryLayoutParameters.vertexSize += sizeof(float);
+            }
+
             geometryLayoutParameters.vertexScale = verticesScale;
             geometryLayoutParameters.binormalScale = binormalsScale;
             geometryLayoutParameters.texCoordScale = texCoordsScale;
@@ -480,6 +496,12 @@ namespace carto { namespace vt {
                     float* compressedHeightPtr = reinterpret_cast<float*>(baseCompressedPtr + geometryLayoutParameters.heightOffset);
                     compressedHeightPtr[0] = height;
                 }
+
+                if (!frames.empty()) {
+                    float frame = frames[i + offset];
+                    float* compressedFramePtr = reinterpret_cast<float*>(baseCompressedPtr + geometryLayoutParameters.frameOffset);
+                    compressedFramePtr[0] = frame;
+                }
             }
                 
             // Compress indices
@@ -504,7 +526,17 @@ namespace carto { namespace vt {
                 compressedIds.shrink_to_fit();
             }
 
-            auto geometry = std::make_shared<TileGeometry>(_builderParameters.type, _tileSize, _geomScale, _styleParameters, geometryLayoutParameters, std::move(compressedVertexGeometry), std::move(compressedIndices), std::move(compressedIds));
+            // Count point features per frame, each point is a quad with 6 indices
+            std::vector<std::pair<int, unsigned int>> frameFeatureCounts;
+            if (!frames.empty()) {
+                std::map<int, unsigned int> frameFeatureCountMap;
+                for (std::size_t i = 0; i + 5 < indices.size(); i += 6) {
+                    frameFeatureCountMap[static_cast<int>(frames[indices[i]])]++;
+                }
+                frameFeatureCounts.assign(frameFeatureCountMap.begin(), frameFeatureCountMap.end());
+            }
+
+            auto geometry = std::make_shared<TileGeometry>(_builderParameters.type, _tileSize, _geomScale, _styleParameters, geometryLayoutParameters, std::move(compressedVertexGeometry), std::move(compressedIndices), std::move(compressedIds), std::move(frameFeatureCounts));
             _geometryList.push_back(std::move(geometry));
             return;
         }
@@ -529,13 +561,13 @@ namespace carto { namespace vt {
         indices1.copy(indices, 0, splitPos);
         VertexArray<long long> ids1;
         ids1.copy(ids, 0, splitPos);
-        appendGeometry(verticesScale, binormalsScale, texCoordsScale, vertices, texCoords, binormals, heights, attribs, indices1, ids1, minIndex[0], maxIndex[0] - minIndex[0] + 1);
+        appendGeometry(verticesScale, binormalsScale, texCoordsScale, vertices, texCoords, binormals, heights, frames, attribs, indices1, ids1, minIndex[0], maxIndex[0] - minIndex[0] + 1);
 
         VertexArray<unsigned int> indices2;
         indices2.copy(indices, splitPos, indices.size() - splitPos);
         VertexArray<long long> ids2;
         ids2.copy(ids, splitPos, indices.size() - splitPos);
-        appendGeometry(verticesScale, binormalsScale, texCoordsScale, vertices, texCoords, binormals, heights, attribs, indices2, ids2, minIndex[1], maxIndex[1] - minIndex[1] + 1);
+        appendGeometry(verticesScale, binormalsScale, texCoordsScale, vertices, texCoords, binormals, heights, frames, attribs, indices2, ids2, minIndex[1], maxIndex[1] - minIndex[1] + 1);
     }
 
     bool TileLayerBuilder::tesselateGlyph(const Vertex& vertex, char styleIndex, const cglib::vec2<float>& pen, const Font::Glyph* glyph) {
@@ -561,6 +593,32 @@ namespace carto { namespace vt {
     }
 
     bool TileLayerBuilder::tesselatePolygon(const VerticesList& verticesList, char styleIndex, const PolygonStyle& style) {
+        float du_dx = 0.0f, dv_dy = 0.0f;
+        if (style.pattern) {
+            du_dx = _tileSize / style.pattern->widthScale;
+            dv_dy = _tileSize / style.pattern->heightScale;
+        }
+
+        // Try fast path first, most polygons are simple and do not need general tesselator
+        _earClipIndices.clear();
+        if (_earClipTesselator.tesselate(verticesList, _earClipIndices)) {
+            int offset = static_cast<int>(_vertices.size());
+            for (const Vertices& points : verticesList) {
+                for (const cglib::vec2<float>& p : points) {
+                    cglib::vec2<float> uv(p(0) * du_dx + 0.5f, p(1) * dv_dy + 0.5f);
+
+                    _vertices.append(p);
+                    _texCoords.append(uv);
+                }
+            }
+            _attribs.fill(cglib::vec4<char>(styleIndex, 0, 0, 0), _vertices.size() - offset);
+
+            for (std::size_t i = 0; i < _earClipIndices.size(); i += 3) {
+                _indices.append(_earClipIndices[i + 0] + offset, _earClipIndices[i + 1] + offset, _earClipIndices[i + 2] + offset);
+            }
+            return true;
+        }
+
         if (!_tessPoolAllocator) {
             _tessPoolAllocator = std::unique_ptr<PoolAllocator>(new PoolAllocator);
         }
@@ -590,12 +648,6 @@ namespace carto { namespace vt {
         const int vertexCount = tessGetVertexCount(tess);
         const int elementCount = tessGetElementCount(tess);
 
-        float du_dx = 0.0f, dv_dy = 0.0f;
-        if (style.pattern) {
-            du_dx = _tileSize / style.pattern->widthScale;
-            dv_dy = _tileSize / style.pattern->heightScale;
-        }
-
         int offset = static_cast<int>(_vertices.size());
         for (int i = 0; i < vertexCount; i++) {
             cglib::vec2<float> p(static_cast<float>(coords[i * 2 + 0]), static_cast<float>(coords[i * 2 + 1]));
@@ -652,6 +704,25 @@ namespace carto { namespace vt {
             }
         }
 
+        // Try fast path first, most building footprints are simple polygons
+        _earClipIndices.clear();
+        if (_earClipTesselator.tesselate(verticesList, _earClipIndices)) {
+            int offset = static_cast<int>(_vertices.size());
+            for (const Vertices& points : verticesList) {
+                for (const cglib::vec2<float>& p : points) {
+                    _vertices.append(p);
+                }
+            }
+            _binormals.fill(cglib::vec2<float>(0, 0), _vertices.size() - offset);
+            _heights.fill(height, _vertices.size() - offset);
+            _attribs.fill(cglib::vec4<char>(styleIndex, 0, 1, 0), _vertices.size() - offset);
+
+            for (std::size_t i = 0; i < _earClipIndices.size(); i += 3) {
+                _indices.append(_earClipIndices[i + 2] + offset, _earClipIndices[i + 1] + offset, _earClipIndices[i + 0] + offset);
+            }
+            return true;
+        }
+
         if (!_tessPoolAllocator) {
             _tessPoolAllocator = std::unique_ptr<PoolAllocator>(new PoolAllocator);
         }
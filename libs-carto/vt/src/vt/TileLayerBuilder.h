@@ -13,6 +13,7 @@
 #include "TileLayer.h"
 #include "Styles.h"
 #include "PoolAllocator.h"
+#include "EarClipTesselator.h"
 #include "VertexArray.h"
 
 #include <memory>
@@ -57,6 +58,8 @@ namespace carto { namespace vt {
 
         explicit TileLayerBuilder(const TileId& tileId, float tileSize, float geomScale);
 
+        void setFrame(const boost::optional<int>& frame); // if set, points get the frame as vertex attribute and are shown only when the frame is current
+
         void addBitmap(const std::shared_ptr<TileBitmap>& bitmap);
         void addPoints(const std::function<bool(long long& id, Vertex& vertex)>& generator, const PointStyle& style);
         void addTexts(const std::function<bool(long long& id, Vertex& vertex, std::string& text)>& generator, const TextStyle& style);
@@ -75,18 +78,19 @@ namespace carto { namespace vt {
 
         struct BuilderParameters {
             TileGeometry::Type type;
+            bool frames;
             std::array<StrokeMap::StrokeId, TileGeometry::StyleParameters::MAX_PARAMETERS> lineStrokeIds;
             std::shared_ptr<const StrokeMap> strokeMap;
             std::shared_ptr<const GlyphMap> glyphMap;
 
-            BuilderParameters() : type(TileGeometry::Type::NONE), lineStrokeIds(), strokeMap(), glyphMap() { }
+            BuilderParameters() : type(TileGeometry::Type::NONE), frames(false), lineStrokeIds(), strokeMap(), glyphMap() { }
         };
 
         static float calculateScale(VertexArray<cglib::vec2<float>>& values);
         static boost::optional<cglib::mat3x3<float>> flipTransform(const boost::optional<cglib::mat3x3<float>>& transform);
 
         void appendGeometry();
-        void appendGeometry(float verticesScale, float binormalsScale, float texCoordsScale, const VertexArray<cglib::vec2<float>>& vertices, const VertexArray<cglib::vec2<float>>& texCoords, const VertexArray<cglib::vec2<float>>& binormals, const VertexArray<float>& heights, const VertexArray<cglib::vec4<char>>& attribs, const VertexArray<unsigned int>& indices, const VertexArray<long long>& ids, std::size_t offset, std::size_t count);
+        void appendGeometry(float verticesScale, float binormalsScale, float texCoordsScale, const VertexArray<cglib::vec2<float>>& vertices, const VertexArray<cglib::vec2<float>>& texCoords, const VertexArray<cglib::vec2<float>>& binormals, const VertexArray<float>& heights, const VertexArray<float>& frames, const VertexArray<cglib::vec4<char>>& attribs, const VertexArray<unsigned int>& indices, const VertexArray<long long>& ids, std::size_t offset, std::size_t count);
 
         bool tesselateGlyph(const Vertex& vertex, char styleIndex, const cglib::vec2<float>& pen, const Font::Glyph* glyph);
         bool tesselatePolygon(const VerticesList& verticesList, char styleIndex, const PolygonStyle& style);
@@ -97,6 +101,7 @@ namespace carto { namespace vt {
         const TileId _tileId;
         const float _tileSize;
         const float _geomScale;
+        boost::optional<int> _frame;
         BuilderParameters _builderParameters;
         TileGeometry::StyleParameters _styleParameters;
 
@@ -104,6 +109,7 @@ namespace carto { namespace vt {
         VertexArray<cglib::vec2<float>> _texCoords;
         VertexArray<cglib::vec2<float>> _binormals;
         VertexArray<float> _heights;
+        VertexArray<float> _frames;
         VertexArray<cglib::vec4<char>> _attribs;
         VertexArray<unsigned int> _indices;
         VertexArray<long long> _ids;
@@ -114,6 +120,8 @@ namespace carto { namespace vt {
 
         std::shared_ptr<FloatFunction> _nullWidth;
         std::unique_ptr<PoolAllocator> _tessPoolAllocator;
+        EarClipTesselator _earClipTesselator;
+        std::vector<unsigned int> _earClipIndices;
     };
 } }
 